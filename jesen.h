@@ -80,9 +80,193 @@ typedef int32_t jesen_err_t;
 /** Node does not belong to the expected parent. */
 #define JESEN_ERR_NOT_OWNED (JESEN_ERR_BASE + 13)
 
-/** Opaque wrapper around a cJSON node with parent/child/sibling links. */
+/** An event handler asked the parser to stop early. */
+#define JESEN_ERR_STOPPED (JESEN_ERR_BASE + 14)
+
+/** Input holds bytes that are not well-formed UTF-8 (strict parsing only). */
+#define JESEN_ERR_UTF8 (JESEN_ERR_BASE + 15)
+
+/** Input exceeds `max_input` or `max_nodes` of `jesen_parse_opts_t`. */
+#define JESEN_ERR_LIMIT (JESEN_ERR_BASE + 16)
+
+/** An object repeats a key under `JESEN_DUPLICATE_ERROR`. */
+#define JESEN_ERR_DUPLICATE_KEY (JESEN_ERR_BASE + 17)
+
+/** Opaque JSON node with parent/child/sibling links (layout is backend-specific). */
 typedef struct jesen_node jesen_node_t;
 
+/** Opaque incremental parser for documents delivered in chunks. */
+typedef struct jesen_parser jesen_parser_t;
+
+/** Opaque reusable parse context (see `jesen_doc_parse`). */
+typedef struct jesen_doc jesen_doc_t;
+
+/** Opaque compiled set of paths (see `jesen_projection_create`). */
+typedef struct jesen_projection jesen_projection_t;
+
+/** Opaque pool of object keys shared by trees (see `jesen_intern_create`). */
+typedef struct jesen_intern jesen_intern_t;
+
+/** Type of a JSON value. */
+typedef enum {
+  JESEN_KIND_NULL,
+  JESEN_KIND_BOOL,
+  JESEN_KIND_NUMBER,
+  JESEN_KIND_STRING,
+  JESEN_KIND_ARRAY,
+  JESEN_KIND_OBJECT,
+} jesen_kind_t;
+
+/** Opaque read-only document stored as a flat tape (see `jesen_tape_parse`). */
+typedef struct jesen_tape jesen_tape_t;
+
+/** Handle to one value of a tape document; copy freely. */
+typedef struct {
+  const jesen_tape_t *tape;
+  size_t index;
+} jesen_tape_ref_t;
+
+/**
+ * @brief On-demand view of one value inside a JSON buffer.
+ *
+ * Cursors are plain values that borrow the buffer given to
+ * `jesen_cursor_init`; copy them freely. The fields are internal.
+ */
+typedef struct {
+  const char *buf;
+  size_t len;
+  // offset of the value's first byte.
+  size_t offset;
+} jesen_cursor_t;
+
+/**
+ * @brief Position in the children of an array or object node.
+ *
+ * Iterators are plain values set up by `jesen_iter_begin`; copy them freely.
+ * The fields are internal.
+ */
+typedef struct {
+  jesen_node_t *node;
+  // native backend: the child to return next.
+  jesen_node_t *next;
+  // cJSON backend: document position of the child to return next.
+  size_t index;
+} jesen_iter_t;
+
+/** Parse flag: reject input that is not well-formed UTF-8. */
+#define JESEN_PARSE_STRICT_UTF8 0x2u
+
+/**
+ * Parse flag: create every node handle while parsing instead of on first
+ * access. Only the cJSON backend builds handles lazily; the native backend
+ * ignores it.
+ */
+#define JESEN_PARSE_EAGER_WRAPPERS 0x4u
+
+/**
+ * Parse flag: store each distinct object key once, in a key pool private to
+ * the new tree, instead of once per member. Ignored when
+ * `jesen_parse_opts_t::intern` names a shared pool.
+ */
+#define JESEN_PARSE_INTERN_KEYS 0x8u
+
+/** What the parser does with a key repeated inside one object. */
+typedef enum {
+  /** Keep every member; lookups find the last one. */
+  JESEN_DUPLICATE_KEEP_ALL,
+  /** Keep the first member with the key and drop later ones. */
+  JESEN_DUPLICATE_FIRST,
+  /** Keep the last member with the key and drop earlier ones. */
+  JESEN_DUPLICATE_LAST,
+  /** Fail the parse with JESEN_ERR_DUPLICATE_KEY. */
+  JESEN_DUPLICATE_ERROR,
+} jesen_duplicate_policy_t;
+
+/**
+ * @brief Memory source for a parse.
+ *
+ * `alloc` returns `size` bytes (or NULL) and `release` gives back a block
+ * `alloc` returned; both receive `ctx`. The allocator must outlive every tree
+ * parsed with it.
+ */
+typedef struct {
+  void *(*alloc)(void *ctx, size_t size);
+  void (*release)(void *ctx, void *ptr);
+  void *ctx;
+} jesen_allocator_t;
+
+/**
+ * @brief Options for `jesen_parse_ex`.
+ *
+ * Zero-initialize and set only the fields you need; a zero field keeps the
+ * default. Limits are enforced while parsing, so a hostile input is rejected
+ * as soon as it crosses one, before the rest of its tree is built.
+ */
+typedef struct {
+  /**
+   * `JESEN_PARSE_STRICT_UTF8`, `JESEN_PARSE_EAGER_WRAPPERS` and/or
+   * `JESEN_PARSE_INTERN_KEYS`.
+   */
+  uint32_t flags;
+  /** Deepest nesting of arrays and objects accepted; 0 means 1000. */
+  size_t max_depth;
+  /** Longest input accepted, in bytes; 0 means no limit. */
+  size_t max_input;
+  /** Most values (containers and scalars) accepted; 0 means no limit. */
+  size_t max_nodes;
+  /** Handling of repeated object keys. */
+  jesen_duplicate_policy_t duplicates;
+  /**
+   * Allocator for the parse, or NULL for malloc/free. The native backend
+   * takes every node, key and string of the tree from it; the cJSON backend
+   * its working memory and node handles, since cJSON items come from
+   * cJSON's own hooks.
+   */
+  const jesen_allocator_t *allocator;
+  /**
+   * Build only the values on these paths (and the containers leading to
+   * them), or NULL for the whole document.
+   */
+  const jesen_projection_t *projection;
+  /**
+   * Key pool to take object keys from, or NULL. Trees parsed with the same
+   * pool share their keys; see `jesen_intern_create`.
+   */
+  jesen_intern_t *intern;
+} jesen_parse_opts_t;
+
+/**
+ * @brief Callbacks for `jesen_parse_events`.
+ *
+ * Key, string and number slices point into the input or into parser scratch
+ * space; they are only valid during the call and are not NUL-terminated.
+ * Strings are already unescaped. Numbers are passed as their raw JSON text.
+ * Any callback may be NULL. Returning anything other than JESEN_ERR_NONE
+ * (typically JESEN_ERR_STOPPED) stops the parse and is returned to the caller.
+ */
+typedef struct {
+  jesen_err_t (*begin_object)(void *ctx);
+  jesen_err_t (*end_object)(void *ctx);
+  jesen_err_t (*begin_array)(void *ctx);
+  jesen_err_t (*end_array)(void *ctx);
+  jesen_err_t (*key)(void *ctx, const char *key, size_t len);
+  jesen_err_t (*string)(void *ctx, const char *str, size_t len);
+  jesen_err_t (*number)(void *ctx, const char *raw, size_t len);
+  jesen_err_t (*boolean)(void *ctx, bool value);
+  jesen_err_t (*null_value)(void *ctx);
+} jesen_handler_t;
+
+/**
+ * @brief Receives one parsed NDJSON record from `jesen_parse_ndjson_each`.
+ *
+ * Called from worker threads, possibly concurrently and out of order; `index`
+ * is the record's zero-based position among the non-blank lines. The callback
+ * takes ownership of `root`. Returning anything but JESEN_ERR_NONE stops the
+ * batch.
+ */
+typedef jesen_err_t (*jesen_ndjson_record_fn)(void *ctx, size_t index,
+                                              jesen_node_t *root);
+
 /**
  * @brief Create a new unattached JSON object.
  * @param[out] out Receives the allocated object wrapper.
@@ -155,6 +339,8 @@ JESEN_API jesen_err_t jesen_object_add_null(jesen_node_t *node,
 
 /**
  * @brief Remove a property from an object and free its subtree.
+ *
+ * The member removed is the one `jesen_node_find` returns for `key`.
  * @param node Target object.
  * @param key  Property name.
  * @return JESEN_ERR_NONE on success or JESEN_ERR_NOT_FOUND if missing.
@@ -183,7 +369,7 @@ JESEN_API jesen_err_t jesen_array_create_to(jesen_node_t *parent,
  * @brief Get the array element at `index` using the existing wrapper.
  * @param array Source array.
  * @param index Zero-based index.
- * @param[out] out Receives the owned child wrapper (no new allocation).
+ * @param[out] out Receives the owned child wrapper.
  * @return JESEN_ERR_NONE on success or an error code (e.g., OUT_OF_RANGE).
  */
 JESEN_API jesen_err_t jesen_array_get_value(jesen_node_t *array, uint32_t index,
@@ -194,7 +380,9 @@ JESEN_API jesen_err_t jesen_array_get_value(jesen_node_t *array, uint32_t index,
  * @param array Destination array.
  * @param index Zero-based index to replace.
  * @param value Node to insert; must be unattached on entry.
- * @return JESEN_ERR_NONE on success or an error code.
+ * @return JESEN_ERR_NONE on success, JESEN_ERR_NOT_OWNED if `value` and
+ *         `array` do not come from the same document (see
+ *         `jesen_node_copy`), or an error code.
  */
 JESEN_API jesen_err_t jesen_array_set_value(jesen_node_t *array, uint32_t index,
                                             jesen_node_t *value);
@@ -354,6 +542,12 @@ JESEN_API jesen_err_t jesen_array_get_object_string(jesen_node_t *array,
 
 /**
  * @brief Find an immediate child of `node` by key.
+ *
+ * Keys are matched exactly; with repeated keys the last member wins. Objects
+ * with many members (32 by default, see the `JESEN_INDEX_MIN_MEMBERS` build
+ * option) are looked up through a hash index that additions and removals
+ * keep current. The native backend builds it as such an object grows,
+ * including while parsing; the cJSON backend on the first lookup.
  * @param node Object to search.
  * @param key  Property name.
  * @param[out] out Receives the existing child wrapper.
@@ -499,6 +693,21 @@ JESEN_API jesen_err_t jesen_value_get_string(const jesen_node_t *node,
                                              char *out, size_t out_max,
                                              size_t *out_len);
 
+/**
+ * @brief Borrow a string value without copying it.
+ *
+ * The pointer stays valid until the node is destroyed or its value replaced
+ * (and, for trees from `jesen_parse_insitu`, while the input buffer lives).
+ * @param node Source node.
+ * @param[out] out Receives a pointer to the NUL-terminated string.
+ * @param[out] out_len Receives the string length (optional).
+ * @return JESEN_ERR_NONE on success or JESEN_ERR_INVALID_VALUE_TYPE if not a
+ *         string.
+ */
+JESEN_API jesen_err_t jesen_value_get_string_ref(const jesen_node_t *node,
+                                                 const char **out,
+                                                 size_t *out_len);
+
 /**
  * @brief Read a 32-bit integer from a node.
  * @param node Source node.
@@ -618,12 +827,93 @@ JESEN_API jesen_err_t jesen_array_size(const jesen_node_t *array,
 JESEN_API jesen_err_t jesen_object_size(const jesen_node_t *object,
                                         size_t *out_size);
 
+/**
+ * @brief Start iterating over the children of an array or object.
+ *
+ * Children come back in document order (for built trees, the order they
+ * were added), each in O(1). Adding, removing or replacing children of
+ * `node` invalidates the iterator; changing the children themselves does
+ * not.
+ * @param node Array or object to iterate.
+ * @param[out] out Receives an iterator positioned before the first child.
+ * @return JESEN_ERR_NONE on success or JESEN_ERR_WRONG_TYPE if `node` is
+ *         not a container.
+ */
+JESEN_API jesen_err_t jesen_iter_begin(jesen_node_t *node, jesen_iter_t *out);
+
+/**
+ * @brief Return the next child and advance.
+ * @param it Iterator from `jesen_iter_begin`.
+ * @param[out] key Receives the member name, or NULL for array elements
+ *             (optional).
+ * @param[out] key_len Receives the length of `key` (optional).
+ * @param[out] child Receives the child node.
+ * @return JESEN_ERR_NONE on success or JESEN_ERR_NOT_FOUND after the last
+ *         child.
+ */
+JESEN_API jesen_err_t jesen_iter_next(jesen_iter_t *it, const char **key,
+                                      size_t *key_len, jesen_node_t **child);
+
+/**
+ * @brief Return the next child as a 32-bit integer and advance.
+ *
+ * The typed variants leave the iterator in place, and `key` and `out`
+ * untouched, when the child has another type, so it can still be read with
+ * `jesen_iter_next`.
+ * @param it Iterator from `jesen_iter_begin`.
+ * @param[out] key Receives the member name, or NULL for array elements
+ *             (optional).
+ * @param[out] out Receives the value.
+ * @return JESEN_ERR_NONE on success, JESEN_ERR_NOT_FOUND after the last
+ *         child, or the error of `jesen_value_get_int32`.
+ */
+JESEN_API jesen_err_t jesen_iter_next_int32(jesen_iter_t *it,
+                                            const char **key, int32_t *out);
+
+/**
+ * @brief Return the next child as a double and advance.
+ * @param it Iterator from `jesen_iter_begin`.
+ * @param[out] key Receives the member name (optional).
+ * @param[out] out Receives the value.
+ * @return JESEN_ERR_NONE on success, JESEN_ERR_NOT_FOUND after the last
+ *         child, or the error of `jesen_value_get_double`.
+ */
+JESEN_API jesen_err_t jesen_iter_next_double(jesen_iter_t *it,
+                                             const char **key, double *out);
+
+/**
+ * @brief Return the next child as a boolean and advance.
+ * @param it Iterator from `jesen_iter_begin`.
+ * @param[out] key Receives the member name (optional).
+ * @param[out] out Receives the value.
+ * @return JESEN_ERR_NONE on success, JESEN_ERR_NOT_FOUND after the last
+ *         child, or the error of `jesen_value_get_bool`.
+ */
+JESEN_API jesen_err_t jesen_iter_next_bool(jesen_iter_t *it, const char **key,
+                                           bool *out);
+
+/**
+ * @brief Return the next child as a borrowed string and advance.
+ * @param it Iterator from `jesen_iter_begin`.
+ * @param[out] key Receives the member name (optional).
+ * @param[out] out Receives the string, as `jesen_value_get_string_ref`.
+ * @param[out] out_len Receives the string length (optional).
+ * @return JESEN_ERR_NONE on success, JESEN_ERR_NOT_FOUND after the last
+ *         child, or the error of `jesen_value_get_string_ref`.
+ */
+JESEN_API jesen_err_t jesen_iter_next_string(jesen_iter_t *it,
+                                             const char **key,
+                                             const char **out,
+                                             size_t *out_len);
+
 /**
  * @brief Attach an unattached node to a parent.
  * @param parent Destination parent (object or array).
  * @param name   Property name for object parents; ignored for arrays.
  * @param node   Node to attach (must be unattached on entry).
- * @return JESEN_ERR_NONE on success or an error code.
+ * @return JESEN_ERR_NONE on success, JESEN_ERR_NOT_OWNED if `node` and
+ *         `parent` do not come from the same document (see
+ *         `jesen_node_copy`), or an error code.
  */
 JESEN_API jesen_err_t jesen_node_assign_to(jesen_node_t *parent,
                                            const char *name,
@@ -642,6 +932,11 @@ JESEN_API jesen_err_t jesen_serialize(const jesen_node_t *node, char *out_buf,
 
 /**
  * @brief Parse JSON text into a new node tree.
+ *
+ * Only the root wrapper is allocated up front; child wrappers are created the
+ * first time a lookup, getter or mutation reaches them. Because of this, a
+ * parsed tree must not be read from several threads at once without external
+ * locking.
  * @param buf Input buffer.
  * @param buf_len Length of `buf` in bytes.
  * @param[out] out Receives the root node; caller must destroy with
@@ -651,6 +946,717 @@ JESEN_API jesen_err_t jesen_serialize(const jesen_node_t *node, char *out_buf,
 JESEN_API jesen_err_t jesen_parse(const char *buf, size_t buf_len,
                                   jesen_node_t **out);
 
+/**
+ * @brief Parse JSON text like `jesen_parse`, with extra checks.
+ *
+ * With `JESEN_PARSE_STRICT_UTF8` the input is also checked to be well-formed
+ * UTF-8 (no overlong forms, surrogates, or code points above U+10FFFF). The
+ * check runs inside the parser's scanning pass, vectorized where the CPU
+ * allows, so no separate validation pass over the input is needed.
+ * @param buf Input buffer.
+ * @param buf_len Length of `buf` in bytes.
+ * @param flags Zero or more of `JESEN_PARSE_STRICT_UTF8`,
+ *              `JESEN_PARSE_EAGER_WRAPPERS` and `JESEN_PARSE_INTERN_KEYS`.
+ * @param[out] out Receives the root node; caller must destroy with
+ *                 `jesen_destroy`.
+ * @return JESEN_ERR_NONE on success, JESEN_ERR_PARSE for malformed JSON,
+ *         JESEN_ERR_UTF8 for malformed UTF-8, JESEN_ERR_INVALID_ARGS for
+ *         unknown flags, or another error code.
+ */
+JESEN_API jesen_err_t jesen_parse_with_flags(const char *buf, size_t buf_len,
+                                             uint32_t flags,
+                                             jesen_node_t **out);
+
+/**
+ * @brief Parse JSON text like `jesen_parse`, with per-call options.
+ *
+ * Parsing, destroying and serializing do not recurse, so `max_depth` can be
+ * raised well past what the C stack of a small worker thread would allow.
+ * @param buf Input buffer.
+ * @param buf_len Length of `buf` in bytes.
+ * @param opts Options; see `jesen_parse_opts_t`.
+ * @param[out] out Receives the root node; caller must destroy with
+ *                 `jesen_destroy`.
+ * @return JESEN_ERR_NONE on success, JESEN_ERR_PARSE for malformed JSON or
+ *         nesting deeper than `max_depth`, JESEN_ERR_LIMIT past `max_input`
+ *         or `max_nodes`, JESEN_ERR_DUPLICATE_KEY under
+ *         `JESEN_DUPLICATE_ERROR`, JESEN_ERR_UTF8 for malformed UTF-8 under
+ *         `JESEN_PARSE_STRICT_UTF8`, JESEN_ERR_INVALID_ARGS for unknown flags,
+ *         policies or an incomplete allocator, or another error code.
+ */
+JESEN_API jesen_err_t jesen_parse_ex(const char *buf, size_t buf_len,
+                                     const jesen_parse_opts_t *opts,
+                                     jesen_node_t **out);
+
+/**
+ * @brief Create a key pool for `jesen_parse_opts_t::intern`.
+ *
+ * Every tree parsed with the pool stores each distinct object key once in
+ * it, so documents made of many records with the same fields keep one copy
+ * of each field name. A tree holds a reference to the pool until it is
+ * destroyed, so the pool may be released before its trees; keys of members
+ * moved from such a tree into another one must not outlive it. A pool must
+ * not be used by two parses at once.
+ *
+ * Lookups (`jesen_node_find` and the getters built on it) first compare keys
+ * by address, so passing keys obtained from `jesen_intern_key` skips the
+ * string comparison for the member that matches.
+ * @param[out] out Receives the pool; release with `jesen_intern_destroy`.
+ * @return JESEN_ERR_NONE on success or an error code.
+ */
+JESEN_API jesen_err_t jesen_intern_create(jesen_intern_t **out);
+
+/**
+ * @brief Get the pooled copy of a key, adding it if new.
+ * @param pool Key pool.
+ * @param key NUL-terminated key.
+ * @param[out] out Receives the pooled copy, valid while the pool is alive.
+ * @return JESEN_ERR_NONE on success or an error code.
+ */
+JESEN_API jesen_err_t jesen_intern_key(jesen_intern_t *pool, const char *key,
+                                       const char **out);
+
+/**
+ * @brief Release the caller's reference to a key pool.
+ *
+ * The keys stay alive until every tree parsed with the pool is destroyed too.
+ * @param pool Pool to release.
+ * @return JESEN_ERR_NONE on success or an error code.
+ */
+JESEN_API jesen_err_t jesen_intern_destroy(jesen_intern_t *pool);
+
+/**
+ * @brief Compile paths for `jesen_parse_opts_t::projection`.
+ *
+ * A path names object members separated by dots, with `[*]` standing for
+ * every element of an array: `user.id`, `items[*].price`, `[*].name`. A path
+ * keeps its whole value; the empty path keeps the whole document. Members
+ * whose names contain `.` or `[` cannot be named.
+ *
+ * A projected parse builds the containers that lead to a kept value, so the
+ * result reads with the usual getters, and skips every other value by only
+ * matching its brackets and quotes. Skipped values are therefore not fully
+ * validated. Containers on a path keep their type even where the path
+ * expects another one; they are simply left empty.
+ * @param paths Array of `count` NUL-terminated paths.
+ * @param count Number of paths.
+ * @param[out] out Receives the projection; release with
+ *                 `jesen_projection_destroy`. It may be shared by concurrent
+ *                 parses.
+ * @return JESEN_ERR_NONE on success, JESEN_ERR_INVALID_ARGS for a malformed
+ *         path, or another error code.
+ */
+JESEN_API jesen_err_t jesen_projection_create(const char *const *paths,
+                                              size_t count,
+                                              jesen_projection_t **out);
+
+/**
+ * @brief Free a projection.
+ * @param projection Projection to free.
+ * @return JESEN_ERR_NONE on success or an error code.
+ */
+JESEN_API jesen_err_t jesen_projection_destroy(jesen_projection_t *projection);
+
+/**
+ * @brief Parse JSON text in place, without copying keys or strings.
+ *
+ * Strings are unescaped inside `buf` and the tree points into it, so `buf` is
+ * modified and must stay alive and unchanged until the tree is destroyed.
+ * Keys and strings added later through the mutation API are still copied.
+ * @param buf Mutable input buffer.
+ * @param buf_len Length of `buf` in bytes.
+ * @param[out] out Receives the root node; caller must destroy with
+ *                 `jesen_destroy`.
+ * @return JESEN_ERR_NONE on success or an error code (e.g., JESEN_ERR_PARSE).
+ *         On failure the contents of `buf` are unspecified.
+ */
+JESEN_API jesen_err_t jesen_parse_insitu(char *buf, size_t buf_len,
+                                         jesen_node_t **out);
+
+/**
+ * @brief Parse JSON text as a stream of events, without building a tree.
+ *
+ * Events are delivered in document order while the input is validated, so a
+ * malformed document may produce some events before JESEN_ERR_PARSE is
+ * returned.
+ * @param buf Input buffer.
+ * @param buf_len Length of `buf` in bytes.
+ * @param handler Callbacks to invoke.
+ * @param ctx Opaque pointer passed to every callback.
+ * @return JESEN_ERR_NONE on success, JESEN_ERR_PARSE for malformed input, or
+ *         the first non-success code a callback returned.
+ */
+JESEN_API jesen_err_t jesen_parse_events(const char *buf, size_t buf_len,
+                                         const jesen_handler_t *handler,
+                                         void *ctx);
+
+/**
+ * @brief Start on-demand access to a JSON document without building a tree.
+ *
+ * Cursor operations scan the buffer only as far as they need to and decode
+ * only the values asked for, so reading a few fields of a large document is
+ * much cheaper than `jesen_parse`. The document is not validated up front:
+ * values that are stepped over are only checked for balanced brackets, and
+ * malformed input is reported (as JESEN_ERR_PARSE) only when an operation
+ * reaches it.
+ * @param buf Input buffer; it must outlive every cursor into it.
+ * @param buf_len Length of `buf` in bytes.
+ * @param[out] out Receives a cursor on the root value.
+ * @return JESEN_ERR_NONE on success or JESEN_ERR_PARSE for an empty document.
+ */
+JESEN_API jesen_err_t jesen_cursor_init(const char *buf, size_t buf_len,
+                                        jesen_cursor_t *out);
+
+/**
+ * @brief Find a field of an object.
+ *
+ * Members are scanned from the start of the object, and with repeated keys
+ * the first member wins: the cursor reads forward only, so it stops at the
+ * first match rather than stepping over the rest of the object. This differs
+ * from `jesen_node_find`, where the last member wins.
+ * @param object Cursor on an object.
+ * @param key Field name to look up.
+ * @param[out] out Receives a cursor on the field's value.
+ * @return JESEN_ERR_NONE on success, JESEN_ERR_NOT_FOUND if missing, or
+ *         JESEN_ERR_WRONG_TYPE if `object` is not an object.
+ */
+JESEN_API jesen_err_t jesen_cursor_find_field(const jesen_cursor_t *object,
+                                              const char *key,
+                                              jesen_cursor_t *out);
+
+/**
+ * @brief Move to an element of an array.
+ * @param array Cursor on an array.
+ * @param index Zero-based element index.
+ * @param[out] out Receives a cursor on the element.
+ * @return JESEN_ERR_NONE on success, JESEN_ERR_OUT_OF_RANGE past the end, or
+ *         JESEN_ERR_WRONG_TYPE if `array` is not an array.
+ */
+JESEN_API jesen_err_t jesen_cursor_at_index(const jesen_cursor_t *array,
+                                            size_t index, jesen_cursor_t *out);
+
+/**
+ * @brief Skip the current array element and move to the next one.
+ * @param element Cursor on an array element; advanced in place.
+ * @return JESEN_ERR_NONE on success, JESEN_ERR_NOT_FOUND after the last
+ *         element, or JESEN_ERR_WRONG_TYPE for a value inside an object.
+ */
+JESEN_API jesen_err_t jesen_cursor_next(jesen_cursor_t *element);
+
+/**
+ * @brief Get the raw JSON text of the value, skipping over it.
+ * @param cursor Source cursor.
+ * @param[out] out Receives a pointer into the input buffer.
+ * @param[out] out_len Receives the length of the value's text.
+ * @return JESEN_ERR_NONE on success or an error code.
+ */
+JESEN_API jesen_err_t jesen_cursor_get_raw(const jesen_cursor_t *cursor,
+                                           const char **out, size_t *out_len);
+
+/**
+ * @brief Read an integer value.
+ * @param cursor Source cursor.
+ * @param[out] out Receives the value.
+ * @return JESEN_ERR_NONE on success, JESEN_ERR_INVALID_VALUE_TYPE if the value
+ *         is not an integer, or JESEN_ERR_OUT_OF_RANGE if it does not fit.
+ */
+JESEN_API jesen_err_t jesen_cursor_get_int64(const jesen_cursor_t *cursor,
+                                             int64_t *out);
+
+/**
+ * @brief Read a number value as a double.
+ * @param cursor Source cursor.
+ * @param[out] out Receives the value.
+ * @return JESEN_ERR_NONE on success or JESEN_ERR_INVALID_VALUE_TYPE if the
+ *         value is not a number.
+ */
+JESEN_API jesen_err_t jesen_cursor_get_double(const jesen_cursor_t *cursor,
+                                              double *out);
+
+/**
+ * @brief Read a boolean value.
+ * @param cursor Source cursor.
+ * @param[out] out Receives the value.
+ * @return JESEN_ERR_NONE on success or JESEN_ERR_INVALID_VALUE_TYPE if the
+ *         value is not a boolean.
+ */
+JESEN_API jesen_err_t jesen_cursor_get_bool(const jesen_cursor_t *cursor,
+                                            bool *out);
+
+/**
+ * @brief Check whether the value is null.
+ * @param cursor Source cursor.
+ * @param[out] out Receives true for null.
+ * @return JESEN_ERR_NONE on success or an error code.
+ */
+JESEN_API jesen_err_t jesen_cursor_is_null(const jesen_cursor_t *cursor,
+                                           bool *out);
+
+/**
+ * @brief Borrow the text of a string value straight from the input.
+ *
+ * No copy is made and escape sequences are left as they appear in the JSON;
+ * use `jesen_cursor_get_string` for the decoded text.
+ * @param cursor Source cursor.
+ * @param[out] out Receives a pointer to the bytes between the quotes (not
+ *                 NUL-terminated).
+ * @param[out] out_len Receives the number of bytes.
+ * @return JESEN_ERR_NONE on success or JESEN_ERR_INVALID_VALUE_TYPE if not a
+ *         string.
+ */
+JESEN_API jesen_err_t jesen_cursor_get_string_view(const jesen_cursor_t *cursor,
+                                                   const char **out,
+                                                   size_t *out_len);
+
+/**
+ * @brief Decode a string value into a caller buffer.
+ * @param cursor Source cursor.
+ * @param[out] out Buffer to receive the string (with terminator).
+ * @param out_max Size of `out` in bytes.
+ * @param[out] out_len Receives the string length (excluding terminator).
+ * @return JESEN_ERR_NONE on success or JESEN_ERR_INVALID_VALUE_TYPE if not a
+ *         string.
+ */
+JESEN_API jesen_err_t jesen_cursor_get_string(const jesen_cursor_t *cursor,
+                                              char *out, size_t out_max,
+                                              size_t *out_len);
+
+/**
+ * @brief Build only the value a JSON Pointer (RFC 6901) names.
+ *
+ * The input is scanned from the start and only the members and elements on
+ * the path are inspected; everything else is stepped over as with cursors,
+ * so the rest of the document is neither built nor fully validated. The
+ * value found is parsed into a tree of its own. With repeated keys the last
+ * member wins, as with `jesen_node_find` on the parsed document, so each
+ * object on the path is stepped through to its end.
+ * @param buf Input buffer.
+ * @param buf_len Length of `buf` in bytes.
+ * @param pointer Pointer such as "/a/b/3/c"; "" names the whole document.
+ * @param[out] out Receives the value's root node; release with
+ *                 `jesen_destroy`.
+ * @return JESEN_ERR_NONE on success, JESEN_ERR_NOT_FOUND for a missing
+ *         member, JESEN_ERR_OUT_OF_RANGE for an index past the end,
+ *         JESEN_ERR_WRONG_TYPE when the path runs into a scalar,
+ *         JESEN_ERR_INVALID_ARGS for a malformed pointer, or JESEN_ERR_PARSE.
+ */
+JESEN_API jesen_err_t jesen_extract_pointer(const char *buf, size_t buf_len,
+                                            const char *pointer,
+                                            jesen_node_t **out);
+
+/**
+ * @brief Read the integer a JSON Pointer names without building a tree.
+ * @param buf Input buffer.
+ * @param buf_len Length of `buf` in bytes.
+ * @param pointer Pointer to the value.
+ * @param[out] out Receives the value.
+ * @return As `jesen_extract_pointer`, plus the errors of
+ *         `jesen_cursor_get_int64`.
+ */
+JESEN_API jesen_err_t jesen_extract_pointer_int64(const char *buf,
+                                                  size_t buf_len,
+                                                  const char *pointer,
+                                                  int64_t *out);
+
+/**
+ * @brief Read the number a JSON Pointer names as a double without building a
+ *        tree.
+ * @param buf Input buffer.
+ * @param buf_len Length of `buf` in bytes.
+ * @param pointer Pointer to the value.
+ * @param[out] out Receives the value.
+ * @return As `jesen_extract_pointer`, plus the errors of
+ *         `jesen_cursor_get_double`.
+ */
+JESEN_API jesen_err_t jesen_extract_pointer_double(const char *buf,
+                                                   size_t buf_len,
+                                                   const char *pointer,
+                                                   double *out);
+
+/**
+ * @brief Borrow the string a JSON Pointer names straight from the input.
+ *
+ * Like `jesen_cursor_get_string_view`, escape sequences are left as they
+ * appear in the JSON.
+ * @param buf Input buffer.
+ * @param buf_len Length of `buf` in bytes.
+ * @param pointer Pointer to the value.
+ * @param[out] out Receives a pointer to the bytes between the quotes (not
+ *                 NUL-terminated).
+ * @param[out] out_len Receives the number of bytes.
+ * @return As `jesen_extract_pointer`, or JESEN_ERR_INVALID_VALUE_TYPE if the
+ *         value is not a string.
+ */
+JESEN_API jesen_err_t jesen_extract_pointer_string(const char *buf,
+                                                   size_t buf_len,
+                                                   const char *pointer,
+                                                   const char **out,
+                                                   size_t *out_len);
+
+/**
+ * @brief Parse JSON text into a compact read-only tape document.
+ *
+ * The document is one contiguous array of 64-bit words plus one buffer of
+ * decoded strings, instead of a node per value. Containers record where they
+ * end, so stepping over a subtree is O(1) and a traversal reads memory
+ * sequentially. Values are reached through `jesen_tape_ref_t` handles.
+ * @param buf Input buffer.
+ * @param buf_len Length of `buf` in bytes.
+ * @param[out] out Receives the document; release with `jesen_tape_destroy`.
+ * @return JESEN_ERR_NONE on success or an error code (e.g., JESEN_ERR_PARSE).
+ */
+JESEN_API jesen_err_t jesen_tape_parse(const char *buf, size_t buf_len,
+                                       jesen_tape_t **out);
+
+/**
+ * @brief Release a tape document. Refs into it become invalid.
+ * @param tape Document to free.
+ * @return JESEN_ERR_NONE on success or an error code.
+ */
+JESEN_API jesen_err_t jesen_tape_destroy(jesen_tape_t *tape);
+
+/**
+ * @brief Get the root value of a tape document.
+ * @param tape Source document.
+ * @param[out] out Receives the root handle.
+ * @return JESEN_ERR_NONE on success or an error code.
+ */
+JESEN_API jesen_err_t jesen_tape_root(const jesen_tape_t *tape,
+                                      jesen_tape_ref_t *out);
+
+/**
+ * @brief Get the type of a tape value.
+ * @param ref Source value.
+ * @param[out] out Receives the type.
+ * @return JESEN_ERR_NONE on success or an error code.
+ */
+JESEN_API jesen_err_t jesen_tape_kind(const jesen_tape_ref_t *ref,
+                                      jesen_kind_t *out);
+
+/**
+ * @brief Get the first element of an array or the first member value of an
+ *        object.
+ * @param ref Container value.
+ * @param[out] out Receives the child.
+ * @return JESEN_ERR_NONE on success, JESEN_ERR_NOT_FOUND if empty, or
+ *         JESEN_ERR_WRONG_TYPE if `ref` is not a container.
+ */
+JESEN_API jesen_err_t jesen_tape_child(const jesen_tape_ref_t *ref,
+                                       jesen_tape_ref_t *out);
+
+/**
+ * @brief Get the next sibling of a value in O(1).
+ * @param ref Source value.
+ * @param[out] out Receives the sibling (a member value inside objects).
+ * @return JESEN_ERR_NONE on success or JESEN_ERR_NOT_FOUND after the last.
+ */
+JESEN_API jesen_err_t jesen_tape_next(const jesen_tape_ref_t *ref,
+                                      jesen_tape_ref_t *out);
+
+/**
+ * @brief Get the key of an object member value.
+ * @param ref Member value.
+ * @param[out] out Receives a pointer to the NUL-terminated key, valid until
+ *                 the document is destroyed.
+ * @param[out] out_len Receives the key length (optional).
+ * @return JESEN_ERR_NONE on success or JESEN_ERR_NOT_FOUND if `ref` is not an
+ *         object member.
+ */
+JESEN_API jesen_err_t jesen_tape_key(const jesen_tape_ref_t *ref,
+                                     const char **out, size_t *out_len);
+
+/**
+ * @brief Count the elements of an array or the members of an object.
+ * @param ref Container value.
+ * @param[out] out Receives the count.
+ * @return JESEN_ERR_NONE on success or JESEN_ERR_WRONG_TYPE.
+ */
+JESEN_API jesen_err_t jesen_tape_size(const jesen_tape_ref_t *ref,
+                                      size_t *out);
+
+/**
+ * @brief Look up an object member by key.
+ *
+ * With repeated keys the last member wins, as with `jesen_node_find`.
+ * @param object Object value.
+ * @param key Field name to look up.
+ * @param[out] out Receives the member value.
+ * @return JESEN_ERR_NONE on success, JESEN_ERR_NOT_FOUND if missing, or
+ *         JESEN_ERR_WRONG_TYPE if `object` is not an object.
+ */
+JESEN_API jesen_err_t jesen_tape_find_field(const jesen_tape_ref_t *object,
+                                            const char *key,
+                                            jesen_tape_ref_t *out);
+
+/**
+ * @brief Get an array element; earlier elements are stepped over in O(1)
+ *        each.
+ * @param array Array value.
+ * @param index Zero-based element index.
+ * @param[out] out Receives the element.
+ * @return JESEN_ERR_NONE on success, JESEN_ERR_OUT_OF_RANGE past the end, or
+ *         JESEN_ERR_WRONG_TYPE if `array` is not an array.
+ */
+JESEN_API jesen_err_t jesen_tape_at_index(const jesen_tape_ref_t *array,
+                                          size_t index, jesen_tape_ref_t *out);
+
+/**
+ * @brief Read an integer value. Numbers written with a fraction or exponent,
+ *        or outside the int64 range, are stored as doubles instead.
+ * @param ref Source value.
+ * @param[out] out Receives the value.
+ * @return JESEN_ERR_NONE on success or JESEN_ERR_INVALID_VALUE_TYPE.
+ */
+JESEN_API jesen_err_t jesen_tape_get_int64(const jesen_tape_ref_t *ref,
+                                           int64_t *out);
+
+/**
+ * @brief Read any number value as a double.
+ * @param ref Source value.
+ * @param[out] out Receives the value.
+ * @return JESEN_ERR_NONE on success or JESEN_ERR_INVALID_VALUE_TYPE.
+ */
+JESEN_API jesen_err_t jesen_tape_get_double(const jesen_tape_ref_t *ref,
+                                            double *out);
+
+/**
+ * @brief Read a boolean value.
+ * @param ref Source value.
+ * @param[out] out Receives the value.
+ * @return JESEN_ERR_NONE on success or JESEN_ERR_INVALID_VALUE_TYPE.
+ */
+JESEN_API jesen_err_t jesen_tape_get_bool(const jesen_tape_ref_t *ref,
+                                          bool *out);
+
+/**
+ * @brief Borrow a decoded string value.
+ * @param ref Source value.
+ * @param[out] out Receives a pointer to the NUL-terminated string, valid until
+ *                 the document is destroyed.
+ * @param[out] out_len Receives the string length (optional).
+ * @return JESEN_ERR_NONE on success or JESEN_ERR_INVALID_VALUE_TYPE.
+ */
+JESEN_API jesen_err_t jesen_tape_get_string(const jesen_tape_ref_t *ref,
+                                            const char **out, size_t *out_len);
+
+/** `jesen_parse_file` flag: keep the file mapped and borrow strings from it. */
+#define JESEN_FILE_KEEP_MAPPING 0x1u
+
+/**
+ * @brief Parse a JSON file, memory-mapping it where possible.
+ *
+ * By default the file is mapped read-only, parsed like `jesen_parse` and
+ * unmapped again, so no heap copy of the input is made. With
+ * `JESEN_FILE_KEEP_MAPPING` the file is mapped copy-on-write and parsed in
+ * situ (see `jesen_parse_insitu`): keys and strings point into the mapping,
+ * which the root owns and unmaps in `jesen_destroy`. The file itself is never
+ * modified. Nodes detached from such a tree must not outlive its root.
+ * Files that cannot be mapped are read into memory instead.
+ * @param path Path of the file to parse.
+ * @param flags Zero or more of `JESEN_FILE_KEEP_MAPPING`,
+ *              `JESEN_PARSE_STRICT_UTF8`, `JESEN_PARSE_EAGER_WRAPPERS` and
+ *              `JESEN_PARSE_INTERN_KEYS`.
+ * @param[out] out Receives the root node; caller must destroy with
+ *                 `jesen_destroy`.
+ * @return JESEN_ERR_NONE on success, JESEN_ERR_NOT_FOUND if the file does
+ *         not exist, JESEN_ERR_UNKNOWN if it cannot be opened otherwise,
+ *         JESEN_ERR_INVALID_ARGS for unknown flags, JESEN_ERR_PARSE for
+ *         malformed input, or another error code.
+ */
+JESEN_API jesen_err_t jesen_parse_file(const char *path, uint32_t flags,
+                                       jesen_node_t **out);
+
+/**
+ * @brief Parse newline-delimited JSON (NDJSON / JSON Lines) in parallel.
+ *
+ * Each non-blank line must hold one JSON document. Lines are parsed on a pool
+ * of `threads` threads (the calling thread included) and returned in input
+ * order.
+ * @param buf Input buffer.
+ * @param buf_len Length of `buf` in bytes.
+ * @param threads Number of threads to use, or 0 for one per online CPU.
+ *                Builds without thread support always parse sequentially.
+ * @param[out] out_roots Receives an array of `*out_count` roots; release it
+ *                       with `jesen_roots_destroy`.
+ * @param[out] out_count Receives the number of records.
+ * @return JESEN_ERR_NONE on success or the first error hit; on failure no
+ *         roots are returned.
+ */
+JESEN_API jesen_err_t jesen_parse_ndjson(const char *buf, size_t buf_len,
+                                         size_t threads,
+                                         jesen_node_t ***out_roots,
+                                         size_t *out_count);
+
+/**
+ * @brief Parse NDJSON in parallel and stream each record to a callback.
+ * @param buf Input buffer.
+ * @param buf_len Length of `buf` in bytes.
+ * @param threads Number of threads to use, or 0 for one per online CPU.
+ * @param fn Callback receiving each record (see `jesen_ndjson_record_fn`).
+ * @param ctx Opaque pointer passed to `fn`.
+ * @return JESEN_ERR_NONE on success, or the first parse error or callback
+ *         error hit. Records after a failure may not be delivered.
+ */
+JESEN_API jesen_err_t jesen_parse_ndjson_each(const char *buf, size_t buf_len,
+                                              size_t threads,
+                                              jesen_ndjson_record_fn fn,
+                                              void *ctx);
+
+/**
+ * @brief Destroy every root in an array from `jesen_parse_ndjson`, then the
+ *        array itself.
+ * @param roots Array of roots (NULL entries are skipped).
+ * @param count Number of entries in `roots`.
+ * @return JESEN_ERR_NONE on success or an error code.
+ */
+JESEN_API jesen_err_t jesen_roots_destroy(jesen_node_t **roots, size_t count);
+
+/**
+ * @brief Parse a document whose root is a large array on several threads.
+ *
+ * The array is split between top-level elements and the pieces are parsed
+ * concurrently, giving the same tree and the same errors as `jesen_parse`.
+ * Other documents, small arrays and builds without thread support are simply
+ * parsed sequentially.
+ * @param buf Input buffer.
+ * @param buf_len Length of the input buffer.
+ * @param threads Number of threads to use, or 0 for one per online CPU.
+ * @param[out] out Receives the parsed root.
+ * @return JESEN_ERR_NONE on success or an error code.
+ */
+JESEN_API jesen_err_t jesen_parse_parallel(const char *buf, size_t buf_len,
+                                           size_t threads, jesen_node_t **out);
+
+/**
+ * @brief Create an incremental (push) parser.
+ *
+ * Feed a document in any number of chunks with `jesen_parser_feed`, then call
+ * `jesen_parser_finish` to get the same tree `jesen_parse` would build from
+ * the concatenated input. Chunks may split the input anywhere, including
+ * inside strings, escape sequences and numbers.
+ * @param[out] out Receives the parser; release with `jesen_parser_destroy`.
+ * @return JESEN_ERR_NONE on success or an error code.
+ */
+JESEN_API jesen_err_t jesen_parser_create(jesen_parser_t **out);
+
+/**
+ * @brief Feed the next chunk of the document.
+ *
+ * The chunk is not referenced after the call returns. Once a chunk fails,
+ * later feeds return the same error until `jesen_parser_finish` resets the
+ * parser.
+ * @param parser Parser from `jesen_parser_create`.
+ * @param chunk Next bytes of the document.
+ * @param len Length of `chunk` in bytes.
+ * @return JESEN_ERR_NONE on success or an error code (e.g., JESEN_ERR_PARSE).
+ */
+JESEN_API jesen_err_t jesen_parser_feed(jesen_parser_t *parser,
+                                        const char *chunk, size_t len);
+
+/**
+ * @brief Complete the document and return its tree.
+ *
+ * The parser is reset afterwards and can be fed a new document.
+ * @param parser Parser from `jesen_parser_create`.
+ * @param[out] out Receives the root node; caller must destroy with
+ *                 `jesen_destroy`.
+ * @return JESEN_ERR_NONE on success, JESEN_ERR_PARSE if the input was
+ *         malformed or incomplete, or another error code.
+ */
+JESEN_API jesen_err_t jesen_parser_finish(jesen_parser_t *parser,
+                                          jesen_node_t **out);
+
+/**
+ * @brief Destroy a parser and any partially built document.
+ * @param parser Parser to free.
+ * @return JESEN_ERR_NONE on success or an error code.
+ */
+JESEN_API jesen_err_t jesen_parser_destroy(jesen_parser_t *parser);
+
+/**
+ * @brief Create a reusable parse context.
+ *
+ * A document owns a growing pool of memory that every tree it parses is
+ * carved from. Resetting it rewinds the pool instead of freeing it, so a
+ * loop that parses one input per iteration stops calling malloc once the
+ * pool has grown to fit the largest input.
+ * @param[out] out Receives the document; release with `jesen_doc_destroy`.
+ * @return JESEN_ERR_NONE on success or an error code.
+ */
+JESEN_API jesen_err_t jesen_doc_create(jesen_doc_t **out);
+
+/**
+ * @brief Reset `doc` and parse JSON text into its pool.
+ *
+ * Accepts the same input as `jesen_parse`. The tree stays valid until the
+ * next `jesen_doc_parse`, `jesen_doc_reset` or `jesen_doc_destroy`; calling
+ * `jesen_destroy` on it is allowed but frees nothing back to the pool.
+ * Values later added to the tree through the mutation API are carved from
+ * the pool too. Heap nodes cannot be attached to it, since the reset would
+ * not see them; copy them in with `jesen_node_copy`.
+ * @param doc Document from `jesen_doc_create`.
+ * @param buf Input buffer.
+ * @param buf_len Length of `buf` in bytes.
+ * @param[out] out Receives the root node.
+ * @return JESEN_ERR_NONE on success or an error code (e.g., JESEN_ERR_PARSE).
+ */
+JESEN_API jesen_err_t jesen_doc_parse(jesen_doc_t *doc, const char *buf,
+                                      size_t buf_len, jesen_node_t **out);
+
+/**
+ * @brief Create an empty object carved from `doc`.
+ *
+ * Unlike `jesen_doc_parse` this does not reset `doc`, so several trees can
+ * share it. Values added to the tree come from the pool as well, and it
+ * stays valid until the next `jesen_doc_parse`, `jesen_doc_reset` or
+ * `jesen_doc_destroy`.
+ * @param doc Document from `jesen_doc_create`.
+ * @param[out] out Receives the new object.
+ * @return JESEN_ERR_NONE on success or an error code.
+ */
+JESEN_API jesen_err_t jesen_doc_object_create(jesen_doc_t *doc,
+                                              jesen_node_t **out);
+
+/**
+ * @brief Create an empty array carved from `doc`; see
+ *        `jesen_doc_object_create`.
+ * @param doc Document from `jesen_doc_create`.
+ * @param[out] out Receives the new array.
+ * @return JESEN_ERR_NONE on success or an error code.
+ */
+JESEN_API jesen_err_t jesen_doc_array_create(jesen_doc_t *doc,
+                                             jesen_node_t **out);
+
+/**
+ * @brief Deep-copy a node and its subtree into `doc`, or onto the heap.
+ *
+ * Nodes carved from a document cannot be attached to a tree outside it,
+ * since a reset of their document would pull them out from under that tree,
+ * and heap nodes cannot join a document's tree, which its reset would leak;
+ * copy them instead. The copy keeps member order and duplicate keys, and
+ * does not reset `doc`.
+ * @param node Node to copy; it is left unchanged.
+ * @param doc Document to carve the copy from, or NULL for a heap tree.
+ * @param[out] out Receives the unattached copy.
+ * @return JESEN_ERR_NONE on success or an error code.
+ */
+JESEN_API jesen_err_t jesen_node_copy(jesen_node_t *node, jesen_doc_t *doc,
+                                      jesen_node_t **out);
+
+/**
+ * @brief Release every tree parsed into `doc` in O(1), keeping the memory.
+ * @param doc Document to reset.
+ * @return JESEN_ERR_NONE on success or an error code.
+ */
+JESEN_API jesen_err_t jesen_doc_reset(jesen_doc_t *doc);
+
+/**
+ * @brief Destroy a document and return its memory to the system.
+ * @param doc Document to free.
+ * @return JESEN_ERR_NONE on success or an error code.
+ */
+JESEN_API jesen_err_t jesen_doc_destroy(jesen_doc_t *doc);
+
 /**
  * @brief Destroy a node and its subtree.
  * @param node Root or detached node to free.
@@ -1,21 +1,66 @@
 #include "cJSON/cJSON.h"
-#include "jesen.h"
+#include "jesen_internal.h"
 #include <stdlib.h>
 #include <string.h>
 
+// Child wrappers of a container in document order, so indexed access and
+// iteration need not walk the wrapper list (which runs from the last child
+// to the first).
+typedef struct {
+  size_t count;
+  size_t cap;
+  jesen_node_t *items[];
+} jesen_elements_t;
+
 struct jesen_node {
   cJSON *cjson;
   jesen_node_t *parent;
   jesen_node_t *sibling;
+  // the wrapper whose `sibling` is this one, i.e. the next child in document
+  // order; NULL for the last child. It lets a child unlink itself in O(1).
+  jesen_node_t *prior;
   jesen_node_t *child;
+  // set while the cJSON children of this node have no wrappers yet; parsed
+  // trees are wrapped one level at a time on first access.
+  bool lazy;
+  // memory the tree borrows strings from; only ever set on a parsed root.
+  jesen_backing_t *backing;
+  // source of this wrapper and of the wrappers made for its children; NULL
+  // for malloc.
+  const jesen_allocator_t *allocator;
+  // objects: key index over the child wrappers, built by the first lookup
+  // that scans JESEN_INDEX_MIN_MEMBERS members.
+  jesen_index_t *index;
+  // containers: element vector, built by the first indexed access or
+  // iteration.
+  jesen_elements_t *elements;
 };
 
+// cJSON type bit for items carved from a document pool. jesen_cjson_delete
+// leaves such items and their value strings to the pool; their keys are
+// marked cJSON_StringIsConst, so cJSON never frees those either.
+#define JESEN_CJSON_POOL 0x1000
+
 static jesen_err_t jesen_free(jesen_node_t *node);
-static jesen_err_t jesen_build_wrapper_tree(cJSON *json, jesen_node_t *parent,
-                                            jesen_node_t **out);
-static jesen_node_t *jesen_find_child_wrapper(jesen_node_t *parent,
-                                              cJSON *child_cjson,
-                                              jesen_node_t **out_prev);
+static void jesen_cjson_delete(cJSON *item);
+static jesen_err_t jesen_wrap(cJSON *json, jesen_node_t *parent,
+                              const jesen_allocator_t *allocator,
+                              jesen_node_t **out);
+static jesen_err_t jesen_materialize_children(jesen_node_t *node);
+static void jesen_link_child(jesen_node_t *parent, jesen_node_t *child);
+static void jesen_unlink_child(jesen_node_t *parent, jesen_node_t *child);
+static jesen_node_t *jesen_object_lookup(jesen_node_t *object,
+                                         const char *key);
+static void jesen_index_added(jesen_node_t *object, jesen_node_t *member);
+static void jesen_index_removed(jesen_node_t *object, jesen_node_t *member);
+static jesen_err_t jesen_pool_add(jesen_node_t *parent, const char *key,
+                                  int type, double number, const char *str,
+                                  size_t str_len, jesen_node_t **out);
+static jesen_elements_t *jesen_node_elements(jesen_node_t *node);
+static void jesen_elements_added(jesen_node_t *node, jesen_node_t *element);
+static void jesen_elements_removed(jesen_node_t *node, size_t pos);
+static void jesen_elements_unlinked(jesen_node_t *node,
+                                    const jesen_node_t *element);
 
 // { } -> is the root
 // { "a": { } } -> "a" is the child of root.
@@ -59,6 +104,15 @@ jesen_err_t jesen_object_create_to(jesen_node_t *parent, const char *name,
     return JESEN_ERR_INVALID_ARGS;
   }
 
+  jesen_err_t err = jesen_materialize_children(parent);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+
+  if (jesen_allocator_is_pool(parent->allocator)) {
+    return jesen_pool_add(parent, name, cJSON_Object, 0, NULL, 0, out);
+  }
+
   jesen_node_t *created = (jesen_node_t *)calloc(1, sizeof *created);
   if (!created) {
     return JESEN_ERR_ALLOC;
@@ -71,9 +125,7 @@ jesen_err_t jesen_object_create_to(jesen_node_t *parent, const char *name,
     return JESEN_ERR_ALLOC;
   }
 
-  created->sibling = parent->child;
-  created->child = NULL;
-  parent->child = created;
+  jesen_link_child(parent, created);
 
   *out = created;
 
@@ -94,10 +146,31 @@ jesen_err_t jesen_node_assign_to(jesen_node_t *parent, const char *name,
     return JESEN_ERR_ALREADY_ATTACHED;
   }
 
+  if (jesen_allocator_foreign(parent->allocator, node->allocator)) {
+    return JESEN_ERR_NOT_OWNED;
+  }
+
+  jesen_err_t err = jesen_materialize_children(parent);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+
   if (cJSON_IsArray(parent->cjson)) {
     if (!cJSON_AddItemToArray(parent->cjson, node->cjson)) {
       return JESEN_ERR_MUTATION_FAILED;
     }
+  } else if (cJSON_IsObject(parent->cjson) &&
+             jesen_allocator_is_pool(parent->allocator)) {
+    // Carve the key from the pool as well; cJSON then leaves it alone.
+    size_t len = strlen(name);
+    char *key = (char *)jesen_alloc(parent->allocator, len + 1);
+    if (!key) {
+      return JESEN_ERR_ALLOC;
+    }
+    memcpy(key, name, len + 1);
+    if (!cJSON_AddItemToObjectCS(parent->cjson, key, node->cjson)) {
+      return JESEN_ERR_MUTATION_FAILED;
+    }
   } else if (cJSON_IsObject(parent->cjson)) {
     if (!cJSON_AddItemToObject(parent->cjson, name, node->cjson)) {
       return JESEN_ERR_MUTATION_FAILED;
@@ -106,9 +179,7 @@ jesen_err_t jesen_node_assign_to(jesen_node_t *parent, const char *name,
     return JESEN_ERR_WRONG_TYPE;
   }
 
-  node->sibling = parent->child;
-  node->parent = parent;
-  parent->child = node;
+  jesen_link_child(parent, node);
 
   return JESEN_ERR_NONE;
 }
@@ -140,6 +211,15 @@ jesen_err_t jesen_array_create_to(jesen_node_t *parent, const char *name,
     return JESEN_ERR_INVALID_ARGS;
   }
 
+  jesen_err_t err = jesen_materialize_children(parent);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+
+  if (jesen_allocator_is_pool(parent->allocator)) {
+    return jesen_pool_add(parent, name, cJSON_Array, 0, NULL, 0, out);
+  }
+
   jesen_node_t *created = (jesen_node_t *)calloc(1, sizeof *created);
   if (!created) {
     return JESEN_ERR_ALLOC;
@@ -152,9 +232,7 @@ jesen_err_t jesen_array_create_to(jesen_node_t *parent, const char *name,
     return JESEN_ERR_ALLOC;
   }
 
-  created->sibling = parent->child;
-  created->child = NULL;
-  parent->child = created;
+  jesen_link_child(parent, created);
 
   *out = created;
   return JESEN_ERR_NONE;
@@ -170,6 +248,15 @@ jesen_err_t jesen_object_add_double(jesen_node_t *node, const char *key,
     return JESEN_ERR_WRONG_TYPE;
   }
 
+  jesen_err_t err = jesen_materialize_children(node);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+
+  if (jesen_allocator_is_pool(node->allocator)) {
+    return jesen_pool_add(node, key, cJSON_Number, value, NULL, 0, NULL);
+  }
+
   jesen_node_t *created = (jesen_node_t *)calloc(1, sizeof *created);
   if (!created) {
     return JESEN_ERR_ALLOC;
@@ -182,10 +269,7 @@ jesen_err_t jesen_object_add_double(jesen_node_t *node, const char *key,
     return JESEN_ERR_ALLOC;
   }
 
-  created->child = NULL;
-  created->parent = node;
-  created->sibling = node->child;
-  node->child = created;
+  jesen_link_child(node, created);
 
   return JESEN_ERR_NONE;
 }
@@ -200,6 +284,16 @@ jesen_err_t jesen_object_add_int32(jesen_node_t *node, const char *key,
     return JESEN_ERR_WRONG_TYPE;
   }
 
+  jesen_err_t err = jesen_materialize_children(node);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+
+  if (jesen_allocator_is_pool(node->allocator)) {
+    return jesen_pool_add(node, key, cJSON_Number, (double)value, NULL, 0,
+                          NULL);
+  }
+
   jesen_node_t *created = (jesen_node_t *)calloc(1, sizeof *created);
   if (!created) {
     return JESEN_ERR_ALLOC;
@@ -211,10 +305,7 @@ jesen_err_t jesen_object_add_int32(jesen_node_t *node, const char *key,
     return JESEN_ERR_ALLOC;
   }
 
-  created->child = NULL;
-  created->parent = node;
-  created->sibling = node->child;
-  node->child = created;
+  jesen_link_child(node, created);
 
   return JESEN_ERR_NONE;
 }
@@ -229,6 +320,16 @@ jesen_err_t jesen_object_add_bool(jesen_node_t *node, const char *key,
     return JESEN_ERR_WRONG_TYPE;
   }
 
+  jesen_err_t err = jesen_materialize_children(node);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+
+  if (jesen_allocator_is_pool(node->allocator)) {
+    return jesen_pool_add(node, key, value ? cJSON_True : cJSON_False, 0,
+                          NULL, 0, NULL);
+  }
+
   jesen_node_t *created = (jesen_node_t *)calloc(1, sizeof *created);
   if (!created) {
     return JESEN_ERR_ALLOC;
@@ -240,10 +341,7 @@ jesen_err_t jesen_object_add_bool(jesen_node_t *node, const char *key,
     return JESEN_ERR_ALLOC;
   }
 
-  created->child = NULL;
-  created->parent = node;
-  created->sibling = node->child;
-  node->child = created;
+  jesen_link_child(node, created);
 
   return JESEN_ERR_NONE;
 }
@@ -257,6 +355,15 @@ jesen_err_t jesen_object_add_null(jesen_node_t *node, const char *key) {
     return JESEN_ERR_WRONG_TYPE;
   }
 
+  jesen_err_t err = jesen_materialize_children(node);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+
+  if (jesen_allocator_is_pool(node->allocator)) {
+    return jesen_pool_add(node, key, cJSON_NULL, 0, NULL, 0, NULL);
+  }
+
   jesen_node_t *created = (jesen_node_t *)calloc(1, sizeof *created);
   if (!created) {
     return JESEN_ERR_ALLOC;
@@ -268,10 +375,7 @@ jesen_err_t jesen_object_add_null(jesen_node_t *node, const char *key) {
     return JESEN_ERR_ALLOC;
   }
 
-  created->child = NULL;
-  created->parent = node;
-  created->sibling = node->child;
-  node->child = created;
+  jesen_link_child(node, created);
 
   return JESEN_ERR_NONE;
 }
@@ -286,6 +390,15 @@ jesen_err_t jesen_object_add_string(jesen_node_t *node, const char *key,
     return JESEN_ERR_WRONG_TYPE;
   }
 
+  jesen_err_t err = jesen_materialize_children(node);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+
+  if (jesen_allocator_is_pool(node->allocator)) {
+    return jesen_pool_add(node, key, cJSON_String, 0, value, value_len, NULL);
+  }
+
   char *tmp = (char *)calloc(value_len + 1, sizeof(char));
   if (!tmp) {
     return JESEN_ERR_ALLOC;
@@ -307,16 +420,13 @@ jesen_err_t jesen_object_add_string(jesen_node_t *node, const char *key,
   }
 
   if (!cJSON_AddItemToObject(node->cjson, key, string_json)) {
-    cJSON_Delete(string_json);
+    jesen_cjson_delete(string_json);
     free(created);
     return JESEN_ERR_MUTATION_FAILED;
   }
 
   created->cjson = string_json;
-  created->child = NULL;
-  created->parent = node;
-  created->sibling = node->child;
-  node->child = created;
+  jesen_link_child(node, created);
 
   return JESEN_ERR_NONE;
 }
@@ -330,27 +440,23 @@ jesen_err_t jesen_object_remove(jesen_node_t *node, const char *key) {
     return JESEN_ERR_WRONG_TYPE;
   }
 
-  cJSON *target = cJSON_GetObjectItem(node->cjson, key);
-  if (!target) {
-    return JESEN_ERR_NOT_FOUND;
+  jesen_err_t err = jesen_materialize_children(node);
+  if (err != JESEN_ERR_NONE) {
+    return err;
   }
 
-  jesen_node_t *prev = NULL;
-  jesen_node_t *wrapped = jesen_find_child_wrapper(node, target, &prev);
-  if (!wrapped) {
-    return JESEN_ERR_NOT_OWNED;
+  // Remove the member jesen_node_find would return.
+  jesen_node_t *target = jesen_object_lookup(node, key);
+  if (!target) {
+    return JESEN_ERR_NOT_FOUND;
   }
 
-  if (prev) {
-    prev->sibling = wrapped->sibling;
-  } else {
-    node->child = wrapped->sibling;
-  }
+  jesen_index_removed(node, target);
+  jesen_elements_unlinked(node, target);
+  jesen_unlink_child(node, target);
 
-  cJSON_DeleteItemFromObject(node->cjson, key);
-  wrapped->parent = NULL;
-  wrapped->sibling = NULL;
-  jesen_free(wrapped);
+  jesen_cjson_delete(cJSON_DetachItemViaPointer(node->cjson, target->cjson));
+  jesen_free(target);
 
   return JESEN_ERR_NONE;
 }
@@ -364,6 +470,15 @@ jesen_err_t jesen_array_add_double(jesen_node_t *array, double value) {
     return JESEN_ERR_WRONG_TYPE;
   }
 
+  jesen_err_t err = jesen_materialize_children(array);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+
+  if (jesen_allocator_is_pool(array->allocator)) {
+    return jesen_pool_add(array, NULL, cJSON_Number, value, NULL, 0, NULL);
+  }
+
   jesen_node_t *created = (jesen_node_t *)calloc(1, sizeof *created);
   if (!created) {
     return JESEN_ERR_ALLOC;
@@ -376,15 +491,12 @@ jesen_err_t jesen_array_add_double(jesen_node_t *array, double value) {
   }
 
   if (!cJSON_AddItemToArray(array->cjson, created->cjson)) {
-    cJSON_Delete(created->cjson);
+    jesen_cjson_delete(created->cjson);
     free(created);
     return JESEN_ERR_MUTATION_FAILED;
   }
 
-  created->child = NULL;
-  created->parent = array;
-  created->sibling = array->child;
-  array->child = created;
+  jesen_link_child(array, created);
 
   return JESEN_ERR_NONE;
 }
@@ -398,6 +510,16 @@ jesen_err_t jesen_array_add_int32(jesen_node_t *array, int32_t value) {
     return JESEN_ERR_WRONG_TYPE;
   }
 
+  jesen_err_t err = jesen_materialize_children(array);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+
+  if (jesen_allocator_is_pool(array->allocator)) {
+    return jesen_pool_add(array, NULL, cJSON_Number, (double)value, NULL, 0,
+                          NULL);
+  }
+
   jesen_node_t *created = (jesen_node_t *)calloc(1, sizeof *created);
   if (!created) {
     return JESEN_ERR_ALLOC;
@@ -410,15 +532,12 @@ jesen_err_t jesen_array_add_int32(jesen_node_t *array, int32_t value) {
   }
 
   if (!cJSON_AddItemToArray(array->cjson, created->cjson)) {
-    cJSON_Delete(created->cjson);
+    jesen_cjson_delete(created->cjson);
     free(created);
     return JESEN_ERR_MUTATION_FAILED;
   }
 
-  created->child = NULL;
-  created->parent = array;
-  created->sibling = array->child;
-  array->child = created;
+  jesen_link_child(array, created);
 
   return JESEN_ERR_NONE;
 }
@@ -432,6 +551,16 @@ jesen_err_t jesen_array_add_bool(jesen_node_t *array, bool value) {
     return JESEN_ERR_WRONG_TYPE;
   }
 
+  jesen_err_t err = jesen_materialize_children(array);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+
+  if (jesen_allocator_is_pool(array->allocator)) {
+    return jesen_pool_add(array, NULL, value ? cJSON_True : cJSON_False, 0,
+                          NULL, 0, NULL);
+  }
+
   jesen_node_t *created = (jesen_node_t *)calloc(1, sizeof *created);
   if (!created) {
     return JESEN_ERR_ALLOC;
@@ -444,15 +573,12 @@ jesen_err_t jesen_array_add_bool(jesen_node_t *array, bool value) {
   }
 
   if (!cJSON_AddItemToArray(array->cjson, created->cjson)) {
-    cJSON_Delete(created->cjson);
+    jesen_cjson_delete(created->cjson);
     free(created);
     return JESEN_ERR_MUTATION_FAILED;
   }
 
-  created->child = NULL;
-  created->parent = array;
-  created->sibling = array->child;
-  array->child = created;
+  jesen_link_child(array, created);
 
   return JESEN_ERR_NONE;
 }
@@ -467,6 +593,15 @@ jesen_err_t jesen_array_add_string(jesen_node_t *array, const char *value,
     return JESEN_ERR_WRONG_TYPE;
   }
 
+  jesen_err_t err = jesen_materialize_children(array);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+
+  if (jesen_allocator_is_pool(array->allocator)) {
+    return jesen_pool_add(array, NULL, cJSON_String, 0, value, value_len, NULL);
+  }
+
   char *tmp = (char *)calloc(value_len + 1, sizeof(char));
   if (!tmp) {
     return JESEN_ERR_ALLOC;
@@ -488,16 +623,13 @@ jesen_err_t jesen_array_add_string(jesen_node_t *array, const char *value,
   }
 
   if (!cJSON_AddItemToArray(array->cjson, str_item)) {
-    cJSON_Delete(str_item);
+    jesen_cjson_delete(str_item);
     free(created);
     return JESEN_ERR_MUTATION_FAILED;
   }
 
   created->cjson = str_item;
-  created->child = NULL;
-  created->parent = array;
-  created->sibling = array->child;
-  array->child = created;
+  jesen_link_child(array, created);
 
   return JESEN_ERR_NONE;
 }
@@ -512,17 +644,20 @@ jesen_err_t jesen_array_get_value(jesen_node_t *array, uint32_t index,
     return JESEN_ERR_WRONG_TYPE;
   }
 
-  cJSON *item = cJSON_GetArrayItem(array->cjson, (int)index);
-  if (!item) {
-    return JESEN_ERR_OUT_OF_RANGE;
+  jesen_err_t err = jesen_materialize_children(array);
+  if (err != JESEN_ERR_NONE) {
+    return err;
   }
 
-  jesen_node_t *wrapped = jesen_find_child_wrapper(array, item, NULL);
-  if (!wrapped) {
-    return JESEN_ERR_NOT_OWNED;
+  jesen_elements_t *elements = jesen_node_elements(array);
+  if (!elements) {
+    return JESEN_ERR_ALLOC;
+  }
+  if (index >= elements->count) {
+    return JESEN_ERR_OUT_OF_RANGE;
   }
 
-  *out = wrapped;
+  *out = elements->items[index];
   return JESEN_ERR_NONE;
 }
 
@@ -536,40 +671,69 @@ jesen_err_t jesen_array_set_value(jesen_node_t *array, uint32_t index,
     return JESEN_ERR_ALREADY_ATTACHED;
   }
 
+  if (jesen_allocator_foreign(array->allocator, value->allocator)) {
+    return JESEN_ERR_NOT_OWNED;
+  }
+
   if (!cJSON_IsArray(array->cjson)) {
     return JESEN_ERR_WRONG_TYPE;
   }
 
-  cJSON *existing = cJSON_GetArrayItem(array->cjson, (int)index);
-  if (!existing) {
-    return JESEN_ERR_OUT_OF_RANGE;
+  jesen_err_t err = jesen_materialize_children(array);
+  if (err != JESEN_ERR_NONE) {
+    return err;
   }
 
-  jesen_node_t *prev = NULL;
-  jesen_node_t *wrapped_existing =
-      jesen_find_child_wrapper(array, existing, &prev);
-  if (!wrapped_existing) {
-    return JESEN_ERR_NOT_OWNED;
+  jesen_elements_t *elements = jesen_node_elements(array);
+  if (!elements) {
+    return JESEN_ERR_ALLOC;
+  }
+  if (index >= elements->count) {
+    return JESEN_ERR_OUT_OF_RANGE;
   }
 
-  if (!cJSON_ReplaceItemInArray(array->cjson, (int)index, value->cjson)) {
-    return JESEN_ERR_MUTATION_FAILED;
+  jesen_node_t *wrapped_existing = elements->items[index];
+  cJSON *existing = wrapped_existing->cjson;
+  // Splice the new item into the old one's place: cJSON's insert walks to
+  // the index and its replace frees the old item recursively. The head's
+  // `prev` is the tail.
+  cJSON *item = value->cjson;
+  item->prev = existing->prev;
+  item->next = existing->next;
+  if (array->cjson->child == existing) {
+    array->cjson->child = item;
+  } else {
+    existing->prev->next = item;
+  }
+  if (existing->next) {
+    existing->next->prev = item;
+  } else {
+    array->cjson->child->prev = item;
   }
+  existing->prev = NULL;
+  existing->next = NULL;
+  jesen_cjson_delete(existing);
 
-  if (prev) {
-    prev->sibling = wrapped_existing->sibling;
+  // The new wrapper takes the old one's place, keeping the wrapper list in
+  // reverse document order.
+  if (wrapped_existing->prior) {
+    wrapped_existing->prior->sibling = value;
   } else {
-    array->child = wrapped_existing->sibling;
+    array->child = value;
   }
+  if (wrapped_existing->sibling) {
+    wrapped_existing->sibling->prior = value;
+  }
+  value->parent = array;
+  value->sibling = wrapped_existing->sibling;
+  value->prior = wrapped_existing->prior;
+  elements->items[index] = value;
 
   wrapped_existing->parent = NULL;
   wrapped_existing->sibling = NULL;
+  wrapped_existing->prior = NULL;
   jesen_free(wrapped_existing);
 
-  value->parent = array;
-  value->sibling = array->child;
-  array->child = value;
-
   return JESEN_ERR_NONE;
 }
 
@@ -582,590 +746,990 @@ jesen_err_t jesen_array_remove(jesen_node_t *array, uint32_t index) {
     return JESEN_ERR_WRONG_TYPE;
   }
 
-  cJSON *item = cJSON_GetArrayItem(array->cjson, (int)index);
-  if (!item) {
-    return JESEN_ERR_OUT_OF_RANGE;
+  jesen_err_t err = jesen_materialize_children(array);
+  if (err != JESEN_ERR_NONE) {
+    return err;
   }
 
-  jesen_node_t *prev = NULL;
-  jesen_node_t *wrapped = jesen_find_child_wrapper(array, item, &prev);
-  if (!wrapped) {
-    return JESEN_ERR_NOT_OWNED;
+  jesen_elements_t *elements = jesen_node_elements(array);
+  if (!elements) {
+    return JESEN_ERR_ALLOC;
   }
-
-  if (prev) {
-    prev->sibling = wrapped->sibling;
-  } else {
-    array->child = wrapped->sibling;
+  if (index >= elements->count) {
+    return JESEN_ERR_OUT_OF_RANGE;
   }
 
-  cJSON_DeleteItemFromArray(array->cjson, (int)index);
-  wrapped->parent = NULL;
-  wrapped->sibling = NULL;
+  jesen_node_t *wrapped = elements->items[index];
+  jesen_elements_removed(array, index);
+  jesen_unlink_child(array, wrapped);
+
+  jesen_cjson_delete(cJSON_DetachItemViaPointer(array->cjson, wrapped->cjson));
   jesen_free(wrapped);
 
   return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_array_get_int32(jesen_node_t *array, uint32_t index,
-                                  int32_t *out) {
-  if (!out) {
+jesen_err_t jesen_node_find(const jesen_node_t *node, const char *key,
+                            jesen_node_t **out) {
+  if (!node || !key || !out) {
     return JESEN_ERR_INVALID_ARGS;
   }
-  jesen_node_t *node = NULL;
-  jesen_err_t err = jesen_array_get_value(array, index, &node);
-  if (err != JESEN_ERR_NONE) {
-    return err;
-  }
-  return jesen_value_get_int32(node, out);
-}
 
-jesen_err_t jesen_array_get_double(jesen_node_t *array, uint32_t index,
-                                   double *out) {
-  if (!out) {
-    return JESEN_ERR_INVALID_ARGS;
+  if (!cJSON_IsObject(node->cjson)) {
+    return JESEN_ERR_WRONG_TYPE;
   }
-  jesen_node_t *node = NULL;
-  jesen_err_t err = jesen_array_get_value(array, index, &node);
+
+  // Wrapping children or indexing them does not change the JSON value, so a
+  // const lookup may still do both.
+  jesen_err_t err = jesen_materialize_children((jesen_node_t *)node);
   if (err != JESEN_ERR_NONE) {
     return err;
   }
-  return jesen_value_get_double(node, out);
-}
 
-jesen_err_t jesen_array_get_bool(jesen_node_t *array, uint32_t index,
-                                 bool *out) {
-  if (!out) {
-    return JESEN_ERR_INVALID_ARGS;
-  }
-  jesen_node_t *node = NULL;
-  jesen_err_t err = jesen_array_get_value(array, index, &node);
-  if (err != JESEN_ERR_NONE) {
-    return err;
+  jesen_node_t *found = jesen_object_lookup((jesen_node_t *)node, key);
+  if (!found) {
+    return JESEN_ERR_NOT_FOUND;
   }
-  return jesen_value_get_bool(node, out);
+
+  *out = found;
+  return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_array_get_string(jesen_node_t *array, uint32_t index,
-                                   char *out, size_t out_max, size_t *out_len) {
-  if (!out) {
+jesen_err_t jesen_value_get_string(const jesen_node_t *node, char *out,
+                                   size_t out_max, size_t *out_len) {
+  if (!node || !node->cjson || !out || out_max == 0) {
     return JESEN_ERR_INVALID_ARGS;
   }
-  jesen_node_t *node = NULL;
-  jesen_err_t err = jesen_array_get_value(array, index, &node);
-  if (err != JESEN_ERR_NONE) {
-    return err;
+
+  if (!cJSON_IsString(node->cjson)) {
+    return JESEN_ERR_INVALID_VALUE_TYPE;
   }
-  return jesen_value_get_string(node, out, out_max, out_len);
-}
 
-jesen_err_t jesen_array_get_object_value(jesen_node_t *array, uint32_t index,
-                                         const char *key, jesen_node_t **out) {
-  if (!array || !key || !out) {
+  const char *str = node->cjson->valuestring ? node->cjson->valuestring : "";
+  size_t len = strlen(str);
+  if (len + 1 > out_max) {
     return JESEN_ERR_INVALID_ARGS;
   }
-  jesen_node_t *elem = NULL;
-  jesen_err_t err = jesen_array_get_value(array, index, &elem);
-  if (err != JESEN_ERR_NONE) {
-    return err;
-  }
-  if (!cJSON_IsObject(elem->cjson)) {
-    return JESEN_ERR_WRONG_TYPE;
+  memcpy(out, str, len + 1);
+  if (out_len) {
+    *out_len = len;
   }
-  return jesen_node_find(elem, key, out);
+  return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_array_get_object_int32(jesen_node_t *array, uint32_t index,
-                                         const char *key, int32_t *out) {
-  if (!out) {
+jesen_err_t jesen_value_get_string_ref(const jesen_node_t *node,
+                                       const char **out, size_t *out_len) {
+  if (!node || !node->cjson || !out) {
     return JESEN_ERR_INVALID_ARGS;
   }
-  jesen_node_t *child = NULL;
-  jesen_err_t err = jesen_array_get_object_value(array, index, key, &child);
-  if (err != JESEN_ERR_NONE) {
-    return err;
-  }
-  return jesen_value_get_int32(child, out);
-}
 
-jesen_err_t jesen_array_get_object_double(jesen_node_t *array, uint32_t index,
-                                          const char *key, double *out) {
-  if (!out) {
-    return JESEN_ERR_INVALID_ARGS;
+  if (!cJSON_IsString(node->cjson)) {
+    return JESEN_ERR_INVALID_VALUE_TYPE;
   }
-  jesen_node_t *child = NULL;
-  jesen_err_t err = jesen_array_get_object_value(array, index, key, &child);
-  if (err != JESEN_ERR_NONE) {
-    return err;
+
+  const char *str = node->cjson->valuestring ? node->cjson->valuestring : "";
+  *out = str;
+  if (out_len) {
+    *out_len = strlen(str);
   }
-  return jesen_value_get_double(child, out);
+  return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_array_get_object_bool(jesen_node_t *array, uint32_t index,
-                                        const char *key, bool *out) {
-  if (!out) {
+jesen_err_t jesen_value_get_int32(const jesen_node_t *node, int32_t *out) {
+  if (!node || !node->cjson || !out) {
     return JESEN_ERR_INVALID_ARGS;
   }
-  jesen_node_t *child = NULL;
-  jesen_err_t err = jesen_array_get_object_value(array, index, key, &child);
-  if (err != JESEN_ERR_NONE) {
-    return err;
+
+  if (!cJSON_IsNumber(node->cjson)) {
+    return JESEN_ERR_INVALID_VALUE_TYPE;
   }
-  return jesen_value_get_bool(child, out);
+
+  *out = (int32_t)node->cjson->valueint;
+  return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_array_get_object_string(jesen_node_t *array, uint32_t index,
-                                          const char *key, char *out,
-                                          size_t out_max, size_t *out_len) {
-  if (!out) {
+jesen_err_t jesen_value_get_double(const jesen_node_t *node, double *out) {
+  if (!node || !node->cjson || !out) {
     return JESEN_ERR_INVALID_ARGS;
   }
-  jesen_node_t *child = NULL;
-  jesen_err_t err = jesen_array_get_object_value(array, index, key, &child);
-  if (err != JESEN_ERR_NONE) {
-    return err;
+
+  if (!cJSON_IsNumber(node->cjson)) {
+    return JESEN_ERR_INVALID_VALUE_TYPE;
   }
-  return jesen_value_get_string(child, out, out_max, out_len);
+
+  *out = node->cjson->valuedouble;
+  return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_node_find(const jesen_node_t *node, const char *key,
-                            jesen_node_t **out) {
-  if (!node || !key || !out) {
+jesen_err_t jesen_value_get_bool(const jesen_node_t *node, bool *out) {
+  if (!node || !node->cjson || !out) {
     return JESEN_ERR_INVALID_ARGS;
   }
 
-  if (!cJSON_IsObject(node->cjson)) {
-    return JESEN_ERR_WRONG_TYPE;
-  }
-
-  for (jesen_node_t *child = node->child; child; child = child->sibling) {
-    const char *child_key = child->cjson ? child->cjson->string : NULL;
-    if (child_key && strcmp(child_key, key) == 0) {
-      *out = child;
-      return JESEN_ERR_NONE;
-    }
+  if (!cJSON_IsBool(node->cjson)) {
+    return JESEN_ERR_INVALID_VALUE_TYPE;
   }
 
-  return JESEN_ERR_NOT_FOUND;
-}
-
-jesen_err_t jesen_object_get_value(const jesen_node_t *node, const char *key,
-                                   jesen_node_t **out) {
-  return jesen_node_find(node, key, out);
+  *out = cJSON_IsTrue(node->cjson);
+  return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_object_get_int32(const jesen_node_t *object, const char *key,
-                                   int32_t *out) {
-  if (!object || !key || !out) {
+jesen_err_t jesen_value_is_null(const jesen_node_t *node, bool *out) {
+  if (!node || !node->cjson || !out) {
     return JESEN_ERR_INVALID_ARGS;
   }
-  jesen_node_t *child = NULL;
-  jesen_err_t err = jesen_node_find(object, key, &child);
-  if (err != JESEN_ERR_NONE) {
-    return err;
-  }
-  return jesen_value_get_int32(child, out);
+  *out = cJSON_IsNull(node->cjson);
+  return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_object_get_double(const jesen_node_t *object, const char *key,
-                                    double *out) {
-  if (!object || !key || !out) {
+jesen_err_t jesen_value_is_int32(const jesen_node_t *node, bool *out) {
+  if (!node || !node->cjson || !out) {
     return JESEN_ERR_INVALID_ARGS;
   }
-  jesen_node_t *child = NULL;
-  jesen_err_t err = jesen_node_find(object, key, &child);
-  if (err != JESEN_ERR_NONE) {
-    return err;
-  }
-  return jesen_value_get_double(child, out);
+  *out = cJSON_IsNumber(node->cjson);
+  return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_object_get_bool(const jesen_node_t *object, const char *key,
-                                  bool *out) {
-  if (!object || !key || !out) {
+jesen_err_t jesen_value_is_bool(const jesen_node_t *node, bool *out) {
+  if (!node || !node->cjson || !out) {
     return JESEN_ERR_INVALID_ARGS;
   }
-  jesen_node_t *child = NULL;
-  jesen_err_t err = jesen_node_find(object, key, &child);
-  if (err != JESEN_ERR_NONE) {
-    return err;
-  }
-  return jesen_value_get_bool(child, out);
+  *out = cJSON_IsBool(node->cjson);
+  return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_object_get_string(const jesen_node_t *object, const char *key,
-                                    char *out, size_t out_max,
-                                    size_t *out_len) {
-  if (!object || !key || !out) {
+jesen_err_t jesen_value_is_double(const jesen_node_t *node, bool *out) {
+  if (!node || !node->cjson || !out) {
     return JESEN_ERR_INVALID_ARGS;
   }
-  jesen_node_t *child = NULL;
-  jesen_err_t err = jesen_node_find(object, key, &child);
-  if (err != JESEN_ERR_NONE) {
-    return err;
-  }
-  return jesen_value_get_string(child, out, out_max, out_len);
+  *out = cJSON_IsNumber(node->cjson);
+  return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_object_get_array_value(const jesen_node_t *object,
-                                         const char *key, uint32_t index,
-                                         jesen_node_t **out) {
-  if (!object || !key || !out) {
+jesen_err_t jesen_value_is_string(const jesen_node_t *node, bool *out) {
+  if (!node || !node->cjson || !out) {
     return JESEN_ERR_INVALID_ARGS;
   }
-  jesen_node_t *child = NULL;
-  jesen_err_t err = jesen_node_find(object, key, &child);
-  if (err != JESEN_ERR_NONE) {
-    return err;
-  }
-  if (!cJSON_IsArray(child->cjson)) {
-    return JESEN_ERR_WRONG_TYPE;
-  }
-  return jesen_array_get_value(child, index, out);
+  *out = cJSON_IsString(node->cjson);
+  return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_object_get_array_int32(const jesen_node_t *object,
-                                         const char *key, uint32_t index,
-                                         int32_t *out) {
-  if (!out) {
+jesen_err_t jesen_value_is_array(const jesen_node_t *node, bool *out) {
+  if (!node || !node->cjson || !out) {
     return JESEN_ERR_INVALID_ARGS;
   }
-  jesen_node_t *node = NULL;
-  jesen_err_t err = jesen_object_get_array_value(object, key, index, &node);
-  if (err != JESEN_ERR_NONE) {
-    return err;
-  }
-  return jesen_value_get_int32(node, out);
+  *out = cJSON_IsArray(node->cjson);
+  return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_object_get_array_double(const jesen_node_t *object,
-                                          const char *key, uint32_t index,
-                                          double *out) {
-  if (!out) {
+jesen_err_t jesen_value_is_object(const jesen_node_t *node, bool *out) {
+  if (!node || !node->cjson || !out) {
     return JESEN_ERR_INVALID_ARGS;
   }
-  jesen_node_t *node = NULL;
-  jesen_err_t err = jesen_object_get_array_value(object, key, index, &node);
-  if (err != JESEN_ERR_NONE) {
-    return err;
-  }
-  return jesen_value_get_double(node, out);
+  *out = cJSON_IsObject(node->cjson);
+  return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_object_get_array_bool(const jesen_node_t *object,
-                                        const char *key, uint32_t index,
-                                        bool *out) {
-  if (!out) {
+jesen_err_t jesen_node_get_parent(const jesen_node_t *node,
+                                  jesen_node_t **out_parent) {
+  if (!node || !out_parent) {
     return JESEN_ERR_INVALID_ARGS;
   }
-  jesen_node_t *node = NULL;
-  jesen_err_t err = jesen_object_get_array_value(object, key, index, &node);
-  if (err != JESEN_ERR_NONE) {
-    return err;
-  }
-  return jesen_value_get_bool(node, out);
+
+  *out_parent = node->parent;
+  return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_object_get_array_string(const jesen_node_t *object,
-                                          const char *key, uint32_t index,
-                                          char *out, size_t out_max,
-                                          size_t *out_len) {
-  if (!out) {
+jesen_err_t jesen_node_detach(jesen_node_t *node) {
+  if (!node || !node->parent || !node->cjson) {
     return JESEN_ERR_INVALID_ARGS;
   }
-  jesen_node_t *node = NULL;
-  jesen_err_t err = jesen_object_get_array_value(object, key, index, &node);
-  if (err != JESEN_ERR_NONE) {
-    return err;
+
+  jesen_node_t *parent = node->parent;
+  if (cJSON_IsArray(parent->cjson)) {
+    jesen_elements_unlinked(parent, node);
+    cJSON_DetachItemViaPointer(parent->cjson, node->cjson);
+  } else if (cJSON_IsObject(parent->cjson)) {
+    if (!node->cjson->string) {
+      return JESEN_ERR_INVALID_ARGS;
+    }
+    jesen_index_removed(parent, node);
+    jesen_elements_unlinked(parent, node);
+    cJSON_DetachItemViaPointer(parent->cjson, node->cjson);
+  } else {
+    return JESEN_ERR_WRONG_TYPE;
   }
-  return jesen_value_get_string(node, out, out_max, out_len);
+
+  jesen_unlink_child(parent, node);
+
+  return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_value_get_string(const jesen_node_t *node, char *out,
-                                   size_t out_max, size_t *out_len) {
-  if (!node || !node->cjson || !out || out_max == 0) {
+jesen_err_t jesen_array_size(const jesen_node_t *array, size_t *out_size) {
+  if (!array || !array->cjson || !out_size) {
     return JESEN_ERR_INVALID_ARGS;
   }
 
-  if (!cJSON_IsString(node->cjson)) {
-    return JESEN_ERR_INVALID_VALUE_TYPE;
+  if (!cJSON_IsArray(array->cjson)) {
+    return JESEN_ERR_WRONG_TYPE;
   }
 
-  const char *str = node->cjson->valuestring ? node->cjson->valuestring : "";
-  size_t len = strlen(str);
-  if (len + 1 > out_max) {
-    return JESEN_ERR_INVALID_ARGS;
-  }
-  memcpy(out, str, len + 1);
-  if (out_len) {
-    *out_len = len;
+  int size = cJSON_GetArraySize(array->cjson);
+  if (size < 0) {
+    return JESEN_ERR_MUTATION_FAILED;
   }
+  *out_size = (size_t)size;
   return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_value_get_int32(const jesen_node_t *node, int32_t *out) {
-  if (!node || !node->cjson || !out) {
+jesen_err_t jesen_object_size(const jesen_node_t *object, size_t *out_size) {
+  if (!object || !object->cjson || !out_size) {
     return JESEN_ERR_INVALID_ARGS;
   }
 
-  if (!cJSON_IsNumber(node->cjson)) {
-    return JESEN_ERR_INVALID_VALUE_TYPE;
+  if (!cJSON_IsObject(object->cjson)) {
+    return JESEN_ERR_WRONG_TYPE;
   }
 
-  *out = (int32_t)node->cjson->valueint;
+  int size = cJSON_GetArraySize(object->cjson);
+  if (size < 0) {
+    return JESEN_ERR_MUTATION_FAILED;
+  }
+  *out_size = (size_t)size;
   return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_value_get_double(const jesen_node_t *node, double *out) {
+jesen_err_t jesen_iter_begin(jesen_node_t *node, jesen_iter_t *out) {
   if (!node || !node->cjson || !out) {
     return JESEN_ERR_INVALID_ARGS;
   }
 
-  if (!cJSON_IsNumber(node->cjson)) {
-    return JESEN_ERR_INVALID_VALUE_TYPE;
+  if (!cJSON_IsArray(node->cjson) && !cJSON_IsObject(node->cjson)) {
+    return JESEN_ERR_WRONG_TYPE;
   }
 
-  *out = node->cjson->valuedouble;
+  jesen_err_t err = jesen_materialize_children(node);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+
+  // The wrapper list runs backwards, so iterate over the element vector.
+  if (!jesen_node_elements(node)) {
+    return JESEN_ERR_ALLOC;
+  }
+
+  out->node = node;
+  out->next = NULL;
+  out->index = 0;
   return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_value_get_bool(const jesen_node_t *node, bool *out) {
-  if (!node || !node->cjson || !out) {
+jesen_err_t jesen_iter_next(jesen_iter_t *it, const char **key,
+                            size_t *key_len, jesen_node_t **child) {
+  if (!it || !it->node || !child) {
     return JESEN_ERR_INVALID_ARGS;
   }
 
-  if (!cJSON_IsBool(node->cjson)) {
-    return JESEN_ERR_INVALID_VALUE_TYPE;
+  jesen_elements_t *elements = jesen_node_elements(it->node);
+  if (!elements) {
+    return JESEN_ERR_ALLOC;
   }
+  if (it->index >= elements->count) {
+    return JESEN_ERR_NOT_FOUND;
+  }
+  jesen_node_t *cur = elements->items[it->index++];
 
-  *out = cJSON_IsTrue(node->cjson);
+  // Elements moved in from an object keep their cJSON name; it is not a key.
+  const char *name =
+      cJSON_IsObject(it->node->cjson) ? cur->cjson->string : NULL;
+  if (key) {
+    *key = name;
+  }
+  if (key_len) {
+    *key_len = name ? strlen(name) : 0;
+  }
+  *child = cur;
   return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_value_is_null(const jesen_node_t *node, bool *out) {
-  if (!node || !node->cjson || !out) {
-    return JESEN_ERR_INVALID_ARGS;
+// Write a scalar item, or just the opening bracket of a container.
+static bool jesen_cjson_write_open(jesen_writer_t *w, const cJSON *item) {
+  switch (item->type & 0xFF) {
+  case cJSON_NULL:
+    return jesen_writer_put(w, "null", 4);
+  case cJSON_False:
+    return jesen_writer_put(w, "false", 5);
+  case cJSON_True:
+    return jesen_writer_put(w, "true", 4);
+  case cJSON_Number:
+    return jesen_writer_number(w, item->valuedouble);
+  case cJSON_String: {
+    const char *str = item->valuestring ? item->valuestring : "";
+    return jesen_writer_string(w, str, strlen(str));
+  }
+  case cJSON_Raw:
+    return item->valuestring &&
+           jesen_writer_put(w, item->valuestring, strlen(item->valuestring));
+  case cJSON_Array:
+    return jesen_writer_put(w, "[", 1);
+  case cJSON_Object:
+    return jesen_writer_put(w, "{", 1);
+  default:
+    return false;
   }
-  *out = cJSON_IsNull(node->cjson);
-  return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_value_is_int32(const jesen_node_t *node, bool *out) {
-  if (!node || !node->cjson || !out) {
-    return JESEN_ERR_INVALID_ARGS;
+static bool jesen_cjson_is_container(const cJSON *item) {
+  return (item->type & 0xFF) == cJSON_Array ||
+         (item->type & 0xFF) == cJSON_Object;
+}
+
+static bool jesen_cjson_write_close(jesen_writer_t *w, const cJSON *item) {
+  return jesen_writer_put(w, (item->type & 0xFF) == cJSON_Object ? "}" : "]",
+                          1);
+}
+
+// Unformatted printing in cJSON's layout, but through the shared writer so
+// numbers come out in their shortest form exactly as the native backend
+// prints them. cJSON has no parent links, so the walk keeps the open
+// containers on a stack instead of recursing; it only goes to the heap for
+// documents nested deeper than the inline part.
+static jesen_err_t jesen_cjson_write(jesen_writer_t *w, const cJSON *root) {
+  const cJSON *inline_stack[64];
+  const cJSON **stack = inline_stack;
+  size_t cap = sizeof inline_stack / sizeof inline_stack[0];
+  size_t depth = 0;
+  jesen_err_t err = JESEN_ERR_BUFFER_TOO_SMALL;
+
+  const cJSON *item = root;
+  for (;;) {
+    if (depth > 0 && (stack[depth - 1]->type & 0xFF) == cJSON_Object) {
+      const char *key = item->string ? item->string : "";
+      if (!jesen_writer_string(w, key, strlen(key)) ||
+          !jesen_writer_put(w, ":", 1)) {
+        goto done;
+      }
+    }
+    if (!jesen_cjson_write_open(w, item)) {
+      goto done;
+    }
+    if (jesen_cjson_is_container(item)) {
+      if (item->child) {
+        if (depth == cap) {
+          const cJSON **grown =
+              (const cJSON **)malloc(2 * cap * sizeof *grown);
+          if (!grown) {
+            err = JESEN_ERR_ALLOC;
+            goto done;
+          }
+          memcpy(grown, stack, depth * sizeof *grown);
+          if (stack != inline_stack) {
+            free((void *)stack);
+          }
+          stack = grown;
+          cap *= 2;
+        }
+        stack[depth++] = item;
+        item = item->child;
+        continue;
+      }
+      if (!jesen_cjson_write_close(w, item)) {
+        goto done;
+      }
+    }
+
+    // Close every container this item was the last child of.
+    while (depth > 0 && !item->next) {
+      item = stack[--depth];
+      if (!jesen_cjson_write_close(w, item)) {
+        goto done;
+      }
+    }
+    if (depth == 0) {
+      err = JESEN_ERR_NONE;
+      goto done;
+    }
+    if (!jesen_writer_put(w, ",", 1)) {
+      goto done;
+    }
+    item = item->next;
   }
-  *out = cJSON_IsNumber(node->cjson);
-  return JESEN_ERR_NONE;
+
+done:
+  if (stack != inline_stack) {
+    free((void *)stack);
+  }
+  return err;
 }
 
-jesen_err_t jesen_value_is_bool(const jesen_node_t *node, bool *out) {
-  if (!node || !node->cjson || !out) {
+jesen_err_t jesen_serialize(const jesen_node_t *node, char *out_buf,
+                            size_t out_buf_len) {
+  if (!node || !node->cjson || !out_buf || out_buf_len == 0) {
     return JESEN_ERR_INVALID_ARGS;
   }
-  *out = cJSON_IsBool(node->cjson);
+
+  jesen_writer_t w = {out_buf, out_buf_len, 0};
+  jesen_err_t err = jesen_cjson_write(&w, node->cjson);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  out_buf[w.len] = '\0';
+
   return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_value_is_double(const jesen_node_t *node, bool *out) {
-  if (!node || !node->cjson || !out) {
+static jesen_err_t jesen_wrap(cJSON *json, jesen_node_t *parent,
+                              const jesen_allocator_t *allocator,
+                              jesen_node_t **out) {
+  if (!json || !out) {
     return JESEN_ERR_INVALID_ARGS;
   }
-  *out = cJSON_IsNumber(node->cjson);
+
+  jesen_node_t *node = (jesen_node_t *)jesen_alloc(allocator, sizeof *node);
+  if (!node) {
+    return JESEN_ERR_ALLOC;
+  }
+
+  memset(node, 0, sizeof *node);
+  node->allocator = allocator;
+  node->cjson = json;
+  node->parent = parent;
+  node->child = NULL;
+  node->sibling = NULL;
+  node->lazy = json->child != NULL;
+  *out = node;
+
   return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_value_is_string(const jesen_node_t *node, bool *out) {
-  if (!node || !node->cjson || !out) {
-    return JESEN_ERR_INVALID_ARGS;
+static jesen_err_t jesen_materialize_children(jesen_node_t *node) {
+  if (!node->lazy) {
+    return JESEN_ERR_NONE;
   }
-  *out = cJSON_IsString(node->cjson);
+
+  jesen_node_t *child_head = NULL;
+  for (cJSON *child = node->cjson->child; child; child = child->next) {
+    jesen_node_t *wrapped_child = NULL;
+    jesen_err_t err = jesen_wrap(child, node, node->allocator, &wrapped_child);
+    if (err != JESEN_ERR_NONE) {
+      jesen_free(child_head);
+      return err;
+    }
+
+    wrapped_child->sibling = child_head;
+    if (child_head) {
+      child_head->prior = wrapped_child;
+    }
+    child_head = wrapped_child;
+  }
+
+  node->child = child_head;
+  node->lazy = false;
+
   return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_value_is_array(const jesen_node_t *node, bool *out) {
-  if (!node || !node->cjson || !out) {
-    return JESEN_ERR_INVALID_ARGS;
+// Link `child` in as the last child of `parent`, at the head of the wrapper
+// list, keeping the key index and element vector in step.
+static void jesen_link_child(jesen_node_t *parent, jesen_node_t *child) {
+  child->parent = parent;
+  child->prior = NULL;
+  child->sibling = parent->child;
+  if (parent->child) {
+    parent->child->prior = child;
+  }
+  parent->child = child;
+  jesen_index_added(parent, child);
+  jesen_elements_added(parent, child);
+}
+
+// Take `child` out of the wrapper list of `parent` through its own links;
+// callers update the key index and element vector first.
+static void jesen_unlink_child(jesen_node_t *parent, jesen_node_t *child) {
+  if (child->prior) {
+    child->prior->sibling = child->sibling;
+  } else {
+    parent->child = child->sibling;
   }
-  *out = cJSON_IsArray(node->cjson);
-  return JESEN_ERR_NONE;
+  if (child->sibling) {
+    child->sibling->prior = child->prior;
+  }
+  child->parent = NULL;
+  child->sibling = NULL;
+  child->prior = NULL;
 }
 
-jesen_err_t jesen_value_is_object(const jesen_node_t *node, bool *out) {
-  if (!node || !node->cjson || !out) {
-    return JESEN_ERR_INVALID_ARGS;
+// The member of a materialized `object` named `key`; the wrapper list runs
+// from the last member to the first, so the last of duplicate keys wins. A
+// scan that covers JESEN_INDEX_MIN_MEMBERS members indexes the object for
+// the lookups after it.
+static jesen_node_t *jesen_object_lookup(jesen_node_t *object,
+                                         const char *key) {
+  if (object->index) {
+    return (jesen_node_t *)jesen_index_find(object->index, key);
   }
-  *out = cJSON_IsObject(node->cjson);
-  return JESEN_ERR_NONE;
+
+  size_t scanned = 0;
+  jesen_node_t *found = NULL;
+  for (jesen_node_t *child = object->child; child; child = child->sibling) {
+    scanned++;
+    const char *child_key = child->cjson ? child->cjson->string : NULL;
+    // Keys of an interned tree match an interned lookup key by address.
+    if (child_key == key || (child_key && strcmp(child_key, key) == 0)) {
+      found = child;
+      break;
+    }
+  }
+
+  if (scanned >= JESEN_INDEX_MIN_MEMBERS) {
+    // On failure the object stays unindexed and lookups keep scanning.
+    object->index = jesen_index_create(object->allocator, scanned);
+    for (jesen_node_t *child = object->child; child && object->index;
+         child = child->sibling) {
+      if (!jesen_index_put(object->index, child->cjson->string, child,
+                           false)) {
+        jesen_index_destroy(object->index);
+        object->index = NULL;
+      }
+    }
+  }
+  return found;
 }
 
-jesen_err_t jesen_node_get_parent(const jesen_node_t *node,
-                                  jesen_node_t **out_parent) {
-  if (!node || !out_parent) {
-    return JESEN_ERR_INVALID_ARGS;
+// Keep the key index of `object` in step with a member just linked in.
+static void jesen_index_added(jesen_node_t *object, jesen_node_t *member) {
+  if (object->index &&
+      !jesen_index_put(object->index, member->cjson->string, member, true)) {
+    jesen_index_destroy(object->index);
+    object->index = NULL;
   }
+}
 
-  *out_parent = node->parent;
-  return JESEN_ERR_NONE;
+// Keep the key index of `object` in step with a member about to be unlinked;
+// when the index cannot tell which duplicate takes over, the next lookup
+// rebuilds it.
+static void jesen_index_removed(jesen_node_t *object, jesen_node_t *member) {
+  if (object->index &&
+      !jesen_index_remove(object->index, member->cjson->string, member)) {
+    jesen_index_destroy(object->index);
+    object->index = NULL;
+  }
 }
 
-jesen_err_t jesen_node_detach(jesen_node_t *node) {
-  if (!node || !node->parent || !node->cjson) {
-    return JESEN_ERR_INVALID_ARGS;
+// The element vector of a materialized container, built on first use from
+// the wrapper list; NULL when out of memory.
+static jesen_elements_t *jesen_node_elements(jesen_node_t *node) {
+  if (node->elements) {
+    return node->elements;
   }
 
-  jesen_node_t *parent = node->parent;
-  jesen_node_t *prev = NULL;
-  jesen_node_t *wrapped = jesen_find_child_wrapper(parent, node->cjson, &prev);
-  if (!wrapped) {
-    return JESEN_ERR_NOT_FOUND;
+  size_t count = 0;
+  for (jesen_node_t *child = node->child; child; child = child->sibling) {
+    count++;
+  }
+  size_t cap = 16;
+  while (cap < count) {
+    cap *= 2;
   }
+  jesen_elements_t *elements = (jesen_elements_t *)jesen_alloc(
+      node->allocator, sizeof *elements + cap * sizeof *elements->items);
+  if (!elements) {
+    return NULL;
+  }
+  elements->count = count;
+  elements->cap = cap;
+  for (jesen_node_t *child = node->child; child; child = child->sibling) {
+    elements->items[--count] = child;
+  }
+  node->elements = elements;
+  return elements;
+}
 
-  if (cJSON_IsArray(parent->cjson)) {
-    int idx = 0;
-    for (cJSON *cur = parent->cjson->child; cur; cur = cur->next, ++idx) {
-      if (cur == node->cjson) {
-        cJSON_DetachItemFromArray(parent->cjson, idx);
-        break;
-      }
+// Keep the element vector of `node` in step with a child just appended. If
+// it cannot grow it is dropped, and the next indexed access rebuilds it.
+static void jesen_elements_added(jesen_node_t *node, jesen_node_t *element) {
+  jesen_elements_t *elements = node->elements;
+  if (!elements) {
+    return;
+  }
+  if (elements->count == elements->cap) {
+    size_t cap = elements->cap * 2;
+    jesen_elements_t *grown = (jesen_elements_t *)jesen_alloc(
+        node->allocator, sizeof *grown + cap * sizeof *grown->items);
+    if (grown) {
+      memcpy(grown, elements,
+             sizeof *elements + elements->count * sizeof *elements->items);
+      grown->cap = cap;
     }
-  } else if (cJSON_IsObject(parent->cjson)) {
-    const char *key = node->cjson->string;
-    if (!key) {
-      return JESEN_ERR_INVALID_ARGS;
+    jesen_release(node->allocator, elements);
+    node->elements = elements = grown;
+    if (!elements) {
+      return;
     }
-    cJSON_DetachItemFromObject(parent->cjson, key);
-  } else {
-    return JESEN_ERR_WRONG_TYPE;
   }
+  elements->items[elements->count++] = element;
+}
 
-  if (prev) {
-    prev->sibling = wrapped->sibling;
+// Keep the element vector of `node` in step with the child at `pos` being
+// unlinked.
+static void jesen_elements_removed(jesen_node_t *node, size_t pos) {
+  jesen_elements_t *elements = node->elements;
+  if (elements) {
+    memmove(&elements->items[pos], &elements->items[pos + 1],
+            (elements->count - pos - 1) * sizeof *elements->items);
+    elements->count--;
+  }
+}
+
+// As jesen_elements_removed, for a child whose position is not known. The
+// last child is popped; for any other the vector is dropped rather than
+// searched, and the next indexed access rebuilds it.
+static void jesen_elements_unlinked(jesen_node_t *node,
+                                    const jesen_node_t *element) {
+  jesen_elements_t *elements = node->elements;
+  if (!elements) {
+    return;
+  }
+  if (elements->count > 0 && elements->items[elements->count - 1] == element) {
+    elements->count--;
   } else {
-    parent->child = wrapped->sibling;
+    jesen_release(node->allocator, elements);
+    node->elements = NULL;
   }
+}
 
-  wrapped->parent = NULL;
-  wrapped->sibling = NULL;
+// Builder state while the parser replays a document straight into cJSON
+// items. cJSON has no parent links, so open containers are kept on a stack.
+// With `borrow` set, keys and strings point into the caller's buffer, and with
+// `intern` set keys point into that pool; either way they are flagged so
+// jesen_cjson_delete leaves them alone. The items themselves come
+// from cJSON's hooks; `allocator` only backs the builder's own memory.
+typedef struct {
+  cJSON *root;
+  cJSON **stack;
+  size_t depth;
+  size_t cap;
+  char *pending_key;
+  bool borrow;
+  jesen_intern_t *intern;
+  bool eager;
+  // items, keys and strings come from `allocator`, a document pool.
+  bool pool;
+  const jesen_allocator_t *allocator;
+  jesen_duplicate_policy_t duplicates;
+  jesen_dedupe_t dedupe;
+} jesen_cjson_builder_t;
+
+static char *jesen_cjson_strndup(jesen_cjson_builder_t *t, const char *str,
+                                 size_t len) {
+  char *copy = t->pool ? (char *)jesen_alloc(t->allocator, len + 1)
+                       : (char *)cJSON_malloc(len + 1);
+  if (!copy) {
+    return NULL;
+  }
+  memcpy(copy, str, len);
+  copy[len] = '\0';
+  return copy;
+}
 
-  return JESEN_ERR_NONE;
+static cJSON *jesen_cjson_item(jesen_cjson_builder_t *t, int type) {
+  cJSON *item = t->pool ? (cJSON *)jesen_alloc(t->allocator, sizeof *item)
+                        : (cJSON *)cJSON_malloc(sizeof *item);
+  if (item) {
+    memset(item, 0, sizeof *item);
+    item->type = t->pool ? type | JESEN_CJSON_POOL | cJSON_StringIsConst : type;
+  }
+  return item;
 }
 
-jesen_err_t jesen_array_size(const jesen_node_t *array, size_t *out_size) {
-  if (!array || !array->cjson || !out_size) {
-    return JESEN_ERR_INVALID_ARGS;
+static jesen_err_t jesen_cjson_add(jesen_cjson_builder_t *t, cJSON *item) {
+  if (!item) {
+    return JESEN_ERR_ALLOC;
+  }
+  if (t->depth == 0) {
+    t->root = item;
+    return JESEN_ERR_NONE;
   }
 
-  if (!cJSON_IsArray(array->cjson)) {
-    return JESEN_ERR_WRONG_TYPE;
+  // Append in O(1): cJSON keeps the tail in the first child's `prev`.
+  cJSON *parent = t->stack[t->depth - 1];
+  cJSON *head = parent->child;
+  if (!head) {
+    parent->child = item;
+    item->prev = item;
+  } else {
+    head->prev->next = item;
+    item->prev = head->prev;
+    head->prev = item;
   }
+  item->string = t->pending_key;
+  t->pending_key = NULL;
+  if (t->borrow || t->intern) {
+    item->type |= cJSON_StringIsConst;
+  }
+  return JESEN_ERR_NONE;
+}
 
-  int size = cJSON_GetArraySize(array->cjson);
-  if (size < 0) {
-    return JESEN_ERR_MUTATION_FAILED;
+static jesen_err_t jesen_cjson_begin(jesen_cjson_builder_t *t, cJSON *item) {
+  jesen_err_t err = jesen_cjson_add(t, item);
+  if (err != JESEN_ERR_NONE) {
+    return err;
   }
-  *out_size = (size_t)size;
+  if (t->depth == t->cap) {
+    size_t cap = t->cap ? t->cap * 2 : 16;
+    cJSON **grown = (cJSON **)jesen_alloc(t->allocator, cap * sizeof *grown);
+    if (!grown) {
+      return JESEN_ERR_ALLOC;
+    }
+    if (t->depth) {
+      memcpy(grown, t->stack, t->depth * sizeof *grown);
+    }
+    jesen_release(t->allocator, t->stack);
+    t->stack = grown;
+    t->cap = cap;
+  }
+  t->stack[t->depth++] = item;
   return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_object_size(const jesen_node_t *object, size_t *out_size) {
-  if (!object || !object->cjson || !out_size) {
-    return JESEN_ERR_INVALID_ARGS;
+static jesen_err_t jesen_cjson_begin_object(void *ctx) {
+  jesen_cjson_builder_t *t = (jesen_cjson_builder_t *)ctx;
+  return jesen_cjson_begin(t, jesen_cjson_item(t, cJSON_Object));
+}
+
+static jesen_err_t jesen_cjson_begin_array(void *ctx) {
+  jesen_cjson_builder_t *t = (jesen_cjson_builder_t *)ctx;
+  return jesen_cjson_begin(t, jesen_cjson_item(t, cJSON_Array));
+}
+
+static jesen_err_t jesen_cjson_end(void *ctx) {
+  ((jesen_cjson_builder_t *)ctx)->depth--;
+  return JESEN_ERR_NONE;
+}
+
+// Apply the duplicate-key policy to the object being closed.
+static jesen_err_t jesen_cjson_end_object(void *ctx) {
+  jesen_cjson_builder_t *t = (jesen_cjson_builder_t *)ctx;
+  cJSON *object = t->stack[t->depth - 1];
+  if (t->duplicates == JESEN_DUPLICATE_KEEP_ALL || !object->child ||
+      !object->child->next) {
+    return jesen_cjson_end(ctx);
   }
 
-  if (!cJSON_IsObject(object->cjson)) {
-    return JESEN_ERR_WRONG_TYPE;
+  size_t count = 0;
+  for (cJSON *cur = object->child; cur; cur = cur->next) {
+    count++;
+  }
+  jesen_err_t err = jesen_dedupe_reserve(&t->dedupe, count);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  count = 0;
+  for (cJSON *cur = object->child; cur; cur = cur->next) {
+    t->dedupe.keys[count++] = cur->string;
   }
+  if ((err = jesen_dedupe_run(&t->dedupe, count, t->duplicates)) !=
+      JESEN_ERR_NONE) {
+    return err;
+  }
+  size_t i = 0;
+  for (cJSON *cur = object->child, *next; cur; cur = next, ++i) {
+    next = cur->next;
+    if (t->dedupe.drop[i]) {
+      jesen_cjson_delete(cJSON_DetachItemViaPointer(object, cur));
+    }
+  }
+  return jesen_cjson_end(ctx);
+}
 
-  int size = cJSON_GetArraySize(object->cjson);
-  if (size < 0) {
-    return JESEN_ERR_MUTATION_FAILED;
+static jesen_err_t jesen_cjson_key(void *ctx, const char *key, size_t len) {
+  jesen_cjson_builder_t *t = (jesen_cjson_builder_t *)ctx;
+  if (t->intern) {
+    t->pending_key = (char *)jesen_intern_get(t->intern, key, len);
+    return t->pending_key ? JESEN_ERR_NONE : JESEN_ERR_ALLOC;
   }
-  *out_size = (size_t)size;
-  return JESEN_ERR_NONE;
+  if (t->borrow) {
+    t->pending_key = (char *)key;
+    return JESEN_ERR_NONE;
+  }
+  t->pending_key = jesen_cjson_strndup(t, key, len);
+  return t->pending_key ? JESEN_ERR_NONE : JESEN_ERR_ALLOC;
 }
 
-jesen_err_t jesen_serialize(const jesen_node_t *node, char *out_buf,
-                            size_t out_buf_len) {
-  if (!node || !node->cjson || !out_buf || out_buf_len == 0) {
-    return JESEN_ERR_INVALID_ARGS;
+static jesen_err_t jesen_cjson_string(void *ctx, const char *str, size_t len) {
+  jesen_cjson_builder_t *t = (jesen_cjson_builder_t *)ctx;
+  if (t->borrow) {
+    // cJSON_IsReference keeps jesen_cjson_delete from freeing valuestring.
+    cJSON *item = jesen_cjson_item(t, cJSON_String | cJSON_IsReference);
+    if (item) {
+      item->valuestring = (char *)str;
+    }
+    return jesen_cjson_add(t, item);
+  }
+  cJSON *item = jesen_cjson_item(t, cJSON_String);
+  if (!item) {
+    return JESEN_ERR_ALLOC;
+  }
+  item->valuestring = jesen_cjson_strndup(t, str, len);
+  if (!item->valuestring) {
+    jesen_cjson_delete(item);
+    return JESEN_ERR_ALLOC;
   }
+  return jesen_cjson_add(t, item);
+}
 
-  if (!cJSON_PrintPreallocated(node->cjson, out_buf, (int)out_buf_len, false)) {
-    return JESEN_ERR_BUFFER_TOO_SMALL;
+static jesen_err_t jesen_cjson_number(void *ctx, const char *raw, size_t len) {
+  jesen_cjson_builder_t *t = (jesen_cjson_builder_t *)ctx;
+  double value = 0.0;
+  jesen_err_t err = jesen_number_to_double(raw, len, &value);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  cJSON *item = jesen_cjson_item(t, cJSON_Number);
+  if (item) {
+    cJSON_SetNumberHelper(item, value);
   }
+  return jesen_cjson_add(t, item);
+}
 
-  return JESEN_ERR_NONE;
+static jesen_err_t jesen_cjson_boolean(void *ctx, bool value) {
+  jesen_cjson_builder_t *t = (jesen_cjson_builder_t *)ctx;
+  return jesen_cjson_add(t, jesen_cjson_item(t, value ? cJSON_True
+                                                       : cJSON_False));
 }
 
-static jesen_err_t jesen_build_wrapper_tree(cJSON *json, jesen_node_t *parent,
-                                            jesen_node_t **out) {
-  if (!json || !out) {
-    return JESEN_ERR_INVALID_ARGS;
-  }
+static jesen_err_t jesen_cjson_null(void *ctx) {
+  jesen_cjson_builder_t *t = (jesen_cjson_builder_t *)ctx;
+  return jesen_cjson_add(t, jesen_cjson_item(t, cJSON_NULL));
+}
 
-  jesen_node_t *node = (jesen_node_t *)calloc(1, sizeof *node);
-  if (!node) {
-    return JESEN_ERR_ALLOC;
+// Add a value below `parent`, a container carved from a document pool. The
+// item, its key and its string come from the same pool, through the builder
+// primitives that carve parsed documents. `key` is NULL for array elements.
+static jesen_err_t jesen_pool_add(jesen_node_t *parent, const char *key,
+                                  int type, double number, const char *str,
+                                  size_t str_len, jesen_node_t **out) {
+  if (key ? !cJSON_IsObject(parent->cjson) : !cJSON_IsArray(parent->cjson)) {
+    return JESEN_ERR_WRONG_TYPE;
   }
 
-  node->cjson = json;
-  node->parent = parent;
-  node->child = NULL;
-  node->sibling = NULL;
+  // A one-level builder whose open container is `parent`.
+  cJSON *stack = parent->cjson;
+  jesen_cjson_builder_t t;
+  memset(&t, 0, sizeof t);
+  t.stack = &stack;
+  t.depth = 1;
+  t.cap = 1;
+  t.pool = true;
+  t.allocator = parent->allocator;
 
-  jesen_node_t *child_head = NULL;
-  for (cJSON *child = json->child; child; child = child->next) {
-    jesen_node_t *wrapped_child = NULL;
-    jesen_err_t err = jesen_build_wrapper_tree(child, node, &wrapped_child);
-    if (err != JESEN_ERR_NONE) {
-      node->child = child_head;
-      jesen_free(node);
-      return err;
+  jesen_err_t err = JESEN_ERR_NONE;
+  if (key && (err = jesen_cjson_key(&t, key, strlen(key))) != JESEN_ERR_NONE) {
+    return err;
+  }
+  if (type == cJSON_String) {
+    err = jesen_cjson_string(&t, str, str_len);
+  } else {
+    cJSON *item = jesen_cjson_item(&t, type);
+    if (item && type == cJSON_Number) {
+      cJSON_SetNumberHelper(item, number);
     }
-
-    wrapped_child->sibling = child_head;
-    child_head = wrapped_child;
+    err = jesen_cjson_add(&t, item);
+  }
+  if (err != JESEN_ERR_NONE) {
+    return err;
   }
 
-  node->child = child_head;
-  *out = node;
+  cJSON *item = parent->cjson->child->prev;
+  jesen_node_t *created = NULL;
+  err = jesen_wrap(item, parent, parent->allocator, &created);
+  if (err != JESEN_ERR_NONE) {
+    jesen_cjson_delete(cJSON_DetachItemViaPointer(parent->cjson, item));
+    return err;
+  }
+  jesen_link_child(parent, created);
 
+  if (out) {
+    *out = created;
+  }
   return JESEN_ERR_NONE;
 }
 
-static jesen_node_t *jesen_find_child_wrapper(jesen_node_t *parent,
-                                              cJSON *child_cjson,
-                                              jesen_node_t **out_prev) {
-  jesen_node_t *prev = NULL;
-  for (jesen_node_t *cur = parent ? parent->child : NULL; cur;
-       prev = cur, cur = cur->sibling) {
-    if (cur->cjson == child_cjson) {
-      if (out_prev) {
-        *out_prev = prev;
-      }
-      return cur;
-    }
-  }
-  if (out_prev) {
-    *out_prev = NULL;
+const jesen_builder_t jesen_backend_builder = {
+    jesen_cjson_begin_object, jesen_cjson_end_object, jesen_cjson_begin_array,
+    jesen_cjson_end,          jesen_cjson_key,        jesen_cjson_string,
+    jesen_cjson_number,       jesen_cjson_boolean,    jesen_cjson_null,
+};
+
+jesen_err_t jesen_backend_builder_create(bool borrow,
+                                         const jesen_parse_opts_t *opts,
+                                         void **out_ctx) {
+  const jesen_allocator_t *allocator = opts ? opts->allocator : NULL;
+  jesen_cjson_builder_t *t =
+      (jesen_cjson_builder_t *)jesen_alloc(allocator, sizeof *t);
+  if (!t) {
+    return JESEN_ERR_ALLOC;
   }
-  return NULL;
+  memset(t, 0, sizeof *t);
+  t->borrow = borrow;
+  t->intern = opts ? opts->intern : NULL;
+  t->eager = opts && (opts->flags & JESEN_PARSE_EAGER_WRAPPERS) != 0;
+  t->pool = jesen_allocator_is_pool(allocator);
+  t->allocator = allocator;
+  t->duplicates = opts ? opts->duplicates : JESEN_DUPLICATE_KEEP_ALL;
+  t->dedupe.allocator = allocator;
+  *out_ctx = t;
+  return JESEN_ERR_NONE;
 }
 
-jesen_err_t jesen_parse(const char *buf, size_t buf_len, jesen_node_t **out) {
-  if (!buf || !out) {
-    return JESEN_ERR_INVALID_ARGS;
+// Wrap every item below `root` up front, walking the wrappers through their
+// parent links instead of recursing.
+static jesen_err_t jesen_materialize_all(jesen_node_t *root) {
+  jesen_node_t *node = root;
+  for (;;) {
+    jesen_err_t err = jesen_materialize_children(node);
+    if (err != JESEN_ERR_NONE) {
+      return err;
+    }
+    if (node->child) {
+      node = node->child;
+      continue;
+    }
+    while (node != root && !node->sibling) {
+      node = node->parent;
+    }
+    if (node == root) {
+      return JESEN_ERR_NONE;
+    }
+    node = node->sibling;
   }
+}
 
-  cJSON *json = cJSON_ParseWithLength(buf, buf_len);
-  if (!json) {
-    return JESEN_ERR_PARSE;
+jesen_err_t jesen_backend_builder_finish(void *ctx, jesen_err_t err,
+                                         jesen_node_t **out) {
+  jesen_cjson_builder_t *t = (jesen_cjson_builder_t *)ctx;
+  cJSON *tree = t->root;
+  bool eager = t->eager;
+  const jesen_allocator_t *allocator = t->allocator;
+  jesen_release(allocator, t->stack);
+  if (!t->borrow && !t->pool && !t->intern) {
+    cJSON_free(t->pending_key);
+  }
+  jesen_dedupe_free(&t->dedupe);
+  jesen_release(allocator, t);
+  if (err != JESEN_ERR_NONE) {
+    jesen_cjson_delete(tree);
+    return err;
   }
 
   jesen_node_t *root = NULL;
-  jesen_err_t err = jesen_build_wrapper_tree(json, NULL, &root);
+  err = jesen_wrap(tree, NULL, allocator, &root);
   if (err != JESEN_ERR_NONE) {
-    cJSON_Delete(json);
+    jesen_cjson_delete(tree);
+    return err;
+  }
+  if (eager && (err = jesen_materialize_all(root)) != JESEN_ERR_NONE) {
+    jesen_destroy(root);
     return err;
   }
 
@@ -1174,17 +1738,85 @@ jesen_err_t jesen_parse(const char *buf, size_t buf_len, jesen_node_t **out) {
   return JESEN_ERR_NONE;
 }
 
+// Free `node`, the siblings after it and everything below them. Each node's
+// children are spliced into the chain right after it before it is freed, so
+// the walk needs neither recursion nor extra memory.
 static jesen_err_t jesen_free(jesen_node_t *node) {
-  if (!node) {
-    return JESEN_ERR_NONE;
+  while (node) {
+    jesen_node_t *child = node->child;
+    if (child) {
+      jesen_node_t *last = child;
+      while (last->sibling) {
+        last = last->sibling;
+      }
+      last->sibling = node->sibling;
+      node->sibling = child;
+    }
+
+    jesen_node_t *next = node->sibling;
+    jesen_index_destroy(node->index);
+    jesen_release(node->allocator, node->elements);
+    while (node->backing) {
+      jesen_backing_t *backing = node->backing;
+      node->backing = backing->next;
+      backing->release(backing);
+    }
+    jesen_release(node->allocator, node);
+    node = next;
   }
 
-  jesen_free(node->child);
-  jesen_free(node->sibling);
+  return JESEN_ERR_NONE;
+}
 
-  free(node);
+// cJSON_Delete without the recursion into children: an owned child list is
+// spliced in after its parent (cJSON keeps the tail in the head's `prev`).
+static void jesen_cjson_delete(cJSON *item) {
+  while (item) {
+    if (!(item->type & cJSON_IsReference) && item->child) {
+      cJSON *child = item->child;
+      child->prev->next = item->next;
+      item->next = child;
+      item->child = NULL;
+    }
 
-  return JESEN_ERR_NONE;
+    cJSON *next = item->next;
+    bool pooled = (item->type & JESEN_CJSON_POOL) != 0;
+    if (!(item->type & cJSON_IsReference) && !pooled && item->valuestring) {
+      cJSON_free(item->valuestring);
+    }
+    if (!(item->type & cJSON_StringIsConst) && item->string) {
+      cJSON_free(item->string);
+    }
+    if (!pooled) {
+      cJSON_free(item);
+    }
+    item = next;
+  }
+}
+
+void jesen_backend_set_backing(jesen_node_t *root, jesen_backing_t *backing) {
+  backing->next = root->backing;
+  root->backing = backing;
+}
+
+void jesen_backend_array_splice(jesen_node_t *dst, jesen_node_t *src) {
+  // Both roots are fresh from the builder, so neither has child wrappers yet.
+  cJSON *head = dst->cjson->child;
+  cJSON *moved = src->cjson->child;
+  if (moved) {
+    if (!head) {
+      dst->cjson->child = moved;
+    } else {
+      cJSON *tail = head->prev;
+      head->prev = moved->prev;
+      tail->next = moved;
+      moved->prev = tail;
+    }
+    src->cjson->child = NULL;
+  }
+  dst->lazy = dst->cjson->child != NULL;
+  jesen_cjson_delete(src->cjson);
+  jesen_release(src->allocator, src);
 }
 
 jesen_err_t jesen_destroy(jesen_node_t *node) {
@@ -1192,6 +1824,6 @@ jesen_err_t jesen_destroy(jesen_node_t *node) {
     return JESEN_ERR_INVALID_ARGS;
   }
 
-  cJSON_Delete(node->cjson);
+  jesen_cjson_delete(node->cjson);
   return jesen_free(node);
 }
@@ -0,0 +1,358 @@
+#include "jesen.h"
+
+// Convenience getters composed from the primitives every backend provides.
+
+jesen_err_t jesen_array_get_int32(jesen_node_t *array, uint32_t index,
+                                  int32_t *out) {
+  if (!out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_node_t *node = NULL;
+  jesen_err_t err = jesen_array_get_value(array, index, &node);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_value_get_int32(node, out);
+}
+
+jesen_err_t jesen_array_get_double(jesen_node_t *array, uint32_t index,
+                                   double *out) {
+  if (!out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_node_t *node = NULL;
+  jesen_err_t err = jesen_array_get_value(array, index, &node);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_value_get_double(node, out);
+}
+
+jesen_err_t jesen_array_get_bool(jesen_node_t *array, uint32_t index,
+                                 bool *out) {
+  if (!out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_node_t *node = NULL;
+  jesen_err_t err = jesen_array_get_value(array, index, &node);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_value_get_bool(node, out);
+}
+
+jesen_err_t jesen_array_get_string(jesen_node_t *array, uint32_t index,
+                                   char *out, size_t out_max, size_t *out_len) {
+  if (!out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_node_t *node = NULL;
+  jesen_err_t err = jesen_array_get_value(array, index, &node);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_value_get_string(node, out, out_max, out_len);
+}
+
+jesen_err_t jesen_array_get_object_value(jesen_node_t *array, uint32_t index,
+                                         const char *key, jesen_node_t **out) {
+  if (!array || !key || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_node_t *elem = NULL;
+  jesen_err_t err = jesen_array_get_value(array, index, &elem);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  bool is_object = false;
+  err = jesen_value_is_object(elem, &is_object);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  if (!is_object) {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+  return jesen_node_find(elem, key, out);
+}
+
+jesen_err_t jesen_array_get_object_int32(jesen_node_t *array, uint32_t index,
+                                         const char *key, int32_t *out) {
+  if (!out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_node_t *child = NULL;
+  jesen_err_t err = jesen_array_get_object_value(array, index, key, &child);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_value_get_int32(child, out);
+}
+
+jesen_err_t jesen_array_get_object_double(jesen_node_t *array, uint32_t index,
+                                          const char *key, double *out) {
+  if (!out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_node_t *child = NULL;
+  jesen_err_t err = jesen_array_get_object_value(array, index, key, &child);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_value_get_double(child, out);
+}
+
+jesen_err_t jesen_array_get_object_bool(jesen_node_t *array, uint32_t index,
+                                        const char *key, bool *out) {
+  if (!out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_node_t *child = NULL;
+  jesen_err_t err = jesen_array_get_object_value(array, index, key, &child);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_value_get_bool(child, out);
+}
+
+jesen_err_t jesen_array_get_object_string(jesen_node_t *array, uint32_t index,
+                                          const char *key, char *out,
+                                          size_t out_max, size_t *out_len) {
+  if (!out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_node_t *child = NULL;
+  jesen_err_t err = jesen_array_get_object_value(array, index, key, &child);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_value_get_string(child, out, out_max, out_len);
+}
+
+jesen_err_t jesen_object_get_value(const jesen_node_t *node, const char *key,
+                                   jesen_node_t **out) {
+  return jesen_node_find(node, key, out);
+}
+
+jesen_err_t jesen_object_get_int32(const jesen_node_t *object, const char *key,
+                                   int32_t *out) {
+  if (!object || !key || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_node_t *child = NULL;
+  jesen_err_t err = jesen_node_find(object, key, &child);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_value_get_int32(child, out);
+}
+
+jesen_err_t jesen_object_get_double(const jesen_node_t *object, const char *key,
+                                    double *out) {
+  if (!object || !key || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_node_t *child = NULL;
+  jesen_err_t err = jesen_node_find(object, key, &child);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_value_get_double(child, out);
+}
+
+jesen_err_t jesen_object_get_bool(const jesen_node_t *object, const char *key,
+                                  bool *out) {
+  if (!object || !key || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_node_t *child = NULL;
+  jesen_err_t err = jesen_node_find(object, key, &child);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_value_get_bool(child, out);
+}
+
+jesen_err_t jesen_object_get_string(const jesen_node_t *object, const char *key,
+                                    char *out, size_t out_max,
+                                    size_t *out_len) {
+  if (!object || !key || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_node_t *child = NULL;
+  jesen_err_t err = jesen_node_find(object, key, &child);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_value_get_string(child, out, out_max, out_len);
+}
+
+jesen_err_t jesen_object_get_array_value(const jesen_node_t *object,
+                                         const char *key, uint32_t index,
+                                         jesen_node_t **out) {
+  if (!object || !key || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_node_t *child = NULL;
+  jesen_err_t err = jesen_node_find(object, key, &child);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  bool is_array = false;
+  err = jesen_value_is_array(child, &is_array);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  if (!is_array) {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+  return jesen_array_get_value(child, index, out);
+}
+
+jesen_err_t jesen_object_get_array_int32(const jesen_node_t *object,
+                                         const char *key, uint32_t index,
+                                         int32_t *out) {
+  if (!out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_node_t *node = NULL;
+  jesen_err_t err = jesen_object_get_array_value(object, key, index, &node);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_value_get_int32(node, out);
+}
+
+jesen_err_t jesen_object_get_array_double(const jesen_node_t *object,
+                                          const char *key, uint32_t index,
+                                          double *out) {
+  if (!out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_node_t *node = NULL;
+  jesen_err_t err = jesen_object_get_array_value(object, key, index, &node);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_value_get_double(node, out);
+}
+
+jesen_err_t jesen_object_get_array_bool(const jesen_node_t *object,
+                                        const char *key, uint32_t index,
+                                        bool *out) {
+  if (!out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_node_t *node = NULL;
+  jesen_err_t err = jesen_object_get_array_value(object, key, index, &node);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_value_get_bool(node, out);
+}
+
+jesen_err_t jesen_object_get_array_string(const jesen_node_t *object,
+                                          const char *key, uint32_t index,
+                                          char *out, size_t out_max,
+                                          size_t *out_len) {
+  if (!out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_node_t *node = NULL;
+  jesen_err_t err = jesen_object_get_array_value(object, key, index, &node);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_value_get_string(node, out, out_max, out_len);
+}
+
+// Typed iteration reads the next child through a copy of the iterator and
+// only commits the step, and hands out the key, when the child has the
+// requested type.
+
+jesen_err_t jesen_iter_next_int32(jesen_iter_t *it, const char **key,
+                                  int32_t *out) {
+  if (!it || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_iter_t peek = *it;
+  const char *name = NULL;
+  jesen_node_t *node = NULL;
+  jesen_err_t err = jesen_iter_next(&peek, &name, NULL, &node);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  err = jesen_value_get_int32(node, out);
+  if (err == JESEN_ERR_NONE) {
+    *it = peek;
+    if (key) {
+      *key = name;
+    }
+  }
+  return err;
+}
+
+jesen_err_t jesen_iter_next_double(jesen_iter_t *it, const char **key,
+                                   double *out) {
+  if (!it || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_iter_t peek = *it;
+  const char *name = NULL;
+  jesen_node_t *node = NULL;
+  jesen_err_t err = jesen_iter_next(&peek, &name, NULL, &node);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  err = jesen_value_get_double(node, out);
+  if (err == JESEN_ERR_NONE) {
+    *it = peek;
+    if (key) {
+      *key = name;
+    }
+  }
+  return err;
+}
+
+jesen_err_t jesen_iter_next_bool(jesen_iter_t *it, const char **key,
+                                 bool *out) {
+  if (!it || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_iter_t peek = *it;
+  const char *name = NULL;
+  jesen_node_t *node = NULL;
+  jesen_err_t err = jesen_iter_next(&peek, &name, NULL, &node);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  err = jesen_value_get_bool(node, out);
+  if (err == JESEN_ERR_NONE) {
+    *it = peek;
+    if (key) {
+      *key = name;
+    }
+  }
+  return err;
+}
+
+jesen_err_t jesen_iter_next_string(jesen_iter_t *it, const char **key,
+                                   const char **out, size_t *out_len) {
+  if (!it || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_iter_t peek = *it;
+  const char *name = NULL;
+  jesen_node_t *node = NULL;
+  jesen_err_t err = jesen_iter_next(&peek, &name, NULL, &node);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  err = jesen_value_get_string_ref(node, out, out_len);
+  if (err == JESEN_ERR_NONE) {
+    *it = peek;
+    if (key) {
+      *key = name;
+    }
+  }
+  return err;
+}
@@ -0,0 +1,648 @@
+#include "jesen_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// On-demand access. A cursor is just an offset into the caller's buffer; every
+// operation runs the stage-1 scanner forward from there and stops as soon as
+// it has what it needs. Values that are stepped over are only checked for
+// balanced brackets, and nothing is decoded until a getter asks for it.
+
+typedef struct {
+  jesen_scanner_t scanner;
+  const char *buf;
+  // offset of the scanner's first byte within `buf`.
+  size_t start;
+} jesen_walk_t;
+
+static void jesen_walk_init(jesen_walk_t *w, const jesen_cursor_t *cursor,
+                            size_t from) {
+  jesen_scanner_init(&w->scanner, cursor->buf + from, cursor->len - from);
+  w->buf = cursor->buf;
+  w->start = from;
+}
+
+static bool jesen_walk_next(jesen_walk_t *w, size_t *at) {
+  if (!jesen_scanner_next(&w->scanner, at)) {
+    return false;
+  }
+  *at += w->start;
+  return true;
+}
+
+// Step over the value whose first structural `*at` was just read, leaving
+// `*at` on its last one (the closing quote or bracket).
+static jesen_err_t jesen_walk_skip(jesen_walk_t *w, size_t *at) {
+  switch (w->buf[*at]) {
+  case '\"':
+    return jesen_walk_next(w, at) ? JESEN_ERR_NONE : JESEN_ERR_PARSE;
+  case '{':
+  case '[': {
+    size_t depth = 1;
+    while (depth > 0) {
+      if (!jesen_walk_next(w, at)) {
+        return JESEN_ERR_PARSE;
+      }
+      char c = w->buf[*at];
+      if (c == '{' || c == '[') {
+        depth++;
+      } else if (c == '}' || c == ']') {
+        depth--;
+      }
+    }
+    return JESEN_ERR_NONE;
+  }
+  case '}':
+  case ']':
+  case ',':
+  case ':':
+    return JESEN_ERR_PARSE;
+  default:
+    return JESEN_ERR_NONE;
+  }
+}
+
+static bool jesen_cursor_is_ws(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// True when `c` may follow a number or literal.
+static bool jesen_cursor_is_delimiter(char c) {
+  return jesen_cursor_is_ws(c) || c == ',' || c == ']' || c == '}';
+}
+
+static void jesen_cursor_at(const jesen_cursor_t *parent, size_t offset,
+                            jesen_cursor_t *out) {
+  out->buf = parent->buf;
+  out->len = parent->len;
+  out->offset = offset;
+}
+
+static bool jesen_cursor_valid(const jesen_cursor_t *cursor) {
+  return cursor && cursor->buf && cursor->offset < cursor->len;
+}
+
+// Compare the raw key literal body [begin, end) with `key`.
+static jesen_err_t jesen_key_equals(const char *begin, const char *end,
+                                    const char *key, size_t key_len,
+                                    bool *out) {
+  size_t raw_len = (size_t)(end - begin);
+  if (!memchr(begin, '\\', raw_len)) {
+    *out = raw_len == key_len && memcmp(begin, key, key_len) == 0;
+    return JESEN_ERR_NONE;
+  }
+  // Escapes only ever shrink the text.
+  if (raw_len < key_len) {
+    *out = false;
+    return JESEN_ERR_NONE;
+  }
+  char *decoded = (char *)malloc(raw_len);
+  if (!decoded) {
+    return JESEN_ERR_ALLOC;
+  }
+  size_t len = 0;
+  if (!jesen_unescape(begin, end, decoded, &len)) {
+    free(decoded);
+    return JESEN_ERR_PARSE;
+  }
+  *out = len == key_len && memcmp(decoded, key, key_len) == 0;
+  free(decoded);
+  return JESEN_ERR_NONE;
+}
+
+// Look for `key` among the members of `object`, stopping at the first one
+// that has it, or with `last` set, going on to the end of the object so the
+// last one wins as in a parsed tree.
+static jesen_err_t jesen_cursor_scan_members(const jesen_cursor_t *object,
+                                             const char *key, size_t key_len,
+                                             bool last, jesen_cursor_t *out) {
+  jesen_walk_t w;
+  size_t at;
+  jesen_err_t err;
+  bool found = false;
+  jesen_walk_init(&w, object, object->offset);
+  if (!jesen_walk_next(&w, &at) || !jesen_walk_next(&w, &at)) {
+    return JESEN_ERR_PARSE;
+  }
+  if (object->buf[at] == '}') {
+    return JESEN_ERR_NOT_FOUND;
+  }
+
+  for (;;) {
+    size_t key_start = at;
+    size_t key_end;
+    size_t value;
+    if (object->buf[key_start] != '\"' || !jesen_walk_next(&w, &key_end) ||
+        !jesen_walk_next(&w, &at) || object->buf[at] != ':' ||
+        !jesen_walk_next(&w, &value)) {
+      return JESEN_ERR_PARSE;
+    }
+    bool match = false;
+    err = jesen_key_equals(object->buf + key_start + 1, object->buf + key_end,
+                           key, key_len, &match);
+    if (err != JESEN_ERR_NONE) {
+      return err;
+    }
+    if (match) {
+      jesen_cursor_at(object, value, out);
+      found = true;
+      if (!last) {
+        return JESEN_ERR_NONE;
+      }
+    }
+    if ((err = jesen_walk_skip(&w, &value)) != JESEN_ERR_NONE) {
+      return err;
+    }
+    if (!jesen_walk_next(&w, &at)) {
+      return JESEN_ERR_PARSE;
+    }
+    if (object->buf[at] == '}') {
+      return found ? JESEN_ERR_NONE : JESEN_ERR_NOT_FOUND;
+    }
+    if (object->buf[at] != ',' || !jesen_walk_next(&w, &at)) {
+      return JESEN_ERR_PARSE;
+    }
+  }
+}
+
+// Locate the raw number token at the cursor.
+static jesen_err_t jesen_cursor_number(const jesen_cursor_t *cursor,
+                                       const char **out_raw,
+                                       size_t *out_len) {
+  const char *raw = cursor->buf + cursor->offset;
+  size_t avail = cursor->len - cursor->offset;
+  if (*raw != '-' && (*raw < '0' || *raw > '9')) {
+    return JESEN_ERR_INVALID_VALUE_TYPE;
+  }
+  size_t len = jesen_scan_number(raw, avail);
+  if (len == 0 || (len < avail && !jesen_cursor_is_delimiter(raw[len]))) {
+    return JESEN_ERR_PARSE;
+  }
+  *out_raw = raw;
+  *out_len = len;
+  return JESEN_ERR_NONE;
+}
+
+// Match a literal at the cursor; false when the value is something else.
+static bool jesen_cursor_literal(const jesen_cursor_t *cursor,
+                                 const char *literal) {
+  size_t len = strlen(literal);
+  const char *at = cursor->buf + cursor->offset;
+  size_t avail = cursor->len - cursor->offset;
+  return avail >= len && memcmp(at, literal, len) == 0 &&
+         (avail == len || jesen_cursor_is_delimiter(at[len]));
+}
+
+// Find the closing quote of the string at the cursor.
+static jesen_err_t jesen_cursor_string(const jesen_cursor_t *cursor,
+                                       const char **out_begin,
+                                       const char **out_end) {
+  if (cursor->buf[cursor->offset] != '\"') {
+    return JESEN_ERR_INVALID_VALUE_TYPE;
+  }
+  jesen_walk_t w;
+  size_t at;
+  jesen_walk_init(&w, cursor, cursor->offset);
+  if (!jesen_walk_next(&w, &at) || !jesen_walk_next(&w, &at)) {
+    return JESEN_ERR_PARSE;
+  }
+  const char *begin = cursor->buf + cursor->offset + 1;
+  const char *end = cursor->buf + at;
+  for (const char *p = begin; p < end; ++p) {
+    if ((unsigned char)*p < 0x20) {
+      return JESEN_ERR_PARSE;
+    }
+  }
+  *out_begin = begin;
+  *out_end = end;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_cursor_init(const char *buf, size_t buf_len,
+                              jesen_cursor_t *out) {
+  if (!buf || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  size_t offset = 0;
+  if (buf_len >= 3 && memcmp(buf, "\xEF\xBB\xBF", 3) == 0) {
+    offset = 3;
+  }
+  while (offset < buf_len && jesen_cursor_is_ws(buf[offset])) {
+    offset++;
+  }
+  if (offset == buf_len) {
+    return JESEN_ERR_PARSE;
+  }
+  out->buf = buf;
+  out->len = buf_len;
+  out->offset = offset;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_cursor_find_field(const jesen_cursor_t *object,
+                                    const char *key, jesen_cursor_t *out) {
+  if (!jesen_cursor_valid(object) || !key || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  if (object->buf[object->offset] != '{') {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+  return jesen_cursor_scan_members(object, key, strlen(key), false, out);
+}
+
+jesen_err_t jesen_cursor_at_index(const jesen_cursor_t *array, size_t index,
+                                  jesen_cursor_t *out) {
+  if (!jesen_cursor_valid(array) || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  if (array->buf[array->offset] != '[') {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+  jesen_walk_t w;
+  size_t at;
+  jesen_walk_init(&w, array, array->offset);
+  if (!jesen_walk_next(&w, &at) || !jesen_walk_next(&w, &at)) {
+    return JESEN_ERR_PARSE;
+  }
+  if (array->buf[at] == ']') {
+    return JESEN_ERR_OUT_OF_RANGE;
+  }
+  for (size_t i = 0; i < index; ++i) {
+    jesen_err_t err = jesen_walk_skip(&w, &at);
+    if (err != JESEN_ERR_NONE) {
+      return err;
+    }
+    if (!jesen_walk_next(&w, &at)) {
+      return JESEN_ERR_PARSE;
+    }
+    if (array->buf[at] == ']') {
+      return JESEN_ERR_OUT_OF_RANGE;
+    }
+    if (array->buf[at] != ',' || !jesen_walk_next(&w, &at)) {
+      return JESEN_ERR_PARSE;
+    }
+  }
+  jesen_cursor_at(array, at, out);
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_cursor_next(jesen_cursor_t *element) {
+  if (!jesen_cursor_valid(element)) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_walk_t w;
+  size_t at;
+  jesen_walk_init(&w, element, element->offset);
+  if (!jesen_walk_next(&w, &at)) {
+    return JESEN_ERR_PARSE;
+  }
+  jesen_err_t err = jesen_walk_skip(&w, &at);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  if (!jesen_walk_next(&w, &at)) {
+    return JESEN_ERR_PARSE;
+  }
+  if (element->buf[at] == ']') {
+    return JESEN_ERR_NOT_FOUND;
+  }
+  if (element->buf[at] == '}') {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+  size_t value;
+  if (element->buf[at] != ',' || !jesen_walk_next(&w, &value)) {
+    return JESEN_ERR_PARSE;
+  }
+  // A string followed by ':' is the next key of an object, not an element.
+  if (element->buf[value] == '\"') {
+    if (!jesen_walk_next(&w, &at)) {
+      return JESEN_ERR_PARSE;
+    }
+    if (jesen_walk_next(&w, &at) && element->buf[at] == ':') {
+      return JESEN_ERR_WRONG_TYPE;
+    }
+  }
+  element->offset = value;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_cursor_get_raw(const jesen_cursor_t *cursor,
+                                 const char **out, size_t *out_len) {
+  if (!jesen_cursor_valid(cursor) || !out || !out_len) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  const char *begin = cursor->buf + cursor->offset;
+  size_t len = 0;
+  jesen_err_t err = JESEN_ERR_NONE;
+  switch (*begin) {
+  case '\"':
+  case '{':
+  case '[': {
+    jesen_walk_t w;
+    size_t at;
+    jesen_walk_init(&w, cursor, cursor->offset);
+    if (!jesen_walk_next(&w, &at)) {
+      return JESEN_ERR_PARSE;
+    }
+    err = jesen_walk_skip(&w, &at);
+    len = at + 1 - cursor->offset;
+    break;
+  }
+  case 't':
+  case 'f':
+  case 'n':
+    len = jesen_cursor_literal(cursor, "true")    ? 4
+          : jesen_cursor_literal(cursor, "false") ? 5
+          : jesen_cursor_literal(cursor, "null")  ? 4
+                                                  : 0;
+    err = len ? JESEN_ERR_NONE : JESEN_ERR_PARSE;
+    break;
+  default: {
+    const char *raw = NULL;
+    err = jesen_cursor_number(cursor, &raw, &len);
+    if (err == JESEN_ERR_INVALID_VALUE_TYPE) {
+      err = JESEN_ERR_PARSE;
+    }
+    break;
+  }
+  }
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  *out = begin;
+  *out_len = len;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_cursor_get_int64(const jesen_cursor_t *cursor,
+                                   int64_t *out) {
+  if (!jesen_cursor_valid(cursor) || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  const char *raw = NULL;
+  size_t len = 0;
+  jesen_err_t err = jesen_cursor_number(cursor, &raw, &len);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_number_to_int64(raw, len, out);
+}
+
+jesen_err_t jesen_cursor_get_double(const jesen_cursor_t *cursor,
+                                    double *out) {
+  if (!jesen_cursor_valid(cursor) || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  const char *raw = NULL;
+  size_t len = 0;
+  jesen_err_t err = jesen_cursor_number(cursor, &raw, &len);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_number_to_double(raw, len, out);
+}
+
+jesen_err_t jesen_cursor_get_bool(const jesen_cursor_t *cursor, bool *out) {
+  if (!jesen_cursor_valid(cursor) || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  if (jesen_cursor_literal(cursor, "true")) {
+    *out = true;
+  } else if (jesen_cursor_literal(cursor, "false")) {
+    *out = false;
+  } else {
+    return JESEN_ERR_INVALID_VALUE_TYPE;
+  }
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_cursor_is_null(const jesen_cursor_t *cursor, bool *out) {
+  if (!jesen_cursor_valid(cursor) || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  *out = jesen_cursor_literal(cursor, "null");
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_cursor_get_string_view(const jesen_cursor_t *cursor,
+                                         const char **out, size_t *out_len) {
+  if (!jesen_cursor_valid(cursor) || !out || !out_len) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  const char *begin = NULL;
+  const char *end = NULL;
+  jesen_err_t err = jesen_cursor_string(cursor, &begin, &end);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  *out = begin;
+  *out_len = (size_t)(end - begin);
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_cursor_get_string(const jesen_cursor_t *cursor, char *out,
+                                    size_t out_max, size_t *out_len) {
+  if (!jesen_cursor_valid(cursor) || !out || out_max == 0) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  const char *begin = NULL;
+  const char *end = NULL;
+  jesen_err_t err = jesen_cursor_string(cursor, &begin, &end);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+
+  size_t raw_len = (size_t)(end - begin);
+  size_t len = 0;
+  if (raw_len < out_max) {
+    if (!jesen_unescape(begin, end, out, &len)) {
+      return JESEN_ERR_PARSE;
+    }
+  } else {
+    // The decoded text may still fit; decode aside and check.
+    char *decoded = (char *)malloc(raw_len);
+    if (!decoded) {
+      return JESEN_ERR_ALLOC;
+    }
+    if (!jesen_unescape(begin, end, decoded, &len)) {
+      free(decoded);
+      return JESEN_ERR_PARSE;
+    }
+    if (len + 1 > out_max) {
+      free(decoded);
+      return JESEN_ERR_INVALID_ARGS;
+    }
+    memcpy(out, decoded, len);
+    free(decoded);
+  }
+  out[len] = '\0';
+  if (out_len) {
+    *out_len = len;
+  }
+  return JESEN_ERR_NONE;
+}
+
+// Decode the RFC 6901 reference token [begin, end) (`~0` is `~`, `~1` is
+// `/`) into `out`, which has room for the raw text.
+static jesen_err_t jesen_pointer_token(const char *begin, const char *end,
+                                       char *out, size_t *out_len) {
+  size_t len = 0;
+  for (const char *p = begin; p < end; ++p) {
+    if (*p != '~') {
+      out[len++] = *p;
+    } else if (p + 1 < end && (p[1] == '0' || p[1] == '1')) {
+      out[len++] = p[1] == '0' ? '~' : '/';
+      p++;
+    } else {
+      return JESEN_ERR_INVALID_ARGS;
+    }
+  }
+  *out_len = len;
+  return JESEN_ERR_NONE;
+}
+
+// Read a reference token as an array index: `0` or digits without a leading
+// zero. Anything else, including the past-the-end `-`, names no element.
+static jesen_err_t jesen_pointer_index(const char *token, size_t len,
+                                       size_t *out) {
+  if (len == 1 && token[0] == '-') {
+    return JESEN_ERR_OUT_OF_RANGE;
+  }
+  if (len == 0 || (len > 1 && token[0] == '0')) {
+    return JESEN_ERR_NOT_FOUND;
+  }
+  size_t index = 0;
+  for (size_t i = 0; i < len; ++i) {
+    if (token[i] < '0' || token[i] > '9') {
+      return JESEN_ERR_NOT_FOUND;
+    }
+    size_t digit = (size_t)(token[i] - '0');
+    if (index > (SIZE_MAX - digit) / 10) {
+      return JESEN_ERR_OUT_OF_RANGE;
+    }
+    index = index * 10 + digit;
+  }
+  *out = index;
+  return JESEN_ERR_NONE;
+}
+
+// Walk from the root of `buf` to the value `pointer` names. Only the members
+// and elements along the path are looked at; everything else is stepped over
+// by the scanner.
+static jesen_err_t jesen_cursor_pointer(const char *buf, size_t buf_len,
+                                        const char *pointer,
+                                        jesen_cursor_t *out) {
+  if (!buf || !pointer || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  if (*pointer && *pointer != '/') {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_cursor_t cur;
+  jesen_err_t err = jesen_cursor_init(buf, buf_len, &cur);
+  // Holds decoded tokens; only needed once a token has an escape in it.
+  char *scratch = NULL;
+  const char *p = pointer;
+  while (err == JESEN_ERR_NONE && *p) {
+    const char *token = ++p;
+    size_t len = strcspn(p, "/");
+    p += len;
+    if (memchr(token, '~', len)) {
+      if (!scratch) {
+        scratch = (char *)malloc(strlen(token));
+        if (!scratch) {
+          err = JESEN_ERR_ALLOC;
+          break;
+        }
+      }
+      err = jesen_pointer_token(token, p, scratch, &len);
+      if (err != JESEN_ERR_NONE) {
+        break;
+      }
+      token = scratch;
+    }
+
+    jesen_cursor_t next;
+    size_t index = 0;
+    switch (buf[cur.offset]) {
+    case '{':
+      err = jesen_cursor_scan_members(&cur, token, len, true, &next);
+      break;
+    case '[':
+      err = jesen_pointer_index(token, len, &index);
+      if (err == JESEN_ERR_NONE) {
+        err = jesen_cursor_at_index(&cur, index, &next);
+      }
+      break;
+    default:
+      err = JESEN_ERR_WRONG_TYPE;
+      break;
+    }
+    if (err == JESEN_ERR_NONE) {
+      cur = next;
+    }
+  }
+  free(scratch);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  *out = cur;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_extract_pointer(const char *buf, size_t buf_len,
+                                  const char *pointer, jesen_node_t **out) {
+  if (!out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_cursor_t cursor;
+  jesen_err_t err = jesen_cursor_pointer(buf, buf_len, pointer, &cursor);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  const char *raw = NULL;
+  size_t len = 0;
+  if ((err = jesen_cursor_get_raw(&cursor, &raw, &len)) != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_parse(raw, len, out);
+}
+
+jesen_err_t jesen_extract_pointer_int64(const char *buf, size_t buf_len,
+                                        const char *pointer, int64_t *out) {
+  if (!out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_cursor_t cursor;
+  jesen_err_t err = jesen_cursor_pointer(buf, buf_len, pointer, &cursor);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_cursor_get_int64(&cursor, out);
+}
+
+jesen_err_t jesen_extract_pointer_double(const char *buf, size_t buf_len,
+                                         const char *pointer, double *out) {
+  if (!out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_cursor_t cursor;
+  jesen_err_t err = jesen_cursor_pointer(buf, buf_len, pointer, &cursor);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_cursor_get_double(&cursor, out);
+}
+
+jesen_err_t jesen_extract_pointer_string(const char *buf, size_t buf_len,
+                                         const char *pointer, const char **out,
+                                         size_t *out_len) {
+  if (!out || !out_len) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_cursor_t cursor;
+  jesen_err_t err = jesen_cursor_pointer(buf, buf_len, pointer, &cursor);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return jesen_cursor_get_string_view(&cursor, out, out_len);
+}
@@ -0,0 +1,319 @@
+#include "jesen_internal.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Reusable parse contexts. A document is a bump allocator over a list of
+// chunks: allocating advances a pointer, releasing a single block does
+// nothing and a reset rewinds to the first chunk. Chunks are only freed by
+// jesen_doc_destroy, so once they cover the largest input a parse makes no
+// malloc calls at all. Trees built in a document, and values added to them,
+// are carved from it the same way; a subtree moves to another document by
+// being copied into it.
+
+// Size of the first chunk; each chunk added later is twice the one before.
+#define JESEN_DOC_FIRST_CHUNK (64 * 1024)
+// Blocks are aligned as malloc aligns them; the chunk header is this size
+// too, so chunk data starts aligned.
+#define JESEN_DOC_ALIGN (2 * sizeof(void *))
+
+typedef struct jesen_doc_chunk {
+  struct jesen_doc_chunk *next;
+  // usable bytes after the header.
+  size_t size;
+} jesen_doc_chunk_t;
+
+struct jesen_doc {
+  // hands out blocks of this document; its ctx is the document itself.
+  jesen_allocator_t allocator;
+  jesen_doc_chunk_t *head;
+  // chunk being carved and the free range left in it.
+  jesen_doc_chunk_t *current;
+  char *ptr;
+  char *end;
+};
+
+static void jesen_doc_enter(jesen_doc_t *doc, jesen_doc_chunk_t *chunk) {
+  doc->current = chunk;
+  doc->ptr = (char *)(chunk + 1);
+  doc->end = doc->ptr + chunk->size;
+}
+
+static jesen_doc_chunk_t *jesen_doc_chunk_new(size_t size) {
+  if (size > SIZE_MAX - sizeof(jesen_doc_chunk_t)) {
+    return NULL;
+  }
+  jesen_doc_chunk_t *chunk =
+      (jesen_doc_chunk_t *)malloc(sizeof *chunk + size);
+  if (chunk) {
+    chunk->next = NULL;
+    chunk->size = size;
+  }
+  return chunk;
+}
+
+// Move on to a chunk with room for `size` bytes: the next one if it fits,
+// otherwise a new one linked in after the current chunk.
+static bool jesen_doc_advance(jesen_doc_t *doc, size_t size) {
+  jesen_doc_chunk_t *next = doc->current->next;
+  if (!next || next->size < size) {
+    size_t grow = doc->current->size * 2;
+    jesen_doc_chunk_t *chunk =
+        jesen_doc_chunk_new(grow > size ? grow : size);
+    if (!chunk) {
+      return false;
+    }
+    chunk->next = next;
+    doc->current->next = chunk;
+    next = chunk;
+  }
+  jesen_doc_enter(doc, next);
+  return true;
+}
+
+static void *jesen_doc_alloc(void *ctx, size_t size) {
+  jesen_doc_t *doc = (jesen_doc_t *)ctx;
+  if (size > SIZE_MAX - JESEN_DOC_ALIGN) {
+    return NULL;
+  }
+  size = (size + JESEN_DOC_ALIGN - 1) & ~(JESEN_DOC_ALIGN - 1);
+  if ((size_t)(doc->end - doc->ptr) < size && !jesen_doc_advance(doc, size)) {
+    return NULL;
+  }
+  void *block = doc->ptr;
+  doc->ptr += size;
+  return block;
+}
+
+static void jesen_doc_release(void *ctx, void *ptr) {
+  // Blocks go back all at once in jesen_doc_reset.
+  (void)ctx;
+  (void)ptr;
+}
+
+bool jesen_allocator_is_pool(const jesen_allocator_t *allocator) {
+  return allocator && allocator->alloc == jesen_doc_alloc;
+}
+
+bool jesen_allocator_foreign(const jesen_allocator_t *tree_allocator,
+                             const jesen_allocator_t *node_allocator) {
+  // A pool tree takes only nodes from its own pool: a heap node would leak
+  // on reset. Any other tree refuses pool nodes, which a reset would free.
+  if (jesen_allocator_is_pool(tree_allocator)) {
+    return node_allocator != tree_allocator;
+  }
+  return jesen_allocator_is_pool(node_allocator);
+}
+
+// Open `node` on the builder: a scalar is emitted whole, a container only
+// gets its begin event and sets `*container`.
+static jesen_err_t jesen_copy_open(void *ctx, jesen_node_t *node,
+                                   bool *container) {
+  const jesen_builder_t *b = &jesen_backend_builder;
+  bool flag = false;
+  const char *str = NULL;
+  size_t len = 0;
+  double number = 0.0;
+  *container = false;
+  if (jesen_value_is_object(node, &flag) == JESEN_ERR_NONE && flag) {
+    *container = true;
+    return b->begin_object(ctx);
+  }
+  if (jesen_value_is_array(node, &flag) == JESEN_ERR_NONE && flag) {
+    *container = true;
+    return b->begin_array(ctx);
+  }
+  if (jesen_value_get_string_ref(node, &str, &len) == JESEN_ERR_NONE) {
+    return b->string(ctx, str, len);
+  }
+  if (jesen_value_get_double(node, &number) == JESEN_ERR_NONE) {
+    // NaN and infinities serialize as null, so they copy as null too.
+    if (!isfinite(number)) {
+      return b->null_value(ctx);
+    }
+    char raw[JESEN_NUMBER_FORMAT_MAX];
+    return b->number(ctx, raw, jesen_format_double(number, raw));
+  }
+  if (jesen_value_get_bool(node, &flag) == JESEN_ERR_NONE) {
+    return b->boolean(ctx, flag);
+  }
+  return b->null_value(ctx);
+}
+
+// Replay `node` and everything below it to the backend builder in document
+// order. Open containers are kept on a stack of iterators, so deep trees do
+// not recurse.
+static jesen_err_t jesen_copy_replay(void *ctx, jesen_node_t *node) {
+  const jesen_builder_t *b = &jesen_backend_builder;
+  bool container = false;
+  jesen_err_t err = jesen_copy_open(ctx, node, &container);
+  if (err != JESEN_ERR_NONE || !container) {
+    return err;
+  }
+
+  jesen_iter_t inline_stack[32];
+  jesen_iter_t *stack = inline_stack;
+  size_t cap = sizeof inline_stack / sizeof *inline_stack;
+  size_t depth = 0;
+  err = jesen_iter_begin(node, &stack[depth++]);
+  while (err == JESEN_ERR_NONE && depth > 0) {
+    jesen_iter_t *it = &stack[depth - 1];
+    const char *key = NULL;
+    size_t key_len = 0;
+    jesen_node_t *child = NULL;
+    err = jesen_iter_next(it, &key, &key_len, &child);
+    if (err == JESEN_ERR_NOT_FOUND) {
+      bool object = false;
+      err = jesen_value_is_object(it->node, &object);
+      if (err == JESEN_ERR_NONE) {
+        err = object ? b->end_object(ctx) : b->end_array(ctx);
+      }
+      depth--;
+      continue;
+    }
+    if (err != JESEN_ERR_NONE ||
+        (key && (err = b->key(ctx, key, key_len)) != JESEN_ERR_NONE) ||
+        (err = jesen_copy_open(ctx, child, &container)) != JESEN_ERR_NONE ||
+        !container) {
+      continue;
+    }
+    if (depth == cap) {
+      jesen_iter_t *grown = (jesen_iter_t *)malloc(cap * 2 * sizeof *grown);
+      if (!grown) {
+        err = JESEN_ERR_ALLOC;
+        break;
+      }
+      memcpy(grown, stack, depth * sizeof *grown);
+      if (stack != inline_stack) {
+        free(stack);
+      }
+      stack = grown;
+      cap *= 2;
+    }
+    err = jesen_iter_begin(child, &stack[depth++]);
+  }
+
+  if (stack != inline_stack) {
+    free(stack);
+  }
+  return err;
+}
+
+// Run `build` against a backend builder carving from `doc` (the heap when
+// NULL) and return the finished tree.
+static jesen_err_t jesen_doc_build(jesen_doc_t *doc,
+                                   jesen_err_t (*build)(void *ctx, void *arg),
+                                   void *arg, jesen_node_t **out) {
+  jesen_parse_opts_t opts;
+  memset(&opts, 0, sizeof opts);
+  opts.allocator = doc ? &doc->allocator : NULL;
+  void *ctx = NULL;
+  jesen_err_t err = jesen_backend_builder_create(false, &opts, &ctx);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  err = build(ctx, arg);
+  return jesen_backend_builder_finish(ctx, err, out);
+}
+
+static jesen_err_t jesen_doc_build_object(void *ctx, void *arg) {
+  (void)arg;
+  jesen_err_t err = jesen_backend_builder.begin_object(ctx);
+  return err != JESEN_ERR_NONE ? err : jesen_backend_builder.end_object(ctx);
+}
+
+static jesen_err_t jesen_doc_build_array(void *ctx, void *arg) {
+  (void)arg;
+  jesen_err_t err = jesen_backend_builder.begin_array(ctx);
+  return err != JESEN_ERR_NONE ? err : jesen_backend_builder.end_array(ctx);
+}
+
+static jesen_err_t jesen_doc_build_copy(void *ctx, void *arg) {
+  return jesen_copy_replay(ctx, (jesen_node_t *)arg);
+}
+
+jesen_err_t jesen_doc_create(jesen_doc_t **out) {
+  if (!out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  jesen_doc_t *doc = (jesen_doc_t *)calloc(1, sizeof *doc);
+  if (!doc) {
+    return JESEN_ERR_ALLOC;
+  }
+  doc->head = jesen_doc_chunk_new(JESEN_DOC_FIRST_CHUNK);
+  if (!doc->head) {
+    free(doc);
+    return JESEN_ERR_ALLOC;
+  }
+  doc->allocator.alloc = jesen_doc_alloc;
+  doc->allocator.release = jesen_doc_release;
+  doc->allocator.ctx = doc;
+  jesen_doc_enter(doc, doc->head);
+
+  *out = doc;
+
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_doc_parse(jesen_doc_t *doc, const char *buf, size_t buf_len,
+                            jesen_node_t **out) {
+  if (!doc || !buf || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  jesen_doc_reset(doc);
+  jesen_parse_opts_t opts;
+  memset(&opts, 0, sizeof opts);
+  opts.allocator = &doc->allocator;
+  return jesen_parse_tree(buf, NULL, buf_len, &opts, out);
+}
+
+jesen_err_t jesen_doc_object_create(jesen_doc_t *doc, jesen_node_t **out) {
+  if (!doc || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  return jesen_doc_build(doc, jesen_doc_build_object, NULL, out);
+}
+
+jesen_err_t jesen_doc_array_create(jesen_doc_t *doc, jesen_node_t **out) {
+  if (!doc || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  return jesen_doc_build(doc, jesen_doc_build_array, NULL, out);
+}
+
+jesen_err_t jesen_node_copy(jesen_node_t *node, jesen_doc_t *doc,
+                            jesen_node_t **out) {
+  if (!node || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  return jesen_doc_build(doc, jesen_doc_build_copy, node, out);
+}
+
+jesen_err_t jesen_doc_reset(jesen_doc_t *doc) {
+  if (!doc) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  jesen_doc_enter(doc, doc->head);
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_doc_destroy(jesen_doc_t *doc) {
+  if (!doc) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  jesen_doc_chunk_t *chunk = doc->head;
+  while (chunk) {
+    jesen_doc_chunk_t *next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+  free(doc);
+  return JESEN_ERR_NONE;
+}
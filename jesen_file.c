@@ -0,0 +1,168 @@
+#include "jesen_internal.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define JESEN_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// File parsing entry point. The file is memory-mapped where the platform
+// allows it, so the parser reads the page cache directly instead of a heap
+// copy. Anything that cannot be mapped (pipes, special files, other
+// platforms) is read into a heap buffer instead.
+
+typedef struct {
+  jesen_backing_t base;
+  char *data;
+  size_t len;
+  // true for an mmap'd region, false for a malloc'd buffer.
+  bool mapped;
+} jesen_file_input_t;
+
+static void jesen_file_release(jesen_backing_t *backing) {
+  jesen_file_input_t *input = (jesen_file_input_t *)backing;
+#if defined(JESEN_HAVE_MMAP)
+  if (input->mapped) {
+    munmap(input->data, input->len);
+  } else {
+    free(input->data);
+  }
+#else
+  free(input->data);
+#endif
+  free(input);
+}
+
+// Read the rest of `file` into a growing heap buffer.
+static jesen_err_t jesen_file_read_stream(FILE *file,
+                                          jesen_file_input_t *input) {
+  size_t cap = 64 * 1024;
+  char *buf = (char *)malloc(cap);
+  size_t len = 0;
+  if (!buf) {
+    return JESEN_ERR_ALLOC;
+  }
+  for (;;) {
+    if (len == cap) {
+      char *grown = (char *)realloc(buf, cap * 2);
+      if (!grown) {
+        free(buf);
+        return JESEN_ERR_ALLOC;
+      }
+      buf = grown;
+      cap *= 2;
+    }
+    size_t got = fread(buf + len, 1, cap - len, file);
+    len += got;
+    if (got == 0) {
+      break;
+    }
+  }
+  if (ferror(file)) {
+    free(buf);
+    return JESEN_ERR_UNKNOWN;
+  }
+  input->data = buf;
+  input->len = len;
+  input->mapped = false;
+  return JESEN_ERR_NONE;
+}
+
+static jesen_err_t jesen_file_load(const char *path, bool writable,
+                                   jesen_file_input_t *input) {
+#if defined(JESEN_HAVE_MMAP)
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return errno == ENOENT ? JESEN_ERR_NOT_FOUND : JESEN_ERR_UNKNOWN;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 &&
+      (unsigned long long)st.st_size <= (size_t)-1) {
+    // A private writable mapping is copy-on-write: in-situ parsing dirties
+    // only the pages it writes to, and never the file.
+    int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void *map = mmap(NULL, (size_t)st.st_size, prot, MAP_PRIVATE, fd, 0);
+    if (map != MAP_FAILED) {
+      close(fd);
+      madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+      input->data = (char *)map;
+      input->len = (size_t)st.st_size;
+      input->mapped = true;
+      return JESEN_ERR_NONE;
+    }
+  }
+  FILE *file = fdopen(fd, "rb");
+  if (!file) {
+    close(fd);
+    return JESEN_ERR_UNKNOWN;
+  }
+#else
+  (void)writable;
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    return errno == ENOENT ? JESEN_ERR_NOT_FOUND : JESEN_ERR_UNKNOWN;
+  }
+#endif
+  jesen_err_t err = jesen_file_read_stream(file, input);
+  fclose(file);
+  return err;
+}
+
+jesen_err_t jesen_parse_file(const char *path, uint32_t flags,
+                             jesen_node_t **out) {
+  const uint32_t parse_flags = JESEN_PARSE_STRICT_UTF8 |
+                               JESEN_PARSE_EAGER_WRAPPERS |
+                               JESEN_PARSE_INTERN_KEYS;
+  if (!path || !out || (flags & ~(parse_flags | JESEN_FILE_KEEP_MAPPING))) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  jesen_file_input_t *input =
+      (jesen_file_input_t *)calloc(1, sizeof *input);
+  if (!input) {
+    return JESEN_ERR_ALLOC;
+  }
+  input->base.release = jesen_file_release;
+
+  bool keep = (flags & JESEN_FILE_KEEP_MAPPING) != 0;
+  jesen_err_t err = jesen_file_load(path, keep, input);
+  if (err != JESEN_ERR_NONE) {
+    free(input);
+    return err;
+  }
+
+  jesen_parse_opts_t opts;
+  memset(&opts, 0, sizeof opts);
+  opts.flags = flags & parse_flags;
+  jesen_node_t *root = NULL;
+  if (!keep) {
+    err = jesen_parse_tree(input->data, NULL, input->len, &opts, &root);
+    jesen_file_release(&input->base);
+    if (err != JESEN_ERR_NONE) {
+      return err;
+    }
+    *out = root;
+    return JESEN_ERR_NONE;
+  }
+
+  err = jesen_parse_tree(input->data, input->data, input->len, &opts, &root);
+  if (err != JESEN_ERR_NONE) {
+    jesen_file_release(&input->base);
+    return err;
+  }
+#if defined(JESEN_HAVE_MMAP)
+  if (input->mapped) {
+    // Lookups into the kept mapping are no longer sequential.
+    madvise(input->data, input->len, MADV_NORMAL);
+  }
+#endif
+  jesen_backend_set_backing(root, &input->base);
+  *out = root;
+  return JESEN_ERR_NONE;
+}
@@ -0,0 +1,160 @@
+#include "jesen_internal.h"
+#include <string.h>
+
+// Hash indexes over the members of large objects, shared by both backends.
+// The table maps each key to the member lookups should find and is kept in
+// step by the backends as members come and go. Linear probing with
+// backward-shift deletion keeps it free of tombstones, so a long run of
+// adds and removes does not degrade it.
+
+typedef struct {
+  // key of `item`, owned by the member; NULL for an empty slot.
+  const char *key;
+  size_t hash;
+  void *item;
+} jesen_index_slot_t;
+
+struct jesen_index {
+  const jesen_allocator_t *allocator;
+  jesen_index_slot_t *slots;
+  // power of two, kept at least twice `count`.
+  size_t cap;
+  size_t count;
+  // set once two members shared a key; the shadowed one is not in the table.
+  bool duplicates;
+};
+
+static jesen_index_slot_t *jesen_index_slots(const jesen_allocator_t *allocator,
+                                             size_t cap) {
+  jesen_index_slot_t *slots =
+      (jesen_index_slot_t *)jesen_alloc(allocator, cap * sizeof *slots);
+  if (slots) {
+    memset(slots, 0, cap * sizeof *slots);
+  }
+  return slots;
+}
+
+// Slot holding `key`, or the empty slot where it would go.
+static size_t jesen_index_probe(const jesen_index_t *index, const char *key,
+                                size_t hash) {
+  size_t mask = index->cap - 1;
+  size_t slot = hash & mask;
+  for (; index->slots[slot].key; slot = (slot + 1) & mask) {
+    const jesen_index_slot_t *cur = &index->slots[slot];
+    if (cur->key == key ||
+        (cur->hash == hash && strcmp(cur->key, key) == 0)) {
+      break;
+    }
+  }
+  return slot;
+}
+
+static bool jesen_index_grow(jesen_index_t *index) {
+  size_t cap = index->cap * 2;
+  jesen_index_slot_t *slots = jesen_index_slots(index->allocator, cap);
+  if (!slots) {
+    return false;
+  }
+  for (size_t i = 0; i < index->cap; ++i) {
+    if (index->slots[i].key) {
+      size_t slot = index->slots[i].hash & (cap - 1);
+      while (slots[slot].key) {
+        slot = (slot + 1) & (cap - 1);
+      }
+      slots[slot] = index->slots[i];
+    }
+  }
+  jesen_release(index->allocator, index->slots);
+  index->slots = slots;
+  index->cap = cap;
+  return true;
+}
+
+jesen_index_t *jesen_index_create(const jesen_allocator_t *allocator,
+                                  size_t count) {
+  jesen_index_t *index = (jesen_index_t *)jesen_alloc(allocator, sizeof *index);
+  if (!index) {
+    return NULL;
+  }
+  memset(index, 0, sizeof *index);
+  index->allocator = allocator;
+  index->cap = 16;
+  while (index->cap < count * 2) {
+    index->cap *= 2;
+  }
+  index->slots = jesen_index_slots(allocator, index->cap);
+  if (!index->slots) {
+    jesen_release(allocator, index);
+    return NULL;
+  }
+  return index;
+}
+
+bool jesen_index_put(jesen_index_t *index, const char *key, void *item,
+                     bool replace) {
+  size_t hash = jesen_hash(key, strlen(key));
+  size_t slot = jesen_index_probe(index, key, hash);
+  jesen_index_slot_t *cur = &index->slots[slot];
+  if (cur->key) {
+    index->duplicates = true;
+    if (replace) {
+      cur->key = key;
+      cur->item = item;
+    }
+    return true;
+  }
+
+  if ((index->count + 1) * 2 > index->cap) {
+    if (!jesen_index_grow(index)) {
+      return false;
+    }
+    slot = jesen_index_probe(index, key, hash);
+    cur = &index->slots[slot];
+  }
+  cur->key = key;
+  cur->hash = hash;
+  cur->item = item;
+  index->count++;
+  return true;
+}
+
+void *jesen_index_find(const jesen_index_t *index, const char *key) {
+  size_t slot = jesen_index_probe(index, key, jesen_hash(key, strlen(key)));
+  return index->slots[slot].key ? index->slots[slot].item : NULL;
+}
+
+bool jesen_index_remove(jesen_index_t *index, const char *key,
+                        const void *item) {
+  size_t mask = index->cap - 1;
+  size_t slot = jesen_index_probe(index, key, jesen_hash(key, strlen(key)));
+  if (!index->slots[slot].key || index->slots[slot].item != item) {
+    // A shadowed duplicate: the member lookups find is unchanged.
+    return true;
+  }
+  if (index->duplicates) {
+    // Another member may share the key, and the table does not know which.
+    return false;
+  }
+
+  // Shift later members of the probe run back into the hole so every key
+  // stays reachable from its home slot.
+  size_t hole = slot;
+  for (size_t next = (hole + 1) & mask; index->slots[next].key;
+       next = (next + 1) & mask) {
+    size_t home = index->slots[next].hash & mask;
+    if (((next - home) & mask) >= ((next - hole) & mask)) {
+      index->slots[hole] = index->slots[next];
+      hole = next;
+    }
+  }
+  memset(&index->slots[hole], 0, sizeof index->slots[hole]);
+  index->count--;
+  return true;
+}
+
+void jesen_index_destroy(jesen_index_t *index) {
+  if (index) {
+    jesen_release(index->allocator, index->slots);
+    jesen_release(index->allocator, index);
+  }
+}
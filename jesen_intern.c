@@ -0,0 +1,175 @@
+#include "jesen_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Key pools. Each distinct key is stored once and every tree parsed with the
+// pool points its keys at that copy, so record-shaped documents pay for their
+// field names once rather than once per record. The pool is reference
+// counted: the caller holds one reference and every tree built with it holds
+// another, so the last of them to go frees the keys.
+
+typedef struct {
+  // NUL-terminated copy of the key; NULL for an empty slot.
+  char *key;
+  size_t len;
+  size_t hash;
+} jesen_intern_entry_t;
+
+struct jesen_intern {
+  jesen_intern_entry_t *slots;
+  // power of two, kept at least twice `count`.
+  size_t cap;
+  size_t count;
+  size_t refs;
+};
+
+// A tree's reference to its pool, released along with the tree.
+typedef struct {
+  jesen_backing_t base;
+  jesen_intern_t *pool;
+} jesen_intern_ref_t;
+
+static void jesen_intern_unref(jesen_intern_t *pool) {
+#if defined(JESEN_HAVE_PTHREADS)
+  // Trees sharing a pool may be destroyed on different threads.
+  if (__atomic_sub_fetch(&pool->refs, 1, __ATOMIC_ACQ_REL) != 0) {
+    return;
+  }
+#else
+  if (--pool->refs != 0) {
+    return;
+  }
+#endif
+  for (size_t i = 0; i < pool->cap; ++i) {
+    free(pool->slots[i].key);
+  }
+  free(pool->slots);
+  free(pool);
+}
+
+static void jesen_intern_release_ref(jesen_backing_t *backing) {
+  jesen_intern_ref_t *ref = (jesen_intern_ref_t *)backing;
+  jesen_intern_unref(ref->pool);
+  free(ref);
+}
+
+// Double the table, rehashing the entries into their new slots.
+static bool jesen_intern_grow(jesen_intern_t *pool) {
+  size_t cap = pool->cap * 2;
+  jesen_intern_entry_t *slots =
+      (jesen_intern_entry_t *)calloc(cap, sizeof *slots);
+  if (!slots) {
+    return false;
+  }
+  for (size_t i = 0; i < pool->cap; ++i) {
+    jesen_intern_entry_t *entry = &pool->slots[i];
+    if (entry->key) {
+      size_t slot = entry->hash & (cap - 1);
+      while (slots[slot].key) {
+        slot = (slot + 1) & (cap - 1);
+      }
+      slots[slot] = *entry;
+    }
+  }
+  free(pool->slots);
+  pool->slots = slots;
+  pool->cap = cap;
+  return true;
+}
+
+const char *jesen_intern_get(jesen_intern_t *pool, const char *key,
+                             size_t len) {
+  size_t hash = jesen_hash(key, len);
+  size_t mask = pool->cap - 1;
+  size_t slot = hash & mask;
+  for (; pool->slots[slot].key; slot = (slot + 1) & mask) {
+    jesen_intern_entry_t *entry = &pool->slots[slot];
+    if (entry->hash == hash && entry->len == len &&
+        memcmp(entry->key, key, len) == 0) {
+      return entry->key;
+    }
+  }
+
+  if ((pool->count + 1) * 2 > pool->cap) {
+    if (!jesen_intern_grow(pool)) {
+      return NULL;
+    }
+    mask = pool->cap - 1;
+    slot = hash & mask;
+    while (pool->slots[slot].key) {
+      slot = (slot + 1) & mask;
+    }
+  }
+  char *copy = (char *)malloc(len + 1);
+  if (!copy) {
+    return NULL;
+  }
+  memcpy(copy, key, len);
+  copy[len] = '\0';
+  pool->slots[slot].key = copy;
+  pool->slots[slot].len = len;
+  pool->slots[slot].hash = hash;
+  pool->count++;
+  return copy;
+}
+
+jesen_err_t jesen_intern_attach(jesen_intern_t *pool, jesen_node_t *root) {
+  jesen_intern_ref_t *ref = (jesen_intern_ref_t *)calloc(1, sizeof *ref);
+  if (!ref) {
+    return JESEN_ERR_ALLOC;
+  }
+  ref->base.release = jesen_intern_release_ref;
+  ref->pool = pool;
+#if defined(JESEN_HAVE_PTHREADS)
+  __atomic_add_fetch(&pool->refs, 1, __ATOMIC_RELAXED);
+#else
+  pool->refs++;
+#endif
+  jesen_backend_set_backing(root, &ref->base);
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_intern_create(jesen_intern_t **out) {
+  if (!out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  jesen_intern_t *pool = (jesen_intern_t *)calloc(1, sizeof *pool);
+  if (!pool) {
+    return JESEN_ERR_ALLOC;
+  }
+  pool->cap = 64;
+  pool->slots = (jesen_intern_entry_t *)calloc(pool->cap, sizeof *pool->slots);
+  if (!pool->slots) {
+    free(pool);
+    return JESEN_ERR_ALLOC;
+  }
+  pool->refs = 1;
+
+  *out = pool;
+
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_intern_key(jesen_intern_t *pool, const char *key,
+                             const char **out) {
+  if (!pool || !key || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  const char *interned = jesen_intern_get(pool, key, strlen(key));
+  if (!interned) {
+    return JESEN_ERR_ALLOC;
+  }
+  *out = interned;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_intern_destroy(jesen_intern_t *pool) {
+  if (!pool) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  jesen_intern_unref(pool);
+  return JESEN_ERR_NONE;
+}
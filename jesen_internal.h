@@ -0,0 +1,398 @@
+#pragma once
+
+// Private declarations shared between jesen translation units. Nothing in
+// here is part of the installed API.
+
+#include "jesen.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum container nesting accepted by the parser. */
+#define JESEN_NESTING_LIMIT 1000
+
+/**
+ * @brief Callbacks the parser uses to hand a document to a tree builder.
+ *
+ * Same shape as the public event handler, except that every callback must be
+ * set. Any error returned by a callback aborts the parse and is returned to
+ * the caller unchanged.
+ */
+typedef jesen_handler_t jesen_builder_t;
+
+/** Builder callbacks of the backend tree (defined by jesen_cjson.c or
+ * jesen_native.c). */
+extern const jesen_builder_t jesen_backend_builder;
+
+/**
+ * @brief Allocate state for `jesen_backend_builder`.
+ * @param borrow When true, key and string slices are kept by reference (they
+ *               must outlive the tree) instead of being copied.
+ * @param opts Parse options (allocator, duplicate keys, eager wrappers), or
+ *             NULL for the defaults.
+ */
+jesen_err_t jesen_backend_builder_create(bool borrow,
+                                         const jesen_parse_opts_t *opts,
+                                         void **out_ctx);
+
+/**
+ * @brief Release builder state created by `jesen_backend_builder_create`.
+ *
+ * When `err` is JESEN_ERR_NONE the finished tree is stored in `out`;
+ * otherwise any partial tree is freed and `err` is returned.
+ */
+jesen_err_t jesen_backend_builder_finish(void *ctx, jesen_err_t err,
+                                         jesen_node_t **out);
+
+/** Take `size` bytes from `allocator`, or from malloc when it is NULL. */
+void *jesen_alloc(const jesen_allocator_t *allocator, size_t size);
+
+/** Give back a block from `jesen_alloc`; NULL is ignored. */
+void jesen_release(const jesen_allocator_t *allocator, void *ptr);
+
+/**
+ * @brief Whether `allocator` is a document pool, whose blocks are never
+ *        released one by one. Backends may then carve memory from it that
+ *        their own free paths would not know how to return.
+ */
+bool jesen_allocator_is_pool(const jesen_allocator_t *allocator);
+
+/**
+ * @brief Whether a node from `node_allocator` must not join a tree from
+ *        `tree_allocator`: a document's tree and the nodes attached to it
+ *        must all come from that document's pool, since a reset frees the
+ *        pool and nothing else.
+ */
+bool jesen_allocator_foreign(const jesen_allocator_t *tree_allocator,
+                             const jesen_allocator_t *node_allocator);
+
+/** Hash of the `len` bytes at `key`. */
+size_t jesen_hash(const char *key, size_t len);
+
+/**
+ * @brief Scratch space for applying a duplicate-key policy to one object.
+ *
+ * The backend reserves room, fills `keys` with the object's keys in document
+ * order and runs the policy, which sets `drop` for every member to remove.
+ * The buffers are reused from object to object.
+ */
+typedef struct {
+  const jesen_allocator_t *allocator;
+  const char **keys;
+  bool *drop;
+  size_t cap;
+  // open-addressing table of key index + 1, zero for an empty slot.
+  size_t *slots;
+  size_t slot_cap;
+} jesen_dedupe_t;
+
+/** Make room for `count` keys. */
+jesen_err_t jesen_dedupe_reserve(jesen_dedupe_t *d, size_t count);
+
+/**
+ * @brief Mark the members `policy` drops among `keys[0, count)`.
+ * @return JESEN_ERR_NONE, or JESEN_ERR_DUPLICATE_KEY under
+ *         JESEN_DUPLICATE_ERROR when a key repeats.
+ */
+jesen_err_t jesen_dedupe_run(jesen_dedupe_t *d, size_t count,
+                             jesen_duplicate_policy_t policy);
+
+/** Free the buffers of `d`. */
+void jesen_dedupe_free(jesen_dedupe_t *d);
+
+// Objects with at least this many members get a hash index over their keys.
+#ifndef JESEN_INDEX_MIN_MEMBERS
+#define JESEN_INDEX_MIN_MEMBERS 32
+#endif
+
+// Native arrays get an element vector on the first access at or past this
+// index; nearer elements are reached by walking. cJSON-backed arrays build
+// theirs on any indexed access, as their wrapper list runs back to front.
+#ifndef JESEN_ELEMENTS_MIN_INDEX
+#define JESEN_ELEMENTS_MIN_INDEX 8
+#endif
+
+/**
+ * @brief Hash index from the keys of one object's members to the members.
+ *
+ * Keys are borrowed from the members, so a member must be removed from the
+ * index before its key changes or it is freed.
+ */
+typedef struct jesen_index jesen_index_t;
+
+/** Create an empty index sized for `count` members, or NULL. */
+jesen_index_t *jesen_index_create(const jesen_allocator_t *allocator,
+                                  size_t count);
+
+/**
+ * @brief Map `key` to `item`. With `replace` clear, a key already present
+ *        keeps its member.
+ * @return False when out of memory; the index no longer covers every member.
+ */
+bool jesen_index_put(jesen_index_t *index, const char *key, void *item,
+                     bool replace);
+
+/** The member mapped to `key`, or NULL. */
+void *jesen_index_find(const jesen_index_t *index, const char *key);
+
+/**
+ * @brief Forget member `item` with key `key`.
+ * @return False when another member with the same key may need to take its
+ *         place; the index must then be rebuilt.
+ */
+bool jesen_index_remove(jesen_index_t *index, const char *key,
+                        const void *item);
+
+/** Free an index (NULL is fine). */
+void jesen_index_destroy(jesen_index_t *index);
+
+/**
+ * @brief Memory a tree borrows from (a file mapping, an in-situ buffer, a key
+ *        pool).
+ *
+ * A root that owns backings calls `release` on each once the tree itself has
+ * been freed.
+ */
+typedef struct jesen_backing {
+  void (*release)(struct jesen_backing *backing);
+  // next backing owned by the same root.
+  struct jesen_backing *next;
+} jesen_backing_t;
+
+/** Make `root` own `backing` too; it is released when the tree is destroyed. */
+void jesen_backend_set_backing(jesen_node_t *root, jesen_backing_t *backing);
+
+/**
+ * @brief The pooled copy of the key [key, key + len), added if new.
+ * @return The NUL-terminated copy, or NULL when out of memory.
+ */
+const char *jesen_intern_get(jesen_intern_t *pool, const char *key,
+                             size_t len);
+
+/** Keep `pool` alive until the tree at `root` is destroyed. */
+jesen_err_t jesen_intern_attach(jesen_intern_t *pool, jesen_node_t *root);
+
+/**
+ * @brief Move every element of array `src` to the end of array `dst`, then
+ *        free `src`.
+ *
+ * Both must be roots fresh from `jesen_backend_builder_finish`.
+ */
+void jesen_backend_array_splice(jesen_node_t *dst, jesen_node_t *src);
+
+/** One step of a compiled projection: an object member or `[*]`. */
+typedef struct jesen_proj_step {
+  // member name, NUL-terminated; NULL for the `[*]` step.
+  char *key;
+  size_t key_len;
+  // some path ends here, so the whole value is kept.
+  bool whole;
+  struct jesen_proj_step *child;
+  struct jesen_proj_step *next;
+} jesen_proj_step_t;
+
+struct jesen_projection {
+  // stands for the document itself.
+  jesen_proj_step_t root;
+};
+
+/** Child step of `step` matching member `key`, or NULL. */
+const jesen_proj_step_t *jesen_proj_member(const jesen_proj_step_t *step,
+                                           const char *key, size_t len);
+
+/** The `[*]` child step of `step`, or NULL. */
+const jesen_proj_step_t *jesen_proj_element(const jesen_proj_step_t *step);
+
+/**
+ * @brief Validate `buf` as a single JSON document and replay it to `builder`.
+ * @return JESEN_ERR_NONE, JESEN_ERR_PARSE for malformed input, or the first
+ *         error a callback returned.
+ */
+jesen_err_t jesen_parse_with_builder(const char *buf, size_t buf_len,
+                                     const jesen_builder_t *builder,
+                                     void *ctx);
+
+/**
+ * @brief Parse `buf` as the comma-separated values inside an array.
+ *
+ * The caller emits the enclosing begin_array/end_array itself; `buf` holds
+ * neither bracket. Nesting is counted from depth 1, so the result matches
+ * what jesen_parse_with_builder would produce for the whole array.
+ */
+jesen_err_t jesen_parse_elements_with_builder(const char *buf, size_t buf_len,
+                                              const jesen_builder_t *builder,
+                                              void *ctx);
+
+/**
+ * @brief Like jesen_parse_with_builder, but decode strings inside `buf`.
+ *
+ * Every key and string slice handed to the builder points into `buf`, is
+ * NUL-terminated, and stays valid for as long as `buf` does. Bytes outside
+ * those slices may be overwritten.
+ */
+jesen_err_t jesen_parse_insitu_with_builder(char *buf, size_t buf_len,
+                                            const jesen_builder_t *builder,
+                                            void *ctx);
+
+/**
+ * @brief Parse `buf` into a backend tree, in situ when `insitu` aliases it.
+ * @param opts Parse options, or NULL for the defaults.
+ */
+jesen_err_t jesen_parse_tree(const char *buf, char *insitu, size_t buf_len,
+                             const jesen_parse_opts_t *opts,
+                             jesen_node_t **out);
+
+/**
+ * @brief Decode the escapes of a string literal body `[in, end)` into `dst`.
+ *
+ * The output is never longer than the input, so `dst` may alias `in`.
+ * @return false on an invalid escape or unpaired surrogate.
+ */
+bool jesen_unescape(const char *in, const char *end, char *dst,
+                    size_t *out_len);
+
+/**
+ * @brief Match the RFC 8259 number grammar at the start of `buf`.
+ * @return Length of the number, or 0 if `buf` does not start with one.
+ */
+size_t jesen_scan_number(const char *buf, size_t len);
+
+/**
+ * @brief Convert a number token already validated by the parser.
+ * @return JESEN_ERR_NONE or JESEN_ERR_ALLOC.
+ */
+jesen_err_t jesen_number_to_double(const char *raw, size_t len, double *out);
+
+/**
+ * @brief Convert a validated number token that should be an integer.
+ * @return JESEN_ERR_NONE, JESEN_ERR_INVALID_VALUE_TYPE if the token has a
+ *         fraction or exponent, or JESEN_ERR_OUT_OF_RANGE if it overflows.
+ */
+jesen_err_t jesen_number_to_int64(const char *raw, size_t len, int64_t *out);
+
+/** Buffer size that fits any `jesen_format_double` output. */
+#define JESEN_NUMBER_FORMAT_MAX 32
+
+/**
+ * @brief Format a double as the shortest text that reads back to it.
+ *
+ * Switches to exponent notation where `%.15g` (or `%.17g` for 16-17 digit
+ * values) would, so integers print without a fraction; NaN and infinities
+ * print as `null`.
+ * The output does not depend on the locale and is not terminated.
+ * @param out At least JESEN_NUMBER_FORMAT_MAX bytes.
+ * @return Number of bytes written.
+ */
+size_t jesen_format_double(double value, char *out);
+
+/**
+ * @brief Format an integer in decimal; `out` needs at least 20 bytes.
+ * @return Number of bytes written (not terminated).
+ */
+size_t jesen_format_int64(int64_t value, char *out);
+
+/** Bounded output buffer for the serializers. */
+typedef struct {
+  char *buf;
+  size_t cap;
+  size_t len;
+} jesen_writer_t;
+
+/** Room for `n` more bytes plus the terminator, or NULL if it is short. */
+char *jesen_writer_reserve(jesen_writer_t *w, size_t n);
+
+/** Append raw bytes; false if they do not fit. */
+bool jesen_writer_put(jesen_writer_t *w, const char *data, size_t n);
+
+/** Append a number via `jesen_format_double`; false if it does not fit. */
+bool jesen_writer_number(jesen_writer_t *w, double d);
+
+/** Append `str` as a quoted, escaped JSON string; false if it does not fit. */
+bool jesen_writer_string(jesen_writer_t *w, const char *str, size_t len);
+
+/** One unit of work for `jesen_run_tasks`. */
+typedef jesen_err_t (*jesen_task_fn)(void *ctx, size_t task);
+
+/** Resolve a thread count request (0 = one per online CPU). Always 1 in
+ * builds without thread support. */
+size_t jesen_thread_count(size_t requested);
+
+/**
+ * @brief Run tasks [0, tasks) on up to `threads` threads, the caller included.
+ *
+ * Tasks may run concurrently and in any order. After the first task fails no
+ * further tasks are started.
+ * @return JESEN_ERR_NONE or the first error a task returned.
+ */
+jesen_err_t jesen_run_tasks(size_t threads, size_t tasks, jesen_task_fn fn,
+                            void *ctx);
+
+/** Per-block classification produced by the stage-1 kernels. */
+typedef struct {
+  uint64_t quote;
+  uint64_t backslash;
+  uint64_t op;
+  uint64_t ws;
+  uint64_t ctrl;
+} jesen_block_masks_t;
+
+/** Number of 64-byte blocks the scanner classifies per refill. */
+#define JESEN_SCAN_BATCH_BLOCKS 4
+
+/**
+ * @brief Stage-1 structural scanner.
+ *
+ * Classifies the input 64 bytes at a time with the best SIMD kernel the CPU
+ * supports and yields the offsets of structural characters (`{}[]:,`), of
+ * every unescaped quote, and of the first byte of each bare scalar, all
+ * outside string literals.
+ */
+typedef struct {
+  const unsigned char *buf;
+  size_t len;
+  size_t offset;
+  uint64_t prev_in_string;
+  uint64_t prev_escaped;
+  uint64_t prev_scalar;
+  bool bad_string;
+  // validate UTF-8 as blocks are classified; set by the caller after init.
+  bool check_utf8;
+  bool bad_utf8;
+  // last three bytes of the previous block, zero before the first one.
+  unsigned char utf8_tail[3];
+  size_t count;
+  size_t next;
+  size_t indices[JESEN_SCAN_BATCH_BLOCKS * 64];
+} jesen_scanner_t;
+
+void jesen_scanner_init(jesen_scanner_t *scanner, const char *buf,
+                        size_t len);
+
+/**
+ * @brief Start scanning in the middle of a document.
+ *
+ * `buf` begins inside a string literal when `in_string` is set, and its first
+ * byte is escaped by a preceding backslash when `escaped` is set.
+ */
+void jesen_scanner_resume(jesen_scanner_t *scanner, const char *buf,
+                          size_t len, bool in_string, bool escaped);
+
+/**
+ * @brief Fetch the next structural offset.
+ * @return false once the input is exhausted.
+ */
+bool jesen_scanner_next(jesen_scanner_t *scanner, size_t *out_offset);
+
+/**
+ * @brief Consume structurals up to the bracket that closes a container whose
+ *        opening bracket was the last one returned.
+ *
+ * Brackets are only counted, not matched by kind.
+ * @return false if the input ends first.
+ */
+bool jesen_scanner_skip(jesen_scanner_t *scanner, size_t *out_offset);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,1259 @@
+#include "jesen_internal.h"
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Native backend: every JSON value is a single heap node that carries its
+// type, payload and tree links, so a parsed document is one allocation per
+// value (plus one per key/string) instead of a cJSON item and a wrapper.
+// Parsing goes through the shared front end in jesen_parser.c.
+
+typedef enum {
+  JESEN_TYPE_NULL,
+  JESEN_TYPE_BOOL,
+  JESEN_TYPE_NUMBER,
+  JESEN_TYPE_STRING,
+  JESEN_TYPE_ARRAY,
+  JESEN_TYPE_OBJECT,
+} jesen_type_t;
+
+struct jesen_node {
+  jesen_type_t type;
+  // property name when the node lives inside an object, otherwise NULL.
+  char *key;
+  // set when key / string point into a jesen_parse_insitu buffer; keys also
+  // when they come from a key pool.
+  bool borrowed_key;
+  bool borrowed_string;
+  jesen_node_t *parent;
+  // children are kept in document order; prev/next link siblings.
+  jesen_node_t *prev;
+  jesen_node_t *next;
+  jesen_node_t *child;
+  jesen_node_t *last;
+  size_t count;
+  // memory the tree borrows keys and strings from; only ever set on a parsed
+  // root.
+  jesen_backing_t *backing;
+  // source of this node and of its owned key and string; NULL for malloc.
+  const jesen_allocator_t *allocator;
+  union {
+    bool boolean;
+    double number;
+    struct {
+      char *ptr;
+      size_t len;
+    } string;
+    // objects: key index once they reach JESEN_INDEX_MIN_MEMBERS members.
+    jesen_index_t *index;
+    // arrays: the children in order, built on the first indexed access past
+    // JESEN_ELEMENTS_MIN_INDEX; `items` is NULL until then.
+    struct {
+      jesen_node_t **items;
+      size_t cap;
+    } elements;
+  } value;
+};
+
+static void jesen_free(jesen_node_t *node);
+
+static jesen_node_t *jesen_node_alloc(const jesen_allocator_t *allocator,
+                                      jesen_type_t type) {
+  jesen_node_t *node = NULL;
+  if (!allocator) {
+    node = (jesen_node_t *)calloc(1, sizeof *node);
+  } else if ((node = (jesen_node_t *)jesen_alloc(allocator, sizeof *node))) {
+    memset(node, 0, sizeof *node);
+  }
+  if (node) {
+    node->type = type;
+    node->allocator = allocator;
+  }
+  return node;
+}
+
+static jesen_node_t *jesen_node_new(jesen_type_t type) {
+  return jesen_node_alloc(NULL, type);
+}
+
+static char *jesen_strndup(const jesen_allocator_t *allocator, const char *str,
+                           size_t len) {
+  char *copy = (char *)jesen_alloc(allocator, len + 1);
+  if (!copy) {
+    return NULL;
+  }
+  memcpy(copy, str, len);
+  copy[len] = '\0';
+  return copy;
+}
+
+static void jesen_release_key(jesen_node_t *node) {
+  if (!node->borrowed_key) {
+    jesen_release(node->allocator, node->key);
+  }
+  node->key = NULL;
+  node->borrowed_key = false;
+}
+
+// (Re)build the key index of `object` from its members. On failure the
+// object simply has no index and lookups scan its members.
+static void jesen_object_reindex(jesen_node_t *object) {
+  jesen_index_destroy(object->value.index);
+  object->value.index = jesen_index_create(object->allocator, object->count);
+  for (jesen_node_t *cur = object->child; cur && object->value.index;
+       cur = cur->next) {
+    if (!jesen_index_put(object->value.index, cur->key, cur, true)) {
+      jesen_index_destroy(object->value.index);
+      object->value.index = NULL;
+    }
+  }
+}
+
+static void jesen_array_drop_elements(jesen_node_t *array) {
+  jesen_release(array->allocator, array->value.elements.items);
+  array->value.elements.items = NULL;
+  array->value.elements.cap = 0;
+}
+
+// Build the element vector of `array`. On failure the array simply has no
+// vector and indexed access walks its children.
+static void jesen_array_build_elements(jesen_node_t *array) {
+  size_t cap = 16;
+  while (cap < array->count) {
+    cap *= 2;
+  }
+  jesen_node_t **items =
+      (jesen_node_t **)jesen_alloc(array->allocator, cap * sizeof *items);
+  if (!items) {
+    return;
+  }
+  size_t i = 0;
+  for (jesen_node_t *cur = array->child; cur; cur = cur->next) {
+    items[i++] = cur;
+  }
+  array->value.elements.items = items;
+  array->value.elements.cap = cap;
+}
+
+// Append `child` to the element vector of `array`, if it has one.
+static void jesen_array_push_element(jesen_node_t *array,
+                                     jesen_node_t *child) {
+  jesen_node_t **items = array->value.elements.items;
+  if (!items) {
+    return;
+  }
+  size_t count = array->count;
+  if (count == array->value.elements.cap) {
+    size_t cap = array->value.elements.cap * 2;
+    jesen_node_t **grown =
+        (jesen_node_t **)jesen_alloc(array->allocator, cap * sizeof *grown);
+    if (!grown) {
+      jesen_array_drop_elements(array);
+      return;
+    }
+    memcpy(grown, items, count * sizeof *items);
+    jesen_release(array->allocator, items);
+    array->value.elements.items = items = grown;
+    array->value.elements.cap = cap;
+  }
+  items[count] = child;
+}
+
+// Take `child` out of the element vector of `array`, if it has one.
+static void jesen_array_pull_element(jesen_node_t *array,
+                                     const jesen_node_t *child) {
+  jesen_node_t **items = array->value.elements.items;
+  if (!items) {
+    return;
+  }
+  // Search from the back: removing the last element is the common case.
+  size_t pos = array->count;
+  while (pos > 0 && items[pos - 1] != child) {
+    pos--;
+  }
+  if (pos > 0) {
+    memmove(&items[pos - 1], &items[pos],
+            (array->count - pos) * sizeof *items);
+  }
+}
+
+static void jesen_link_child(jesen_node_t *parent, jesen_node_t *child) {
+  if (parent->type == JESEN_TYPE_ARRAY) {
+    jesen_array_push_element(parent, child);
+  }
+  child->parent = parent;
+  child->prev = parent->last;
+  child->next = NULL;
+  if (parent->last) {
+    parent->last->next = child;
+  } else {
+    parent->child = child;
+  }
+  parent->last = child;
+  parent->count++;
+  if (parent->type != JESEN_TYPE_OBJECT) {
+    return;
+  }
+  if (parent->value.index) {
+    if (!jesen_index_put(parent->value.index, child->key, child, true)) {
+      jesen_index_destroy(parent->value.index);
+      parent->value.index = NULL;
+    }
+  } else if (parent->count >= JESEN_INDEX_MIN_MEMBERS) {
+    jesen_object_reindex(parent);
+  }
+}
+
+static void jesen_unlink_child(jesen_node_t *child) {
+  jesen_node_t *parent = child->parent;
+  bool reindex = parent->type == JESEN_TYPE_OBJECT && parent->value.index &&
+                 !jesen_index_remove(parent->value.index, child->key, child);
+  if (parent->type == JESEN_TYPE_ARRAY) {
+    jesen_array_pull_element(parent, child);
+  }
+  if (child->prev) {
+    child->prev->next = child->next;
+  } else {
+    parent->child = child->next;
+  }
+  if (child->next) {
+    child->next->prev = child->prev;
+  } else {
+    parent->last = child->prev;
+  }
+  parent->count--;
+  child->parent = NULL;
+  child->prev = NULL;
+  child->next = NULL;
+  if (reindex) {
+    jesen_object_reindex(parent);
+  }
+}
+
+// Duplicate keys resolve to the most recently added property, matching the
+// cJSON backend.
+static jesen_node_t *jesen_object_lookup(const jesen_node_t *object,
+                                         const char *key) {
+  if (object->value.index) {
+    return (jesen_node_t *)jesen_index_find(object->value.index, key);
+  }
+  for (jesen_node_t *cur = object->last; cur; cur = cur->prev) {
+    // Keys of an interned tree match an interned lookup key by address.
+    if (cur->key == key || (cur->key && strcmp(cur->key, key) == 0)) {
+      return cur;
+    }
+  }
+  return NULL;
+}
+
+static jesen_node_t *jesen_array_at(jesen_node_t *array, uint32_t index) {
+  if (index >= array->count) {
+    return NULL;
+  }
+  if (!array->value.elements.items && index >= JESEN_ELEMENTS_MIN_INDEX) {
+    jesen_array_build_elements(array);
+  }
+  if (array->value.elements.items) {
+    return array->value.elements.items[index];
+  }
+  jesen_node_t *cur = array->child;
+  for (uint32_t i = 0; i < index; ++i) {
+    cur = cur->next;
+  }
+  return cur;
+}
+
+static jesen_err_t jesen_object_attach(jesen_node_t *object, const char *key,
+                                       jesen_node_t *node) {
+  char *key_copy = jesen_strndup(node->allocator, key, strlen(key));
+  if (!key_copy) {
+    return JESEN_ERR_ALLOC;
+  }
+  jesen_release_key(node);
+  node->key = key_copy;
+  jesen_link_child(object, node);
+  return JESEN_ERR_NONE;
+}
+
+static jesen_err_t jesen_object_add_node(jesen_node_t *object, const char *key,
+                                         jesen_node_t *node) {
+  if (!node) {
+    return JESEN_ERR_ALLOC;
+  }
+  jesen_err_t err = jesen_object_attach(object, key, node);
+  if (err != JESEN_ERR_NONE) {
+    jesen_free(node);
+  }
+  return err;
+}
+
+static jesen_err_t jesen_array_add_node(jesen_node_t *array,
+                                        jesen_node_t *node) {
+  if (!node) {
+    return JESEN_ERR_ALLOC;
+  }
+  jesen_link_child(array, node);
+  return JESEN_ERR_NONE;
+}
+
+static jesen_node_t *jesen_number_new(const jesen_allocator_t *allocator,
+                                      double value) {
+  jesen_node_t *node = jesen_node_alloc(allocator, JESEN_TYPE_NUMBER);
+  if (node) {
+    node->value.number = value;
+  }
+  return node;
+}
+
+static jesen_node_t *jesen_bool_new(const jesen_allocator_t *allocator,
+                                    bool value) {
+  jesen_node_t *node = jesen_node_alloc(allocator, JESEN_TYPE_BOOL);
+  if (node) {
+    node->value.boolean = value;
+  }
+  return node;
+}
+
+static jesen_node_t *jesen_string_alloc(const jesen_allocator_t *allocator,
+                                        const char *value, size_t value_len) {
+  jesen_node_t *node = jesen_node_alloc(allocator, JESEN_TYPE_STRING);
+  if (!node) {
+    return NULL;
+  }
+  node->value.string.ptr = jesen_strndup(allocator, value, value_len);
+  if (!node->value.string.ptr) {
+    jesen_release(allocator, node);
+    return NULL;
+  }
+  node->value.string.len = value_len;
+  return node;
+}
+
+jesen_err_t jesen_object_create(jesen_node_t **out) {
+  if (!out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  jesen_node_t *created = jesen_node_new(JESEN_TYPE_OBJECT);
+  if (!created) {
+    return JESEN_ERR_ALLOC;
+  }
+
+  *out = created;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_object_create_to(jesen_node_t *parent, const char *name,
+                                   jesen_node_t **out) {
+  if (!out || !parent || !name) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (parent->type != JESEN_TYPE_OBJECT) {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+
+  jesen_node_t *created =
+      jesen_node_alloc(parent->allocator, JESEN_TYPE_OBJECT);
+  jesen_err_t err = jesen_object_add_node(parent, name, created);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+
+  *out = created;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_node_assign_to(jesen_node_t *parent, const char *name,
+                                 jesen_node_t *node) {
+  if (!parent || !name || !node) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (node->parent) {
+    return JESEN_ERR_ALREADY_ATTACHED;
+  }
+
+  if (jesen_allocator_foreign(parent->allocator, node->allocator)) {
+    return JESEN_ERR_NOT_OWNED;
+  }
+
+  if (parent->type == JESEN_TYPE_ARRAY) {
+    jesen_release_key(node);
+    jesen_link_child(parent, node);
+  } else if (parent->type == JESEN_TYPE_OBJECT) {
+    return jesen_object_attach(parent, name, node);
+  } else {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_array_create(jesen_node_t **out) {
+  if (!out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  jesen_node_t *created = jesen_node_new(JESEN_TYPE_ARRAY);
+  if (!created) {
+    return JESEN_ERR_ALLOC;
+  }
+
+  *out = created;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_array_create_to(jesen_node_t *parent, const char *name,
+                                  jesen_node_t **out) {
+  if (!parent || !name || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (parent->type != JESEN_TYPE_OBJECT) {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+
+  jesen_node_t *created =
+      jesen_node_alloc(parent->allocator, JESEN_TYPE_ARRAY);
+  jesen_err_t err = jesen_object_add_node(parent, name, created);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+
+  *out = created;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_object_add_double(jesen_node_t *node, const char *key,
+                                    double value) {
+  if (!node || !key) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (node->type != JESEN_TYPE_OBJECT) {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+
+  return jesen_object_add_node(node, key,
+                               jesen_number_new(node->allocator, value));
+}
+
+jesen_err_t jesen_object_add_int32(jesen_node_t *node, const char *key,
+                                   int32_t value) {
+  if (!node || !key) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (node->type != JESEN_TYPE_OBJECT) {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+
+  return jesen_object_add_node(
+      node, key, jesen_number_new(node->allocator, (double)value));
+}
+
+jesen_err_t jesen_object_add_bool(jesen_node_t *node, const char *key,
+                                  bool value) {
+  if (!node || !key) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (node->type != JESEN_TYPE_OBJECT) {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+
+  return jesen_object_add_node(node, key,
+                               jesen_bool_new(node->allocator, value));
+}
+
+jesen_err_t jesen_object_add_null(jesen_node_t *node, const char *key) {
+  if (!node || !key) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (node->type != JESEN_TYPE_OBJECT) {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+
+  return jesen_object_add_node(
+      node, key, jesen_node_alloc(node->allocator, JESEN_TYPE_NULL));
+}
+
+jesen_err_t jesen_object_add_string(jesen_node_t *node, const char *key,
+                                    const char *value, size_t value_len) {
+  if (!node || !key || !value) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (node->type != JESEN_TYPE_OBJECT) {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+
+  return jesen_object_add_node(
+      node, key, jesen_string_alloc(node->allocator, value, value_len));
+}
+
+jesen_err_t jesen_object_remove(jesen_node_t *node, const char *key) {
+  if (!node || !key) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (node->type != JESEN_TYPE_OBJECT) {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+
+  jesen_node_t *target = jesen_object_lookup(node, key);
+  if (!target) {
+    return JESEN_ERR_NOT_FOUND;
+  }
+
+  jesen_unlink_child(target);
+  jesen_free(target);
+
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_array_add_double(jesen_node_t *array, double value) {
+  if (!array) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (array->type != JESEN_TYPE_ARRAY) {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+
+  return jesen_array_add_node(array,
+                              jesen_number_new(array->allocator, value));
+}
+
+jesen_err_t jesen_array_add_int32(jesen_node_t *array, int32_t value) {
+  if (!array) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (array->type != JESEN_TYPE_ARRAY) {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+
+  return jesen_array_add_node(
+      array, jesen_number_new(array->allocator, (double)value));
+}
+
+jesen_err_t jesen_array_add_bool(jesen_node_t *array, bool value) {
+  if (!array) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (array->type != JESEN_TYPE_ARRAY) {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+
+  return jesen_array_add_node(array,
+                              jesen_bool_new(array->allocator, value));
+}
+
+jesen_err_t jesen_array_add_string(jesen_node_t *array, const char *value,
+                                   size_t value_len) {
+  if (!array || !value) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (array->type != JESEN_TYPE_ARRAY) {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+
+  return jesen_array_add_node(
+      array, jesen_string_alloc(array->allocator, value, value_len));
+}
+
+jesen_err_t jesen_array_get_value(jesen_node_t *array, uint32_t index,
+                                  jesen_node_t **out) {
+  if (!array || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (array->type != JESEN_TYPE_ARRAY) {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+
+  jesen_node_t *item = jesen_array_at(array, index);
+  if (!item) {
+    return JESEN_ERR_OUT_OF_RANGE;
+  }
+
+  *out = item;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_array_set_value(jesen_node_t *array, uint32_t index,
+                                  jesen_node_t *value) {
+  if (!array || !value) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (value->parent) {
+    return JESEN_ERR_ALREADY_ATTACHED;
+  }
+
+  if (jesen_allocator_foreign(array->allocator, value->allocator)) {
+    return JESEN_ERR_NOT_OWNED;
+  }
+
+  if (array->type != JESEN_TYPE_ARRAY) {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+
+  jesen_node_t *existing = jesen_array_at(array, index);
+  if (!existing) {
+    return JESEN_ERR_OUT_OF_RANGE;
+  }
+
+  jesen_release_key(value);
+  value->parent = array;
+  value->prev = existing->prev;
+  value->next = existing->next;
+  if (existing->prev) {
+    existing->prev->next = value;
+  } else {
+    array->child = value;
+  }
+  if (existing->next) {
+    existing->next->prev = value;
+  } else {
+    array->last = value;
+  }
+
+  if (array->value.elements.items) {
+    array->value.elements.items[index] = value;
+  }
+
+  existing->parent = NULL;
+  existing->prev = NULL;
+  existing->next = NULL;
+  jesen_free(existing);
+
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_array_remove(jesen_node_t *array, uint32_t index) {
+  if (!array) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (array->type != JESEN_TYPE_ARRAY) {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+
+  jesen_node_t *item = jesen_array_at(array, index);
+  if (!item) {
+    return JESEN_ERR_OUT_OF_RANGE;
+  }
+
+  jesen_unlink_child(item);
+  jesen_free(item);
+
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_node_find(const jesen_node_t *node, const char *key,
+                            jesen_node_t **out) {
+  if (!node || !key || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (node->type != JESEN_TYPE_OBJECT) {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+
+  jesen_node_t *found = jesen_object_lookup(node, key);
+  if (!found) {
+    return JESEN_ERR_NOT_FOUND;
+  }
+
+  *out = found;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_value_get_string(const jesen_node_t *node, char *out,
+                                   size_t out_max, size_t *out_len) {
+  if (!node || !out || out_max == 0) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (node->type != JESEN_TYPE_STRING) {
+    return JESEN_ERR_INVALID_VALUE_TYPE;
+  }
+
+  size_t len = node->value.string.len;
+  if (len + 1 > out_max) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  memcpy(out, node->value.string.ptr, len);
+  out[len] = '\0';
+  if (out_len) {
+    *out_len = len;
+  }
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_value_get_string_ref(const jesen_node_t *node,
+                                       const char **out, size_t *out_len) {
+  if (!node || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (node->type != JESEN_TYPE_STRING) {
+    return JESEN_ERR_INVALID_VALUE_TYPE;
+  }
+
+  *out = node->value.string.ptr;
+  if (out_len) {
+    *out_len = node->value.string.len;
+  }
+  return JESEN_ERR_NONE;
+}
+
+// Saturating conversion with the same rules cJSON applies to valueint.
+static int32_t jesen_double_to_int32(double value) {
+  if (value >= (double)INT32_MAX) {
+    return INT32_MAX;
+  }
+  if (value <= (double)INT32_MIN) {
+    return INT32_MIN;
+  }
+  if (isnan(value)) {
+    return 0;
+  }
+  return (int32_t)value;
+}
+
+jesen_err_t jesen_value_get_int32(const jesen_node_t *node, int32_t *out) {
+  if (!node || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (node->type != JESEN_TYPE_NUMBER) {
+    return JESEN_ERR_INVALID_VALUE_TYPE;
+  }
+
+  *out = jesen_double_to_int32(node->value.number);
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_value_get_double(const jesen_node_t *node, double *out) {
+  if (!node || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (node->type != JESEN_TYPE_NUMBER) {
+    return JESEN_ERR_INVALID_VALUE_TYPE;
+  }
+
+  *out = node->value.number;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_value_get_bool(const jesen_node_t *node, bool *out) {
+  if (!node || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (node->type != JESEN_TYPE_BOOL) {
+    return JESEN_ERR_INVALID_VALUE_TYPE;
+  }
+
+  *out = node->value.boolean;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_value_is_null(const jesen_node_t *node, bool *out) {
+  if (!node || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  *out = node->type == JESEN_TYPE_NULL;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_value_is_int32(const jesen_node_t *node, bool *out) {
+  if (!node || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  *out = node->type == JESEN_TYPE_NUMBER;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_value_is_bool(const jesen_node_t *node, bool *out) {
+  if (!node || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  *out = node->type == JESEN_TYPE_BOOL;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_value_is_double(const jesen_node_t *node, bool *out) {
+  if (!node || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  *out = node->type == JESEN_TYPE_NUMBER;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_value_is_string(const jesen_node_t *node, bool *out) {
+  if (!node || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  *out = node->type == JESEN_TYPE_STRING;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_value_is_array(const jesen_node_t *node, bool *out) {
+  if (!node || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  *out = node->type == JESEN_TYPE_ARRAY;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_value_is_object(const jesen_node_t *node, bool *out) {
+  if (!node || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  *out = node->type == JESEN_TYPE_OBJECT;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_node_get_parent(const jesen_node_t *node,
+                                  jesen_node_t **out_parent) {
+  if (!node || !out_parent) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  *out_parent = node->parent;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_node_detach(jesen_node_t *node) {
+  if (!node || !node->parent) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  jesen_unlink_child(node);
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_array_size(const jesen_node_t *array, size_t *out_size) {
+  if (!array || !out_size) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (array->type != JESEN_TYPE_ARRAY) {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+
+  *out_size = array->count;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_object_size(const jesen_node_t *object, size_t *out_size) {
+  if (!object || !out_size) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (object->type != JESEN_TYPE_OBJECT) {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+
+  *out_size = object->count;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_iter_begin(jesen_node_t *node, jesen_iter_t *out) {
+  if (!node || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (node->type != JESEN_TYPE_ARRAY && node->type != JESEN_TYPE_OBJECT) {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+
+  out->node = node;
+  out->next = node->child;
+  out->index = 0;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_iter_next(jesen_iter_t *it, const char **key,
+                            size_t *key_len, jesen_node_t **child) {
+  if (!it || !it->node || !child) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  jesen_node_t *cur = it->next;
+  if (!cur) {
+    return JESEN_ERR_NOT_FOUND;
+  }
+  it->next = cur->next;
+  it->index++;
+
+  if (key) {
+    *key = cur->key;
+  }
+  if (key_len) {
+    *key_len = cur->key ? strlen(cur->key) : 0;
+  }
+  *child = cur;
+  return JESEN_ERR_NONE;
+}
+
+// Write a scalar node, or just the opening bracket of a container.
+static bool jesen_write_open(jesen_writer_t *w, const jesen_node_t *node) {
+  switch (node->type) {
+  case JESEN_TYPE_NULL:
+    return jesen_writer_put(w, "null", 4);
+  case JESEN_TYPE_BOOL:
+    return node->value.boolean ? jesen_writer_put(w, "true", 4)
+                               : jesen_writer_put(w, "false", 5);
+  case JESEN_TYPE_NUMBER:
+    return jesen_writer_number(w, node->value.number);
+  case JESEN_TYPE_STRING:
+    return jesen_writer_string(w, node->value.string.ptr,
+                               node->value.string.len);
+  case JESEN_TYPE_ARRAY:
+    return jesen_writer_put(w, "[", 1);
+  case JESEN_TYPE_OBJECT:
+    return jesen_writer_put(w, "{", 1);
+  }
+  return false;
+}
+
+static bool jesen_write_close(jesen_writer_t *w, const jesen_node_t *node) {
+  return jesen_writer_put(w, node->type == JESEN_TYPE_OBJECT ? "}" : "]", 1);
+}
+
+// Depth-first walk over parent links, so nesting depth costs no C stack.
+static bool jesen_write_value(jesen_writer_t *w, const jesen_node_t *root) {
+  const jesen_node_t *node = root;
+  for (;;) {
+    if (node != root && node->parent->type == JESEN_TYPE_OBJECT) {
+      const char *key = node->key ? node->key : "";
+      if (!jesen_writer_string(w, key, strlen(key)) ||
+          !jesen_writer_put(w, ":", 1)) {
+        return false;
+      }
+    }
+    if (!jesen_write_open(w, node)) {
+      return false;
+    }
+    if (node->type == JESEN_TYPE_ARRAY || node->type == JESEN_TYPE_OBJECT) {
+      if (node->child) {
+        node = node->child;
+        continue;
+      }
+      if (!jesen_write_close(w, node)) {
+        return false;
+      }
+    }
+
+    // Close every container this node was the last child of.
+    while (node != root && !node->next) {
+      node = node->parent;
+      if (!jesen_write_close(w, node)) {
+        return false;
+      }
+    }
+    if (node == root) {
+      return true;
+    }
+    if (!jesen_writer_put(w, ",", 1)) {
+      return false;
+    }
+    node = node->next;
+  }
+}
+
+jesen_err_t jesen_serialize(const jesen_node_t *node, char *out_buf,
+                            size_t out_buf_len) {
+  if (!node || !out_buf || out_buf_len == 0) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  jesen_writer_t w = {out_buf, out_buf_len, 0};
+  if (!jesen_write_value(&w, node)) {
+    return JESEN_ERR_BUFFER_TOO_SMALL;
+  }
+  out_buf[w.len] = '\0';
+
+  return JESEN_ERR_NONE;
+}
+
+// Builder state while the parser replays a document: `current` is the
+// innermost open container and `pending_key` the name for its next child.
+// With `borrow` set, keys and strings point into the caller's buffer; with
+// `intern` set, keys point into that pool.
+typedef struct {
+  jesen_node_t *root;
+  jesen_node_t *current;
+  char *pending_key;
+  bool borrow;
+  jesen_intern_t *intern;
+  // keys are not owned by the nodes (borrowed or interned).
+  bool borrow_keys;
+  const jesen_allocator_t *allocator;
+  jesen_duplicate_policy_t duplicates;
+  jesen_dedupe_t dedupe;
+} jesen_tree_builder_t;
+
+static jesen_err_t jesen_tree_add(jesen_tree_builder_t *t,
+                                  jesen_node_t *node) {
+  if (!node) {
+    return JESEN_ERR_ALLOC;
+  }
+  if (!t->current) {
+    t->root = node;
+  } else {
+    node->key = t->pending_key;
+    node->borrowed_key = t->borrow_keys;
+    t->pending_key = NULL;
+    jesen_link_child(t->current, node);
+  }
+  return JESEN_ERR_NONE;
+}
+
+static jesen_err_t jesen_tree_begin(void *ctx, jesen_type_t type) {
+  jesen_tree_builder_t *t = (jesen_tree_builder_t *)ctx;
+  jesen_node_t *node = jesen_node_alloc(t->allocator, type);
+  jesen_err_t err = jesen_tree_add(t, node);
+  if (err == JESEN_ERR_NONE) {
+    t->current = node;
+  }
+  return err;
+}
+
+static jesen_err_t jesen_tree_begin_object(void *ctx) {
+  return jesen_tree_begin(ctx, JESEN_TYPE_OBJECT);
+}
+
+static jesen_err_t jesen_tree_begin_array(void *ctx) {
+  return jesen_tree_begin(ctx, JESEN_TYPE_ARRAY);
+}
+
+static jesen_err_t jesen_tree_end(void *ctx) {
+  jesen_tree_builder_t *t = (jesen_tree_builder_t *)ctx;
+  t->current = t->current->parent;
+  return JESEN_ERR_NONE;
+}
+
+// Apply the duplicate-key policy to the object being closed.
+static jesen_err_t jesen_tree_end_object(void *ctx) {
+  jesen_tree_builder_t *t = (jesen_tree_builder_t *)ctx;
+  jesen_node_t *object = t->current;
+  if (t->duplicates == JESEN_DUPLICATE_KEEP_ALL || object->count < 2) {
+    return jesen_tree_end(ctx);
+  }
+
+  jesen_err_t err = jesen_dedupe_reserve(&t->dedupe, object->count);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  size_t count = 0;
+  for (jesen_node_t *cur = object->child; cur; cur = cur->next) {
+    t->dedupe.keys[count++] = cur->key;
+  }
+  if ((err = jesen_dedupe_run(&t->dedupe, count, t->duplicates)) !=
+      JESEN_ERR_NONE) {
+    return err;
+  }
+  // Drop the key index while members go, rather than rebuilding it as each
+  // duplicate is removed.
+  jesen_index_destroy(object->value.index);
+  object->value.index = NULL;
+  size_t i = 0;
+  for (jesen_node_t *cur = object->child, *next; cur; cur = next, ++i) {
+    next = cur->next;
+    if (t->dedupe.drop[i]) {
+      jesen_unlink_child(cur);
+      jesen_free(cur);
+    }
+  }
+  if (object->count >= JESEN_INDEX_MIN_MEMBERS) {
+    jesen_object_reindex(object);
+  }
+  return jesen_tree_end(ctx);
+}
+
+static jesen_err_t jesen_tree_key(void *ctx, const char *key, size_t len) {
+  jesen_tree_builder_t *t = (jesen_tree_builder_t *)ctx;
+  if (t->intern) {
+    t->pending_key = (char *)jesen_intern_get(t->intern, key, len);
+    return t->pending_key ? JESEN_ERR_NONE : JESEN_ERR_ALLOC;
+  }
+  if (t->borrow) {
+    t->pending_key = (char *)key;
+    return JESEN_ERR_NONE;
+  }
+  t->pending_key = jesen_strndup(t->allocator, key, len);
+  return t->pending_key ? JESEN_ERR_NONE : JESEN_ERR_ALLOC;
+}
+
+static jesen_err_t jesen_tree_string(void *ctx, const char *str, size_t len) {
+  jesen_tree_builder_t *t = (jesen_tree_builder_t *)ctx;
+  if (!t->borrow) {
+    return jesen_tree_add(t, jesen_string_alloc(t->allocator, str, len));
+  }
+  jesen_node_t *node = jesen_node_alloc(t->allocator, JESEN_TYPE_STRING);
+  if (node) {
+    node->value.string.ptr = (char *)str;
+    node->value.string.len = len;
+    node->borrowed_string = true;
+  }
+  return jesen_tree_add(t, node);
+}
+
+static jesen_err_t jesen_tree_number(void *ctx, const char *raw, size_t len) {
+  jesen_tree_builder_t *t = (jesen_tree_builder_t *)ctx;
+  double value = 0.0;
+  jesen_err_t err = jesen_number_to_double(raw, len, &value);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  jesen_node_t *node = jesen_node_alloc(t->allocator, JESEN_TYPE_NUMBER);
+  if (node) {
+    node->value.number = value;
+  }
+  return jesen_tree_add(t, node);
+}
+
+static jesen_err_t jesen_tree_boolean(void *ctx, bool value) {
+  jesen_tree_builder_t *t = (jesen_tree_builder_t *)ctx;
+  jesen_node_t *node = jesen_node_alloc(t->allocator, JESEN_TYPE_BOOL);
+  if (node) {
+    node->value.boolean = value;
+  }
+  return jesen_tree_add(t, node);
+}
+
+static jesen_err_t jesen_tree_null(void *ctx) {
+  jesen_tree_builder_t *t = (jesen_tree_builder_t *)ctx;
+  return jesen_tree_add(t, jesen_node_alloc(t->allocator, JESEN_TYPE_NULL));
+}
+
+const jesen_builder_t jesen_backend_builder = {
+    jesen_tree_begin_object, jesen_tree_end_object, jesen_tree_begin_array,
+    jesen_tree_end,          jesen_tree_key,        jesen_tree_string,
+    jesen_tree_number,       jesen_tree_boolean,    jesen_tree_null,
+};
+
+// Every node is a handle already, so JESEN_PARSE_EAGER_WRAPPERS has nothing
+// to do here.
+jesen_err_t jesen_backend_builder_create(bool borrow,
+                                         const jesen_parse_opts_t *opts,
+                                         void **out_ctx) {
+  const jesen_allocator_t *allocator = opts ? opts->allocator : NULL;
+  jesen_tree_builder_t *t =
+      (jesen_tree_builder_t *)jesen_alloc(allocator, sizeof *t);
+  if (!t) {
+    return JESEN_ERR_ALLOC;
+  }
+  memset(t, 0, sizeof *t);
+  t->borrow = borrow;
+  t->intern = opts ? opts->intern : NULL;
+  t->borrow_keys = borrow || t->intern;
+  t->allocator = allocator;
+  t->duplicates = opts ? opts->duplicates : JESEN_DUPLICATE_KEEP_ALL;
+  t->dedupe.allocator = allocator;
+  *out_ctx = t;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_backend_builder_finish(void *ctx, jesen_err_t err,
+                                         jesen_node_t **out) {
+  jesen_tree_builder_t *t = (jesen_tree_builder_t *)ctx;
+  jesen_node_t *root = t->root;
+  if (!t->borrow_keys) {
+    jesen_release(t->allocator, t->pending_key);
+  }
+  jesen_dedupe_free(&t->dedupe);
+  jesen_release(t->allocator, t);
+  if (err != JESEN_ERR_NONE) {
+    jesen_free(root);
+    return err;
+  }
+
+  *out = root;
+  return JESEN_ERR_NONE;
+}
+
+// Free an unlinked node and its subtree. Each node's children are spliced
+// into the chain right after it before it is freed, so the walk needs
+// neither recursion nor extra memory.
+static void jesen_free(jesen_node_t *node) {
+  if (!node) {
+    return;
+  }
+
+  node->next = NULL;
+  while (node) {
+    if (node->child) {
+      node->last->next = node->next;
+      node->next = node->child;
+    }
+
+    jesen_node_t *next = node->next;
+    if (node->type == JESEN_TYPE_STRING && !node->borrowed_string) {
+      jesen_release(node->allocator, node->value.string.ptr);
+    } else if (node->type == JESEN_TYPE_OBJECT) {
+      jesen_index_destroy(node->value.index);
+    } else if (node->type == JESEN_TYPE_ARRAY) {
+      jesen_array_drop_elements(node);
+    }
+    jesen_release_key(node);
+    while (node->backing) {
+      jesen_backing_t *backing = node->backing;
+      node->backing = backing->next;
+      backing->release(backing);
+    }
+    jesen_release(node->allocator, node);
+    node = next;
+  }
+}
+
+void jesen_backend_set_backing(jesen_node_t *root, jesen_backing_t *backing) {
+  backing->next = root->backing;
+  root->backing = backing;
+}
+
+void jesen_backend_array_splice(jesen_node_t *dst, jesen_node_t *src) {
+  jesen_array_drop_elements(dst);
+  jesen_node_t *moved = src->child;
+  for (jesen_node_t *child = moved; child; child = child->next) {
+    child->parent = dst;
+  }
+  if (moved) {
+    if (dst->last) {
+      dst->last->next = moved;
+      moved->prev = dst->last;
+    } else {
+      dst->child = moved;
+    }
+    dst->last = src->last;
+    dst->count += src->count;
+  }
+  src->child = NULL;
+  src->last = NULL;
+  src->count = 0;
+  jesen_free(src);
+}
+
+jesen_err_t jesen_destroy(jesen_node_t *node) {
+  if (!node) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (node->parent) {
+    jesen_unlink_child(node);
+  }
+  jesen_free(node);
+  return JESEN_ERR_NONE;
+}
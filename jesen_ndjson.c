@@ -0,0 +1,200 @@
+#include "jesen_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// NDJSON / JSON Lines batch parsing. Raw newlines cannot appear inside a JSON
+// string, so every '\n' ends a record and the input can be cut into chunks at
+// newlines without looking at the JSON. Work runs in two passes over those
+// chunks: the first counts the records in each chunk (so every record knows
+// its global index up front), the second parses them. Each chunk is one task
+// for the shared thread pool.
+
+// Chunks per thread; more chunks balance better, fewer cost less to claim.
+#define JESEN_NDJSON_CHUNKS_PER_THREAD 8
+// Inputs are not split finer than this; tiny chunks are not worth a claim.
+#define JESEN_NDJSON_MIN_CHUNK (64 * 1024)
+
+typedef struct {
+  const char *begin;
+  const char *end;
+  // global index of the first record in this chunk.
+  size_t first;
+  size_t count;
+} jesen_ndjson_chunk_t;
+
+typedef struct {
+  jesen_ndjson_chunk_t *chunks;
+  size_t chunk_count;
+  // 0 = count records, 1 = parse them.
+  int pass;
+  jesen_node_t **roots;
+  jesen_ndjson_record_fn fn;
+  void *ctx;
+} jesen_ndjson_job_t;
+
+static bool jesen_ndjson_is_blank(const char *line, const char *end) {
+  for (; line < end; ++line) {
+    if (*line != ' ' && *line != '\t' && *line != '\r') {
+      return false;
+    }
+  }
+  return true;
+}
+
+static jesen_err_t jesen_ndjson_chunk(void *ctx, size_t task) {
+  jesen_ndjson_job_t *job = (jesen_ndjson_job_t *)ctx;
+  jesen_ndjson_chunk_t *chunk = &job->chunks[task];
+  size_t index = chunk->first;
+  const char *line = chunk->begin;
+
+  while (line < chunk->end) {
+    const char *nl =
+        (const char *)memchr(line, '\n', (size_t)(chunk->end - line));
+    const char *line_end = nl ? nl : chunk->end;
+
+    if (!jesen_ndjson_is_blank(line, line_end)) {
+      if (job->pass == 0) {
+        chunk->count++;
+      } else {
+        jesen_node_t *root = NULL;
+        jesen_err_t err =
+            jesen_parse(line, (size_t)(line_end - line), &root);
+        if (err != JESEN_ERR_NONE) {
+          return err;
+        }
+        if (job->roots) {
+          job->roots[index] = root;
+        } else if ((err = job->fn(job->ctx, index, root)) != JESEN_ERR_NONE) {
+          return err;
+        }
+        index++;
+      }
+    }
+    line = line_end + 1;
+  }
+  return JESEN_ERR_NONE;
+}
+
+// Split `buf` into chunks that each end just after a newline (or at the end).
+static jesen_err_t jesen_ndjson_split(const char *buf, size_t buf_len,
+                                      size_t threads,
+                                      jesen_ndjson_chunk_t **out_chunks,
+                                      size_t *out_count) {
+  size_t count = threads * JESEN_NDJSON_CHUNKS_PER_THREAD;
+  if (count > buf_len / JESEN_NDJSON_MIN_CHUNK) {
+    count = buf_len / JESEN_NDJSON_MIN_CHUNK;
+  }
+  if (count == 0) {
+    count = 1;
+  }
+
+  jesen_ndjson_chunk_t *chunks =
+      (jesen_ndjson_chunk_t *)calloc(count, sizeof *chunks);
+  if (!chunks) {
+    return JESEN_ERR_ALLOC;
+  }
+
+  const char *end = buf + buf_len;
+  const char *begin = buf;
+  for (size_t i = 0; i < count; ++i) {
+    const char *cut = buf + (buf_len / count) * (i + 1);
+    if (i + 1 == count || cut <= begin) {
+      cut = i + 1 == count ? end : begin;
+    } else {
+      const char *nl = (const char *)memchr(cut, '\n', (size_t)(end - cut));
+      cut = nl ? nl + 1 : end;
+    }
+    chunks[i].begin = begin;
+    chunks[i].end = cut;
+    begin = cut;
+  }
+
+  *out_chunks = chunks;
+  *out_count = count;
+  return JESEN_ERR_NONE;
+}
+
+// Shared driver: parse into `roots` when set (allocated here), else hand each
+// record to `fn`.
+static jesen_err_t jesen_ndjson_parse(const char *buf, size_t buf_len,
+                                      size_t threads, jesen_node_t ***roots,
+                                      size_t *out_count,
+                                      jesen_ndjson_record_fn fn, void *ctx) {
+  threads = jesen_thread_count(threads);
+
+  jesen_ndjson_job_t job;
+  memset(&job, 0, sizeof job);
+  job.fn = fn;
+  job.ctx = ctx;
+  jesen_err_t err =
+      jesen_ndjson_split(buf, buf_len, threads, &job.chunks, &job.chunk_count);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+
+  // Counting cannot fail.
+  jesen_run_tasks(threads, job.chunk_count, jesen_ndjson_chunk, &job);
+  size_t total = 0;
+  for (size_t i = 0; i < job.chunk_count; ++i) {
+    job.chunks[i].first = total;
+    total += job.chunks[i].count;
+  }
+
+  if (roots) {
+    // calloc so a failed parse can free whatever was filled in.
+    job.roots = (jesen_node_t **)calloc(total ? total : 1, sizeof *job.roots);
+    if (!job.roots) {
+      free(job.chunks);
+      return JESEN_ERR_ALLOC;
+    }
+  }
+
+  job.pass = 1;
+  err = jesen_run_tasks(threads, job.chunk_count, jesen_ndjson_chunk, &job);
+  free(job.chunks);
+
+  if (err != JESEN_ERR_NONE) {
+    if (roots) {
+      jesen_roots_destroy(job.roots, total);
+    }
+    return err;
+  }
+  if (roots) {
+    *roots = job.roots;
+  }
+  if (out_count) {
+    *out_count = total;
+  }
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_parse_ndjson(const char *buf, size_t buf_len, size_t threads,
+                               jesen_node_t ***out_roots, size_t *out_count) {
+  if (!buf || !out_roots || !out_count) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  return jesen_ndjson_parse(buf, buf_len, threads, out_roots, out_count, NULL,
+                            NULL);
+}
+
+jesen_err_t jesen_parse_ndjson_each(const char *buf, size_t buf_len,
+                                    size_t threads, jesen_ndjson_record_fn fn,
+                                    void *ctx) {
+  if (!buf || !fn) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  return jesen_ndjson_parse(buf, buf_len, threads, NULL, NULL, fn, ctx);
+}
+
+jesen_err_t jesen_roots_destroy(jesen_node_t **roots, size_t count) {
+  if (!roots) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    if (roots[i]) {
+      jesen_destroy(roots[i]);
+    }
+  }
+  free(roots);
+  return JESEN_ERR_NONE;
+}
@@ -0,0 +1,101 @@
+#include "jesen_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Support code for jesen_parse_opts_t shared by the parser and both backends:
+// routing allocations through a caller's allocator, hashing keys and
+// resolving repeated object keys.
+
+void *jesen_alloc(const jesen_allocator_t *allocator, size_t size) {
+  return allocator ? allocator->alloc(allocator->ctx, size) : malloc(size);
+}
+
+void jesen_release(const jesen_allocator_t *allocator, void *ptr) {
+  if (!ptr) {
+    return;
+  }
+  if (allocator) {
+    allocator->release(allocator->ctx, ptr);
+  } else {
+    free(ptr);
+  }
+}
+
+jesen_err_t jesen_dedupe_reserve(jesen_dedupe_t *d, size_t count) {
+  // Contents are rebuilt for every object, so growing need not copy.
+  if (count > d->cap) {
+    size_t cap = d->cap ? d->cap : 16;
+    while (cap < count) {
+      cap *= 2;
+    }
+    jesen_release(d->allocator, (void *)d->keys);
+    jesen_release(d->allocator, d->drop);
+    d->keys = (const char **)jesen_alloc(d->allocator, cap * sizeof *d->keys);
+    d->drop = (bool *)jesen_alloc(d->allocator, cap * sizeof *d->drop);
+    d->cap = d->keys && d->drop ? cap : 0;
+    if (!d->cap) {
+      return JESEN_ERR_ALLOC;
+    }
+  }
+  // Keep the table at most half full.
+  if (count * 2 > d->slot_cap) {
+    size_t cap = d->slot_cap ? d->slot_cap : 32;
+    while (cap < count * 2) {
+      cap *= 2;
+    }
+    jesen_release(d->allocator, d->slots);
+    d->slots = (size_t *)jesen_alloc(d->allocator, cap * sizeof *d->slots);
+    d->slot_cap = d->slots ? cap : 0;
+    if (!d->slots) {
+      return JESEN_ERR_ALLOC;
+    }
+  }
+  return JESEN_ERR_NONE;
+}
+
+size_t jesen_hash(const char *key, size_t len) {
+  // FNV-1a.
+  uint64_t h = 0xcbf29ce484222325u;
+  for (size_t i = 0; i < len; ++i) {
+    h = (h ^ (unsigned char)key[i]) * 0x100000001b3u;
+  }
+  return (size_t)h;
+}
+
+jesen_err_t jesen_dedupe_run(jesen_dedupe_t *d, size_t count,
+                             jesen_duplicate_policy_t policy) {
+  size_t mask = d->slot_cap - 1;
+  memset(d->drop, 0, count * sizeof *d->drop);
+  memset(d->slots, 0, d->slot_cap * sizeof *d->slots);
+
+  // Members are visited in the order the survivors win: first to last, or
+  // last to first under JESEN_DUPLICATE_LAST.
+  for (size_t n = 0; n < count; ++n) {
+    size_t i = policy == JESEN_DUPLICATE_LAST ? count - 1 - n : n;
+    size_t slot = jesen_hash(d->keys[i], strlen(d->keys[i])) & mask;
+    for (; d->slots[slot]; slot = (slot + 1) & mask) {
+      if (strcmp(d->keys[d->slots[slot] - 1], d->keys[i]) == 0) {
+        if (policy == JESEN_DUPLICATE_ERROR) {
+          return JESEN_ERR_DUPLICATE_KEY;
+        }
+        d->drop[i] = true;
+        break;
+      }
+    }
+    if (!d->drop[i]) {
+      d->slots[slot] = i + 1;
+    }
+  }
+  return JESEN_ERR_NONE;
+}
+
+void jesen_dedupe_free(jesen_dedupe_t *d) {
+  jesen_release(d->allocator, (void *)d->keys);
+  jesen_release(d->allocator, d->drop);
+  jesen_release(d->allocator, d->slots);
+  d->keys = NULL;
+  d->drop = NULL;
+  d->slots = NULL;
+  d->cap = 0;
+  d->slot_cap = 0;
+}
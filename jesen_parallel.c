@@ -0,0 +1,265 @@
+#include "jesen_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Parallel parsing of one large top-level array. The array body is cut into
+// byte ranges and scanned twice in parallel: the first pass counts unescaped
+// quotes so every range knows whether it starts inside a string, the second
+// tracks bracket depth so every range can report its first comma that sits
+// directly inside the top-level array. Those commas split the body into
+// slices of whole elements, which are parsed in parallel and spliced back in
+// order. Each slice is fully validated, so a successful parse accepts exactly
+// what jesen_parse accepts; on any failure the whole input is re-parsed
+// sequentially so errors match too.
+
+// Ranges per thread for the scan passes; the slices follow the same cuts.
+#define JESEN_PARALLEL_CHUNKS_PER_THREAD 4
+// Bodies are not split finer than this; smaller inputs parse sequentially.
+#define JESEN_PARALLEL_MIN_CHUNK (256 * 1024)
+
+typedef struct {
+  const char *begin;
+  const char *end;
+  // first byte is escaped by a backslash run ending the previous chunk.
+  bool escaped;
+  bool in_string;
+  // odd number of unescaped quotes in the chunk.
+  bool odd_quotes;
+  // bracket depth change across the chunk and its lowest point.
+  long delta;
+  long min_depth;
+  // first comma at `min_depth`, or NULL.
+  const char *comma;
+} jesen_parallel_chunk_t;
+
+typedef struct {
+  jesen_parallel_chunk_t *chunks;
+  // 0 = count quotes, 1 = track depth, 2 = parse slices.
+  int pass;
+  // slice s spans [cuts[s], cuts[s + 1]); separators sit just before cuts.
+  const char **cuts;
+  jesen_node_t **roots;
+} jesen_parallel_job_t;
+
+static bool jesen_parallel_is_ws(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static void jesen_parallel_count_quotes(jesen_parallel_chunk_t *chunk) {
+  // Quotes are reported whether or not the scanner thinks it is in a string,
+  // so the initial string state does not matter here.
+  jesen_scanner_t scanner;
+  jesen_scanner_resume(&scanner, chunk->begin,
+                       (size_t)(chunk->end - chunk->begin), false,
+                       chunk->escaped);
+  size_t at;
+  bool odd = false;
+  while (jesen_scanner_next(&scanner, &at)) {
+    if (chunk->begin[at] == '\"') {
+      odd = !odd;
+    }
+  }
+  chunk->odd_quotes = odd;
+}
+
+static void jesen_parallel_track_depth(jesen_parallel_chunk_t *chunk) {
+  jesen_scanner_t scanner;
+  jesen_scanner_resume(&scanner, chunk->begin,
+                       (size_t)(chunk->end - chunk->begin), chunk->in_string,
+                       chunk->escaped);
+  size_t at;
+  long depth = 0;
+  long min_depth = 0;
+  const char *comma = NULL;
+  while (jesen_scanner_next(&scanner, &at)) {
+    switch (chunk->begin[at]) {
+    case '[':
+    case '{':
+      depth++;
+      break;
+    case ']':
+    case '}':
+      if (--depth < min_depth) {
+        min_depth = depth;
+        comma = NULL;
+      }
+      break;
+    case ',':
+      if (depth == min_depth && !comma) {
+        comma = chunk->begin + at;
+      }
+      break;
+    default:
+      break;
+    }
+  }
+  chunk->delta = depth;
+  chunk->min_depth = min_depth;
+  chunk->comma = comma;
+}
+
+static jesen_err_t jesen_parallel_slice(jesen_parallel_job_t *job, size_t s) {
+  const char *begin = job->cuts[s];
+  // Drop the separating comma in front of the next slice.
+  const char *end = job->cuts[s + 1] - 1;
+
+  void *ctx = NULL;
+  jesen_err_t err = jesen_backend_builder_create(false, NULL, &ctx);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  err = jesen_backend_builder.begin_array(ctx);
+  if (err == JESEN_ERR_NONE) {
+    err = jesen_parse_elements_with_builder(begin, (size_t)(end - begin),
+                                            &jesen_backend_builder, ctx);
+  }
+  if (err == JESEN_ERR_NONE) {
+    err = jesen_backend_builder.end_array(ctx);
+  }
+  return jesen_backend_builder_finish(ctx, err, &job->roots[s]);
+}
+
+static jesen_err_t jesen_parallel_task(void *ctx, size_t task) {
+  jesen_parallel_job_t *job = (jesen_parallel_job_t *)ctx;
+  switch (job->pass) {
+  case 0:
+    jesen_parallel_count_quotes(&job->chunks[task]);
+    return JESEN_ERR_NONE;
+  case 1:
+    jesen_parallel_track_depth(&job->chunks[task]);
+    return JESEN_ERR_NONE;
+  default:
+    return jesen_parallel_slice(job, task);
+  }
+}
+
+// Locate the body of a top-level array: the bytes between its brackets.
+static bool jesen_parallel_body(const char *buf, size_t buf_len,
+                                const char **out_begin, const char **out_end) {
+  const char *begin = buf;
+  const char *end = buf + buf_len;
+  if (buf_len >= 3 && memcmp(buf, "\xEF\xBB\xBF", 3) == 0) {
+    begin += 3;
+  }
+  while (begin < end && jesen_parallel_is_ws(*begin)) {
+    begin++;
+  }
+  while (end > begin && jesen_parallel_is_ws(end[-1])) {
+    end--;
+  }
+  if (end - begin < 2 || *begin != '[' || end[-1] != ']') {
+    return false;
+  }
+  *out_begin = begin + 1;
+  *out_end = end - 1;
+  return true;
+}
+
+// Run both scan passes and fill in the slice cuts.
+// Returns the number of slices; 1 when no usable cut was found.
+static size_t jesen_parallel_split(jesen_parallel_job_t *job, size_t threads,
+                                   const char *body, const char *body_end,
+                                   size_t chunk_count) {
+  size_t body_len = (size_t)(body_end - body);
+  jesen_parallel_chunk_t *chunks = job->chunks;
+  for (size_t i = 0; i < chunk_count; ++i) {
+    size_t step = body_len / chunk_count;
+    chunks[i].begin = body + step * i;
+    chunks[i].end = i + 1 == chunk_count ? body_end : body + step * (i + 1);
+    // An odd run of backslashes right before the cut escapes its first byte.
+    size_t run = 0;
+    for (const char *p = chunks[i].begin; p > body && p[-1] == '\\'; --p) {
+      run++;
+    }
+    chunks[i].escaped = (run & 1) != 0;
+  }
+
+  // Counting and depth tracking cannot fail.
+  job->pass = 0;
+  jesen_run_tasks(threads, chunk_count, jesen_parallel_task, job);
+  bool in_string = false;
+  for (size_t i = 0; i < chunk_count; ++i) {
+    chunks[i].in_string = in_string;
+    in_string ^= chunks[i].odd_quotes;
+  }
+
+  job->pass = 1;
+  jesen_run_tasks(threads, chunk_count, jesen_parallel_task, job);
+
+  // A comma directly inside the top-level array sits at depth 1. The first
+  // chunk never cuts, so every slice starts with at least one element.
+  size_t slices = 1;
+  job->cuts[0] = body;
+  long depth = 1;
+  for (size_t i = 0; i < chunk_count; ++i) {
+    if (i > 0 && chunks[i].comma && depth + chunks[i].min_depth == 1) {
+      job->cuts[slices++] = chunks[i].comma + 1;
+    }
+    depth += chunks[i].delta;
+  }
+  // The end cut stands in for the closing bracket, which the slice drops.
+  job->cuts[slices] = body_end + 1;
+  return slices;
+}
+
+jesen_err_t jesen_parse_parallel(const char *buf, size_t buf_len,
+                                 size_t threads, jesen_node_t **out) {
+  if (!buf || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  threads = jesen_thread_count(threads);
+  const char *body = NULL;
+  const char *body_end = NULL;
+  size_t chunk_count = threads * JESEN_PARALLEL_CHUNKS_PER_THREAD;
+  if (threads < 2 || !jesen_parallel_body(buf, buf_len, &body, &body_end) ||
+      (size_t)(body_end - body) / JESEN_PARALLEL_MIN_CHUNK < 2) {
+    return jesen_parse(buf, buf_len, out);
+  }
+  if (chunk_count > (size_t)(body_end - body) / JESEN_PARALLEL_MIN_CHUNK) {
+    chunk_count = (size_t)(body_end - body) / JESEN_PARALLEL_MIN_CHUNK;
+  }
+
+  jesen_parallel_job_t job;
+  memset(&job, 0, sizeof job);
+  job.chunks =
+      (jesen_parallel_chunk_t *)calloc(chunk_count, sizeof *job.chunks);
+  job.cuts = (const char **)calloc(chunk_count + 1, sizeof *job.cuts);
+  job.roots = (jesen_node_t **)calloc(chunk_count, sizeof *job.roots);
+  if (!job.chunks || !job.cuts || !job.roots) {
+    free(job.chunks);
+    free(job.cuts);
+    free(job.roots);
+    return JESEN_ERR_ALLOC;
+  }
+
+  size_t slices = jesen_parallel_split(&job, threads, body, body_end,
+                                       chunk_count);
+  free(job.chunks);
+
+  // A body without a single cut is left to the sequential parser as well.
+  jesen_err_t err = JESEN_ERR_PARSE;
+  if (slices > 1) {
+    job.pass = 2;
+    err = jesen_run_tasks(threads, slices, jesen_parallel_task, &job);
+  }
+  if (err != JESEN_ERR_NONE) {
+    for (size_t s = 0; s < slices; ++s) {
+      if (job.roots[s]) {
+        jesen_destroy(job.roots[s]);
+      }
+    }
+    free(job.cuts);
+    free(job.roots);
+    // Let the sequential parser decide, so errors are reported identically.
+    return jesen_parse(buf, buf_len, out);
+  }
+
+  for (size_t s = 1; s < slices; ++s) {
+    jesen_backend_array_splice(job.roots[0], job.roots[s]);
+  }
+  *out = job.roots[0];
+  free(job.cuts);
+  free(job.roots);
+  return JESEN_ERR_NONE;
+}
@@ -0,0 +1,789 @@
+#include "jesen_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Stage 2 of the parser: walk the structural offsets produced by the scanner,
+// validate the grammar with an explicit container stack and replay the
+// document to a builder.
+
+typedef struct {
+  const char *buf;
+  size_t len;
+  jesen_scanner_t scanner;
+  const jesen_builder_t *builder;
+  void *ctx;
+  // mutable alias of `buf` when parsing in situ, otherwise NULL.
+  char *insitu;
+  // scratch space for strings that contain escape sequences.
+  char *scratch;
+  size_t scratch_cap;
+  // one byte per open container, '{' or '['; `stack` starts out as
+  // `inline_stack` and moves to the heap for deeper documents.
+  char *stack;
+  size_t stack_cap;
+  size_t max_depth;
+  // values still allowed before the node limit is hit.
+  size_t nodes_left;
+  const jesen_allocator_t *allocator;
+  // projected parses: the step each open container is read with.
+  const jesen_proj_step_t **steps;
+  size_t steps_cap;
+  char inline_stack[128];
+} jesen_reader_t;
+
+static bool jesen_is_scalar_end(const jesen_reader_t *r, size_t offset) {
+  if (offset >= r->len) {
+    return true;
+  }
+  switch (r->buf[offset]) {
+  case ' ':
+  case '\t':
+  case '\n':
+  case '\r':
+  case ',':
+  case ':':
+  case ']':
+  case '}':
+  case '[':
+  case '{':
+    return true;
+  default:
+    return false;
+  }
+}
+
+static int jesen_hex_value(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+static bool jesen_parse_hex4(const char *in, uint32_t *out) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; ++i) {
+    int digit = jesen_hex_value(in[i]);
+    if (digit < 0) {
+      return false;
+    }
+    value = (value << 4) | (uint32_t)digit;
+  }
+  *out = value;
+  return true;
+}
+
+static char *jesen_encode_utf8(char *out, uint32_t cp) {
+  if (cp < 0x80) {
+    *out++ = (char)cp;
+  } else if (cp < 0x800) {
+    *out++ = (char)(0xC0 | (cp >> 6));
+    *out++ = (char)(0x80 | (cp & 0x3F));
+  } else if (cp < 0x10000) {
+    *out++ = (char)(0xE0 | (cp >> 12));
+    *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+    *out++ = (char)(0x80 | (cp & 0x3F));
+  } else {
+    *out++ = (char)(0xF0 | (cp >> 18));
+    *out++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+    *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+    *out++ = (char)(0x80 | (cp & 0x3F));
+  }
+  return out;
+}
+
+bool jesen_unescape(const char *in, const char *end, char *dst,
+                    size_t *out_len) {
+  char *start = dst;
+  while (in < end) {
+    if (*in != '\\') {
+      *dst++ = *in++;
+      continue;
+    }
+    switch (in[1]) {
+    case 'b':
+      *dst++ = '\b';
+      break;
+    case 'f':
+      *dst++ = '\f';
+      break;
+    case 'n':
+      *dst++ = '\n';
+      break;
+    case 'r':
+      *dst++ = '\r';
+      break;
+    case 't':
+      *dst++ = '\t';
+      break;
+    case '\"':
+    case '\\':
+    case '/':
+      *dst++ = in[1];
+      break;
+    case 'u': {
+      uint32_t cp = 0;
+      if (end - in < 6 || !jesen_parse_hex4(in + 2, &cp)) {
+        return false;
+      }
+      in += 6;
+      if (cp >= 0xDC00 && cp <= 0xDFFF) {
+        return false;
+      }
+      if (cp >= 0xD800 && cp <= 0xDBFF) {
+        uint32_t low = 0;
+        if (end - in < 6 || in[0] != '\\' || in[1] != 'u' ||
+            !jesen_parse_hex4(in + 2, &low) || low < 0xDC00 || low > 0xDFFF) {
+          return false;
+        }
+        in += 6;
+        cp = 0x10000 + (((cp & 0x3FF) << 10) | (low & 0x3FF));
+      }
+      dst = jesen_encode_utf8(dst, cp);
+      continue;
+    }
+    default:
+      return false;
+    }
+    in += 2;
+  }
+  *out_len = (size_t)(dst - start);
+  return true;
+}
+
+// Decode the string literal whose opening quote is at `open`. The closing
+// quote is the next structural. In situ, the literal is unescaped over itself
+// and terminated where the closing quote was; the scanner has already
+// classified those bytes, so overwriting them is safe. Otherwise escaped
+// strings are decoded into scratch space that the next string reuses.
+static jesen_err_t jesen_decode_string(jesen_reader_t *r, size_t open,
+                                       const char **out, size_t *out_len) {
+  size_t close = 0;
+  if (!jesen_scanner_next(&r->scanner, &close) || r->buf[close] != '\"') {
+    return JESEN_ERR_PARSE;
+  }
+
+  const char *start = r->buf + open + 1;
+  size_t raw_len = close - open - 1;
+  bool escaped = memchr(start, '\\', raw_len) != NULL;
+
+  if (r->insitu) {
+    char *dst = r->insitu + open + 1;
+    size_t len = raw_len;
+    if (escaped && !jesen_unescape(start, start + raw_len, dst, &len)) {
+      return JESEN_ERR_PARSE;
+    }
+    dst[len] = '\0';
+    *out = dst;
+    *out_len = len;
+    return JESEN_ERR_NONE;
+  }
+
+  if (!escaped) {
+    *out = start;
+    *out_len = raw_len;
+    return JESEN_ERR_NONE;
+  }
+
+  // Scratch contents do not outlive one string, so growing need not copy.
+  if (raw_len > r->scratch_cap) {
+    jesen_release(r->allocator, r->scratch);
+    r->scratch = (char *)jesen_alloc(r->allocator, raw_len);
+    r->scratch_cap = r->scratch ? raw_len : 0;
+    if (!r->scratch) {
+      return JESEN_ERR_ALLOC;
+    }
+  }
+
+  size_t len = 0;
+  if (!jesen_unescape(start, start + raw_len, r->scratch, &len)) {
+    return JESEN_ERR_PARSE;
+  }
+  *out = r->scratch;
+  *out_len = len;
+  return JESEN_ERR_NONE;
+}
+
+// Decode a string literal and hand it to `emit`.
+static jesen_err_t jesen_read_string(jesen_reader_t *r, size_t open,
+                                     jesen_err_t (*emit)(void *, const char *,
+                                                         size_t)) {
+  const char *str = NULL;
+  size_t len = 0;
+  jesen_err_t err = jesen_decode_string(r, open, &str, &len);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  return emit(r->ctx, str, len);
+}
+
+static size_t jesen_scan_digits(const char *buf, size_t len, size_t i) {
+  while (i < len && buf[i] >= '0' && buf[i] <= '9') {
+    i++;
+  }
+  return i;
+}
+
+size_t jesen_scan_number(const char *buf, size_t len) {
+  size_t i = 0;
+
+  if (i < len && buf[i] == '-') {
+    i++;
+  }
+  if (i >= len || buf[i] < '0' || buf[i] > '9') {
+    return 0;
+  }
+  i = buf[i] == '0' ? i + 1 : jesen_scan_digits(buf, len, i);
+  if (i < len && buf[i] == '.') {
+    size_t frac = jesen_scan_digits(buf, len, i + 1);
+    if (frac == i + 1) {
+      return 0;
+    }
+    i = frac;
+  }
+  if (i < len && (buf[i] == 'e' || buf[i] == 'E')) {
+    i++;
+    if (i < len && (buf[i] == '+' || buf[i] == '-')) {
+      i++;
+    }
+    size_t exp = jesen_scan_digits(buf, len, i);
+    if (exp == i) {
+      return 0;
+    }
+    i = exp;
+  }
+  return i;
+}
+
+static jesen_err_t jesen_read_number(jesen_reader_t *r, size_t start) {
+  size_t len = jesen_scan_number(r->buf + start, r->len - start);
+  if (len == 0 || !jesen_is_scalar_end(r, start + len)) {
+    return JESEN_ERR_PARSE;
+  }
+  return r->builder->number(r->ctx, r->buf + start, len);
+}
+
+static jesen_err_t jesen_read_literal(jesen_reader_t *r, size_t start) {
+  const char *at = r->buf + start;
+  size_t avail = r->len - start;
+
+  if (avail >= 4 && memcmp(at, "true", 4) == 0 &&
+      jesen_is_scalar_end(r, start + 4)) {
+    return r->builder->boolean(r->ctx, true);
+  }
+  if (avail >= 5 && memcmp(at, "false", 5) == 0 &&
+      jesen_is_scalar_end(r, start + 5)) {
+    return r->builder->boolean(r->ctx, false);
+  }
+  if (avail >= 4 && memcmp(at, "null", 4) == 0 &&
+      jesen_is_scalar_end(r, start + 4)) {
+    return r->builder->null_value(r->ctx);
+  }
+  return JESEN_ERR_PARSE;
+}
+
+// Record container `open` at `depth`, enforcing the nesting limit.
+static jesen_err_t jesen_reader_push(jesen_reader_t *r, size_t depth,
+                                     char open) {
+  if (depth == r->max_depth) {
+    return JESEN_ERR_PARSE;
+  }
+  if (depth == r->stack_cap) {
+    size_t cap = r->stack_cap * 2;
+    if (cap > r->max_depth) {
+      cap = r->max_depth;
+    }
+    char *grown = (char *)jesen_alloc(r->allocator, cap);
+    if (!grown) {
+      return JESEN_ERR_ALLOC;
+    }
+    memcpy(grown, r->stack, depth);
+    if (r->stack != r->inline_stack) {
+      jesen_release(r->allocator, r->stack);
+    }
+    r->stack = grown;
+    r->stack_cap = cap;
+  }
+  r->stack[depth] = open;
+  return JESEN_ERR_NONE;
+}
+
+// Parse one document, or with `elements` a comma-separated run of values that
+// sits directly inside an array opened (and closed) by the caller.
+static jesen_err_t jesen_read_document(jesen_reader_t *r, bool elements) {
+  size_t depth = 0;
+  size_t at = 0;
+  jesen_err_t err = JESEN_ERR_NONE;
+  const jesen_builder_t *b = r->builder;
+
+  // The enclosing array counts toward the nesting limit but never closes.
+  size_t base = 0;
+  if (elements) {
+    if ((err = jesen_reader_push(r, depth, '[')) != JESEN_ERR_NONE) {
+      return err;
+    }
+    depth = base = 1;
+  }
+
+  if (!jesen_scanner_next(&r->scanner, &at)) {
+    return JESEN_ERR_PARSE;
+  }
+
+value:
+  if (r->nodes_left-- == 0) {
+    return JESEN_ERR_LIMIT;
+  }
+  switch (r->buf[at]) {
+  case '{':
+    if ((err = jesen_reader_push(r, depth, '{')) != JESEN_ERR_NONE ||
+        (err = b->begin_object(r->ctx)) != JESEN_ERR_NONE) {
+      return err;
+    }
+    depth++;
+    if (!jesen_scanner_next(&r->scanner, &at)) {
+      return JESEN_ERR_PARSE;
+    }
+    if (r->buf[at] == '}') {
+      goto close_container;
+    }
+    goto object_key;
+  case '[':
+    if ((err = jesen_reader_push(r, depth, '[')) != JESEN_ERR_NONE ||
+        (err = b->begin_array(r->ctx)) != JESEN_ERR_NONE) {
+      return err;
+    }
+    depth++;
+    if (!jesen_scanner_next(&r->scanner, &at)) {
+      return JESEN_ERR_PARSE;
+    }
+    if (r->buf[at] == ']') {
+      goto close_container;
+    }
+    goto value;
+  case '\"':
+    err = jesen_read_string(r, at, b->string);
+    break;
+  case 't':
+  case 'f':
+  case 'n':
+    err = jesen_read_literal(r, at);
+    break;
+  default:
+    err = jesen_read_number(r, at);
+    break;
+  }
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+
+after_value:
+  if (depth == base) {
+    if (!jesen_scanner_next(&r->scanner, &at)) {
+      if (r->scanner.bad_string) {
+        return JESEN_ERR_PARSE;
+      }
+      return r->scanner.bad_utf8 ? JESEN_ERR_UTF8 : JESEN_ERR_NONE;
+    }
+    if (!elements || r->buf[at] != ',' ||
+        !jesen_scanner_next(&r->scanner, &at)) {
+      return JESEN_ERR_PARSE;
+    }
+    goto value;
+  }
+  if (!jesen_scanner_next(&r->scanner, &at)) {
+    return JESEN_ERR_PARSE;
+  }
+  if (r->buf[at] == ',') {
+    if (!jesen_scanner_next(&r->scanner, &at)) {
+      return JESEN_ERR_PARSE;
+    }
+    if (r->stack[depth - 1] == '{') {
+      goto object_key;
+    }
+    goto value;
+  }
+  if (r->buf[at] != (r->stack[depth - 1] == '{' ? '}' : ']')) {
+    return JESEN_ERR_PARSE;
+  }
+
+close_container:
+  err = r->stack[--depth] == '{' ? b->end_object(r->ctx)
+                                  : b->end_array(r->ctx);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  goto after_value;
+
+object_key:
+  if (r->buf[at] != '\"') {
+    return JESEN_ERR_PARSE;
+  }
+  if ((err = jesen_read_string(r, at, b->key)) != JESEN_ERR_NONE) {
+    return err;
+  }
+  if (!jesen_scanner_next(&r->scanner, &at) || r->buf[at] != ':' ||
+      !jesen_scanner_next(&r->scanner, &at)) {
+    return JESEN_ERR_PARSE;
+  }
+  goto value;
+}
+
+// Step over the value starting at structural `at` without building it: only
+// brackets are matched (string literals are already paired by the scanner).
+static jesen_err_t jesen_skip_value(jesen_reader_t *r, size_t at) {
+  char c = r->buf[at];
+  if (c == '\"') {
+    return jesen_scanner_next(&r->scanner, &at) ? JESEN_ERR_NONE
+                                                : JESEN_ERR_PARSE;
+  }
+  if (c != '{' && c != '[') {
+    return JESEN_ERR_NONE;
+  }
+  return jesen_scanner_skip(&r->scanner, &at) ? JESEN_ERR_NONE
+                                              : JESEN_ERR_PARSE;
+}
+
+// Record the projection step of the container opened at `depth`.
+static jesen_err_t jesen_reader_push_step(jesen_reader_t *r, size_t depth,
+                                          const jesen_proj_step_t *step) {
+  if (depth == r->steps_cap) {
+    size_t cap = r->steps_cap ? r->steps_cap * 2 : 64;
+    const jesen_proj_step_t **grown = (const jesen_proj_step_t **)jesen_alloc(
+        r->allocator, cap * sizeof *grown);
+    if (!grown) {
+      return JESEN_ERR_ALLOC;
+    }
+    if (depth) {
+      memcpy((void *)grown, (const void *)r->steps, depth * sizeof *grown);
+    }
+    jesen_release(r->allocator, (void *)r->steps);
+    r->steps = grown;
+    r->steps_cap = cap;
+  }
+  r->steps[depth] = step;
+  return JESEN_ERR_NONE;
+}
+
+// jesen_read_document restricted to a projection. Every value is read with
+// the step that selected it; members and elements without a step of their
+// own are skipped, and a step that keeps its whole value passes itself on
+// to everything below it.
+static jesen_err_t jesen_read_projected(jesen_reader_t *r,
+                                        const jesen_proj_step_t *step) {
+  size_t depth = 0;
+  size_t at = 0;
+  jesen_err_t err = JESEN_ERR_NONE;
+  const jesen_builder_t *b = r->builder;
+  const jesen_proj_step_t *parent = NULL;
+
+  if (!jesen_scanner_next(&r->scanner, &at)) {
+    return JESEN_ERR_PARSE;
+  }
+
+value:
+  if (r->nodes_left-- == 0) {
+    return JESEN_ERR_LIMIT;
+  }
+  switch (r->buf[at]) {
+  case '{':
+    if ((err = jesen_reader_push(r, depth, '{')) != JESEN_ERR_NONE ||
+        (err = jesen_reader_push_step(r, depth, step)) != JESEN_ERR_NONE ||
+        (err = b->begin_object(r->ctx)) != JESEN_ERR_NONE) {
+      return err;
+    }
+    depth++;
+    if (!jesen_scanner_next(&r->scanner, &at)) {
+      return JESEN_ERR_PARSE;
+    }
+    if (r->buf[at] == '}') {
+      goto close_container;
+    }
+    goto object_key;
+  case '[':
+    if ((err = jesen_reader_push(r, depth, '[')) != JESEN_ERR_NONE ||
+        (err = jesen_reader_push_step(r, depth, step)) != JESEN_ERR_NONE ||
+        (err = b->begin_array(r->ctx)) != JESEN_ERR_NONE) {
+      return err;
+    }
+    depth++;
+    if (!jesen_scanner_next(&r->scanner, &at)) {
+      return JESEN_ERR_PARSE;
+    }
+    if (r->buf[at] == ']') {
+      goto close_container;
+    }
+    goto element;
+  case '\"':
+    err = jesen_read_string(r, at, b->string);
+    break;
+  case 't':
+  case 'f':
+  case 'n':
+    err = jesen_read_literal(r, at);
+    break;
+  default:
+    err = jesen_read_number(r, at);
+    break;
+  }
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+
+after_value:
+  if (depth == 0) {
+    if (jesen_scanner_next(&r->scanner, &at) || r->scanner.bad_string) {
+      return JESEN_ERR_PARSE;
+    }
+    return r->scanner.bad_utf8 ? JESEN_ERR_UTF8 : JESEN_ERR_NONE;
+  }
+  if (!jesen_scanner_next(&r->scanner, &at)) {
+    return JESEN_ERR_PARSE;
+  }
+  if (r->buf[at] == ',') {
+    if (!jesen_scanner_next(&r->scanner, &at)) {
+      return JESEN_ERR_PARSE;
+    }
+    if (r->stack[depth - 1] == '{') {
+      goto object_key;
+    }
+    goto element;
+  }
+  if (r->buf[at] != (r->stack[depth - 1] == '{' ? '}' : ']')) {
+    return JESEN_ERR_PARSE;
+  }
+
+close_container:
+  err = r->stack[--depth] == '{' ? b->end_object(r->ctx)
+                                  : b->end_array(r->ctx);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  goto after_value;
+
+element:
+  parent = r->steps[depth - 1];
+  step = parent->whole ? parent : jesen_proj_element(parent);
+  if (step) {
+    goto value;
+  }
+  if ((err = jesen_skip_value(r, at)) != JESEN_ERR_NONE) {
+    return err;
+  }
+  goto after_value;
+
+object_key: {
+  const char *key = NULL;
+  size_t key_len = 0;
+  if (r->buf[at] != '\"' ||
+      (err = jesen_decode_string(r, at, &key, &key_len)) != JESEN_ERR_NONE) {
+    return err != JESEN_ERR_NONE ? err : JESEN_ERR_PARSE;
+  }
+  if (!jesen_scanner_next(&r->scanner, &at) || r->buf[at] != ':' ||
+      !jesen_scanner_next(&r->scanner, &at)) {
+    return JESEN_ERR_PARSE;
+  }
+  parent = r->steps[depth - 1];
+  step = parent->whole ? parent : jesen_proj_member(parent, key, key_len);
+  if (step) {
+    if ((err = b->key(r->ctx, key, key_len)) != JESEN_ERR_NONE) {
+      return err;
+    }
+    goto value;
+  }
+  if ((err = jesen_skip_value(r, at)) != JESEN_ERR_NONE) {
+    return err;
+  }
+  goto after_value;
+}
+}
+
+static jesen_err_t jesen_parse_buffer(const char *buf, char *insitu,
+                                      size_t buf_len, bool elements,
+                                      const jesen_parse_opts_t *opts,
+                                      const jesen_builder_t *builder,
+                                      void *ctx) {
+  if (!buf || !builder) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  if (opts && opts->max_input && buf_len > opts->max_input) {
+    return JESEN_ERR_LIMIT;
+  }
+
+  // Skip a UTF-8 byte order mark, as cJSON does. It can only lead a document.
+  if (!elements && buf_len >= 3 && memcmp(buf, "\xEF\xBB\xBF", 3) == 0) {
+    buf += 3;
+    buf_len -= 3;
+    if (insitu) {
+      insitu += 3;
+    }
+  }
+
+  jesen_reader_t r;
+  r.buf = buf;
+  r.len = buf_len;
+  r.builder = builder;
+  r.ctx = ctx;
+  r.insitu = insitu;
+  r.scratch = NULL;
+  r.scratch_cap = 0;
+  r.stack = r.inline_stack;
+  r.stack_cap = sizeof r.inline_stack;
+  r.max_depth = opts && opts->max_depth ? opts->max_depth : JESEN_NESTING_LIMIT;
+  r.nodes_left = opts && opts->max_nodes ? opts->max_nodes : SIZE_MAX;
+  r.allocator = opts ? opts->allocator : NULL;
+  r.steps = NULL;
+  r.steps_cap = 0;
+  jesen_scanner_init(&r.scanner, buf, buf_len);
+  r.scanner.check_utf8 = opts && (opts->flags & JESEN_PARSE_STRICT_UTF8) != 0;
+
+  jesen_err_t err =
+      opts && opts->projection && !elements
+          ? jesen_read_projected(&r, &opts->projection->root)
+          : jesen_read_document(&r, elements);
+
+  jesen_release(r.allocator, r.scratch);
+  jesen_release(r.allocator, (void *)r.steps);
+  if (r.stack != r.inline_stack) {
+    jesen_release(r.allocator, r.stack);
+  }
+  return err;
+}
+
+jesen_err_t jesen_parse_with_builder(const char *buf, size_t buf_len,
+                                     const jesen_builder_t *builder,
+                                     void *ctx) {
+  return jesen_parse_buffer(buf, NULL, buf_len, false, NULL, builder, ctx);
+}
+
+jesen_err_t jesen_parse_elements_with_builder(const char *buf, size_t buf_len,
+                                              const jesen_builder_t *builder,
+                                              void *ctx) {
+  return jesen_parse_buffer(buf, NULL, buf_len, true, NULL, builder, ctx);
+}
+
+jesen_err_t jesen_parse_insitu_with_builder(char *buf, size_t buf_len,
+                                            const jesen_builder_t *builder,
+                                            void *ctx) {
+  return jesen_parse_buffer(buf, buf, buf_len, false, NULL, builder, ctx);
+}
+
+static jesen_err_t jesen_skip_event(void *ctx) {
+  (void)ctx;
+  return JESEN_ERR_NONE;
+}
+
+static jesen_err_t jesen_skip_slice(void *ctx, const char *str, size_t len) {
+  (void)ctx;
+  (void)str;
+  (void)len;
+  return JESEN_ERR_NONE;
+}
+
+static jesen_err_t jesen_skip_boolean(void *ctx, bool value) {
+  (void)ctx;
+  (void)value;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_parse_events(const char *buf, size_t buf_len,
+                               const jesen_handler_t *handler, void *ctx) {
+  if (!buf || !handler) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  // Fill unset callbacks once so the reader never checks for NULL.
+  jesen_builder_t b = *handler;
+  b.begin_object = b.begin_object ? b.begin_object : jesen_skip_event;
+  b.end_object = b.end_object ? b.end_object : jesen_skip_event;
+  b.begin_array = b.begin_array ? b.begin_array : jesen_skip_event;
+  b.end_array = b.end_array ? b.end_array : jesen_skip_event;
+  b.key = b.key ? b.key : jesen_skip_slice;
+  b.string = b.string ? b.string : jesen_skip_slice;
+  b.number = b.number ? b.number : jesen_skip_slice;
+  b.boolean = b.boolean ? b.boolean : jesen_skip_boolean;
+  b.null_value = b.null_value ? b.null_value : jesen_skip_event;
+
+  return jesen_parse_buffer(buf, NULL, buf_len, false, NULL, &b, ctx);
+}
+
+jesen_err_t jesen_parse_tree(const char *buf, char *insitu, size_t buf_len,
+                             const jesen_parse_opts_t *opts,
+                             jesen_node_t **out) {
+  if (!buf || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  // JESEN_PARSE_INTERN_KEYS without a shared pool: give the tree its own.
+  jesen_parse_opts_t own_opts;
+  jesen_intern_t *own = NULL;
+  if (opts && (opts->flags & JESEN_PARSE_INTERN_KEYS) && !opts->intern) {
+    jesen_err_t err = jesen_intern_create(&own);
+    if (err != JESEN_ERR_NONE) {
+      return err;
+    }
+    own_opts = *opts;
+    own_opts.intern = own;
+    opts = &own_opts;
+  }
+
+  void *ctx = NULL;
+  jesen_node_t *root = NULL;
+  jesen_err_t err = jesen_backend_builder_create(insitu != NULL, opts, &ctx);
+  if (err == JESEN_ERR_NONE) {
+    err = jesen_parse_buffer(buf, insitu, buf_len, false, opts,
+                             &jesen_backend_builder, ctx);
+    err = jesen_backend_builder_finish(ctx, err, &root);
+  }
+  if (err == JESEN_ERR_NONE && opts && opts->intern) {
+    // The tree's keys live in the pool, so it keeps the pool alive.
+    err = jesen_intern_attach(opts->intern, root);
+    if (err != JESEN_ERR_NONE) {
+      jesen_destroy(root);
+    }
+  }
+  if (own) {
+    jesen_intern_destroy(own);
+  }
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+
+  *out = root;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_parse(const char *buf, size_t buf_len, jesen_node_t **out) {
+  return jesen_parse_tree(buf, NULL, buf_len, NULL, out);
+}
+
+jesen_err_t jesen_parse_with_flags(const char *buf, size_t buf_len,
+                                   uint32_t flags, jesen_node_t **out) {
+  jesen_parse_opts_t opts;
+  memset(&opts, 0, sizeof opts);
+  opts.flags = flags;
+  return jesen_parse_ex(buf, buf_len, &opts, out);
+}
+
+jesen_err_t jesen_parse_ex(const char *buf, size_t buf_len,
+                           const jesen_parse_opts_t *opts, jesen_node_t **out) {
+  const uint32_t known = JESEN_PARSE_STRICT_UTF8 | JESEN_PARSE_EAGER_WRAPPERS |
+                         JESEN_PARSE_INTERN_KEYS;
+  if (!opts || (opts->flags & ~known) ||
+      (unsigned)opts->duplicates > (unsigned)JESEN_DUPLICATE_ERROR) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  if (opts->allocator && (!opts->allocator->alloc ||
+                          !opts->allocator->release)) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  return jesen_parse_tree(buf, NULL, buf_len, opts, out);
+}
+
+jesen_err_t jesen_parse_insitu(char *buf, size_t buf_len, jesen_node_t **out) {
+  return jesen_parse_tree(buf, buf, buf_len, NULL, out);
+}
@@ -0,0 +1,146 @@
+#include "jesen_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Compiled projections for jesen_parse_ex. The paths are merged into a trie
+// of steps: member steps match one object key, the `[*]` step matches every
+// array element. A step where some path ends keeps its whole value, so any
+// longer path below it adds nothing.
+
+static void jesen_proj_free_steps(jesen_proj_step_t *step) {
+  // Walk the trie through a chain made of the `next` links, splicing each
+  // step's children in after it, so freeing does not recurse.
+  while (step) {
+    if (step->child) {
+      jesen_proj_step_t *last = step->child;
+      while (last->next) {
+        last = last->next;
+      }
+      last->next = step->next;
+      step->next = step->child;
+    }
+    jesen_proj_step_t *next = step->next;
+    free(step->key);
+    free(step);
+    step = next;
+  }
+}
+
+// Find or add the child of `parent` for `key` (NULL for `[*]`).
+static jesen_proj_step_t *jesen_proj_child(jesen_proj_step_t *parent,
+                                           const char *key, size_t key_len) {
+  jesen_proj_step_t **link = &parent->child;
+  for (; *link; link = &(*link)->next) {
+    jesen_proj_step_t *cur = *link;
+    if (!key ? !cur->key
+             : cur->key && cur->key_len == key_len &&
+                   memcmp(cur->key, key, key_len) == 0) {
+      return cur;
+    }
+  }
+
+  jesen_proj_step_t *step = (jesen_proj_step_t *)calloc(1, sizeof *step);
+  if (!step) {
+    return NULL;
+  }
+  if (key) {
+    step->key = (char *)malloc(key_len + 1);
+    if (!step->key) {
+      free(step);
+      return NULL;
+    }
+    memcpy(step->key, key, key_len);
+    step->key[key_len] = '\0';
+    step->key_len = key_len;
+  }
+  *link = step;
+  return step;
+}
+
+// Add one path, e.g. `items[*].price`, below `root`.
+static jesen_err_t jesen_proj_add(jesen_proj_step_t *root, const char *path) {
+  jesen_proj_step_t *step = root;
+  const char *p = path;
+  while (*p) {
+    if (p[0] == '[') {
+      if (p[1] != '*' || p[2] != ']') {
+        return JESEN_ERR_INVALID_ARGS;
+      }
+      p += 3;
+      step = jesen_proj_child(step, NULL, 0);
+    } else {
+      if (p != path) {
+        // Members after the first are introduced by a dot.
+        if (*p != '.') {
+          return JESEN_ERR_INVALID_ARGS;
+        }
+        p++;
+      }
+      size_t len = strcspn(p, ".[");
+      if (len == 0) {
+        return JESEN_ERR_INVALID_ARGS;
+      }
+      step = jesen_proj_child(step, p, len);
+      p += len;
+    }
+    if (!step) {
+      return JESEN_ERR_ALLOC;
+    }
+  }
+  step->whole = true;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_projection_create(const char *const *paths, size_t count,
+                                    jesen_projection_t **out) {
+  if (!paths || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  jesen_projection_t *projection =
+      (jesen_projection_t *)calloc(1, sizeof *projection);
+  if (!projection) {
+    return JESEN_ERR_ALLOC;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    jesen_err_t err = paths[i] ? jesen_proj_add(&projection->root, paths[i])
+                               : JESEN_ERR_INVALID_ARGS;
+    if (err != JESEN_ERR_NONE) {
+      jesen_projection_destroy(projection);
+      return err;
+    }
+  }
+
+  *out = projection;
+
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_projection_destroy(jesen_projection_t *projection) {
+  if (!projection) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  jesen_proj_free_steps(projection->root.child);
+  free(projection);
+  return JESEN_ERR_NONE;
+}
+
+const jesen_proj_step_t *jesen_proj_member(const jesen_proj_step_t *step,
+                                           const char *key, size_t len) {
+  for (const jesen_proj_step_t *cur = step->child; cur; cur = cur->next) {
+    if (cur->key && cur->key_len == len && memcmp(cur->key, key, len) == 0) {
+      return cur;
+    }
+  }
+  return NULL;
+}
+
+const jesen_proj_step_t *jesen_proj_element(const jesen_proj_step_t *step) {
+  for (const jesen_proj_step_t *cur = step->child; cur; cur = cur->next) {
+    if (!cur->key) {
+      return cur;
+    }
+  }
+  return NULL;
+}
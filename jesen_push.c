@@ -0,0 +1,419 @@
+#include "jesen_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Push parser: a byte-at-a-time state machine for documents that arrive in
+// chunks. Grammar state and the container stack live in the parser, and a
+// token cut by a chunk boundary is carried over in `token`. Strings that
+// start and end in the same chunk are handed to the builder without a copy.
+// Completed tokens are validated with the same helpers as jesen_parse, so
+// both accept exactly the same documents and build the same tree.
+
+typedef enum {
+  JESEN_PUSH_VALUE,        // expecting a value
+  JESEN_PUSH_ARRAY_FIRST,  // after '[': a value or ']'
+  JESEN_PUSH_OBJECT_FIRST, // after '{': a key or '}'
+  JESEN_PUSH_KEY,          // after ',' in an object
+  JESEN_PUSH_COLON,        // after a key
+  JESEN_PUSH_AFTER_VALUE,  // ',' or a closing bracket, or end of document
+  JESEN_PUSH_DONE,         // root value complete; only whitespace may follow
+} jesen_push_state_t;
+
+typedef enum {
+  JESEN_TOKEN_NONE,
+  JESEN_TOKEN_STRING,
+  JESEN_TOKEN_NUMBER,
+  JESEN_TOKEN_LITERAL,
+} jesen_token_kind_t;
+
+struct jesen_parser {
+  void *ctx;
+  jesen_err_t err;
+  jesen_push_state_t state;
+  jesen_token_kind_t token_kind;
+  // set while the open string token is an object key.
+  bool token_is_key;
+  // set when the last string byte seen was an unconsumed backslash.
+  bool escape;
+  // number of UTF-8 byte order mark bytes matched so far (3 once past it).
+  unsigned bom;
+  // bytes of a token that started in an earlier chunk.
+  char *token;
+  size_t token_len;
+  size_t token_cap;
+  // unescape target for strings that did not need to be carried over.
+  char *scratch;
+  size_t scratch_cap;
+  size_t depth;
+  char stack[JESEN_NESTING_LIMIT];
+};
+
+static bool jesen_push_grow(char **buf, size_t *cap, size_t need) {
+  if (need <= *cap) {
+    return true;
+  }
+  size_t grown_cap = *cap ? *cap : 64;
+  while (grown_cap < need) {
+    grown_cap *= 2;
+  }
+  char *grown = (char *)realloc(*buf, grown_cap);
+  if (!grown) {
+    return false;
+  }
+  *buf = grown;
+  *cap = grown_cap;
+  return true;
+}
+
+static jesen_err_t jesen_push_append(jesen_parser_t *p, const char *bytes,
+                                     size_t len) {
+  if (!jesen_push_grow(&p->token, &p->token_cap, p->token_len + len)) {
+    return JESEN_ERR_ALLOC;
+  }
+  memcpy(p->token + p->token_len, bytes, len);
+  p->token_len += len;
+  return JESEN_ERR_NONE;
+}
+
+static void jesen_push_reset(jesen_parser_t *p) {
+  p->ctx = NULL;
+  p->err = JESEN_ERR_NONE;
+  p->state = JESEN_PUSH_VALUE;
+  p->token_kind = JESEN_TOKEN_NONE;
+  p->token_is_key = false;
+  p->escape = false;
+  p->bom = 0;
+  p->token_len = 0;
+  p->depth = 0;
+}
+
+// A value just completed: move to the state that follows it.
+static void jesen_push_value_done(jesen_parser_t *p) {
+  p->state = p->depth == 0 ? JESEN_PUSH_DONE : JESEN_PUSH_AFTER_VALUE;
+}
+
+// Decode and emit a complete string body. `raw` is either the chunk itself or
+// the carried-over token buffer, which is then unescaped over itself.
+static jesen_err_t jesen_push_emit_string(jesen_parser_t *p, const char *raw,
+                                          size_t raw_len) {
+  const char *str = raw;
+  size_t len = raw_len;
+  if (memchr(raw, '\\', raw_len)) {
+    char *dst = p->token;
+    if (raw != p->token) {
+      if (!jesen_push_grow(&p->scratch, &p->scratch_cap, raw_len)) {
+        return JESEN_ERR_ALLOC;
+      }
+      dst = p->scratch;
+    }
+    if (!jesen_unescape(raw, raw + raw_len, dst, &len)) {
+      return JESEN_ERR_PARSE;
+    }
+    str = dst;
+  }
+
+  jesen_err_t err = p->token_is_key
+                        ? jesen_backend_builder.key(p->ctx, str, len)
+                        : jesen_backend_builder.string(p->ctx, str, len);
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  if (p->token_is_key) {
+    p->state = JESEN_PUSH_COLON;
+  } else {
+    jesen_push_value_done(p);
+  }
+  return JESEN_ERR_NONE;
+}
+
+// Emit a complete number or literal token.
+static jesen_err_t jesen_push_emit_scalar(jesen_parser_t *p, const char *raw,
+                                          size_t len) {
+  jesen_err_t err = JESEN_ERR_PARSE;
+  if (p->token_kind == JESEN_TOKEN_NUMBER) {
+    if (jesen_scan_number(raw, len) == len) {
+      err = jesen_backend_builder.number(p->ctx, raw, len);
+    }
+  } else if (len == 4 && memcmp(raw, "true", 4) == 0) {
+    err = jesen_backend_builder.boolean(p->ctx, true);
+  } else if (len == 5 && memcmp(raw, "false", 5) == 0) {
+    err = jesen_backend_builder.boolean(p->ctx, false);
+  } else if (len == 4 && memcmp(raw, "null", 4) == 0) {
+    err = jesen_backend_builder.null_value(p->ctx);
+  }
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  p->token_kind = JESEN_TOKEN_NONE;
+  p->token_len = 0;
+  jesen_push_value_done(p);
+  return JESEN_ERR_NONE;
+}
+
+static bool jesen_push_is_number_byte(char c) {
+  return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' ||
+         c == 'e' || c == 'E';
+}
+
+static bool jesen_push_is_literal_byte(char c) { return c >= 'a' && c <= 'z'; }
+
+// Continue the open token from chunk[*i]. Returns with *i past the last byte
+// consumed; the token stays open if the chunk ended first.
+static jesen_err_t jesen_push_token(jesen_parser_t *p, const char *chunk,
+                                    size_t len, size_t *i) {
+  size_t start = *i;
+  size_t at = start;
+
+  if (p->token_kind == JESEN_TOKEN_STRING) {
+    bool escape = p->escape;
+    for (; at < len; ++at) {
+      unsigned char c = (unsigned char)chunk[at];
+      if (escape) {
+        escape = false;
+      } else if (c == '\\') {
+        escape = true;
+      } else if (c == '\"') {
+        break;
+      } else if (c < 0x20) {
+        return JESEN_ERR_PARSE;
+      }
+    }
+    p->escape = escape;
+    if (at == len) {
+      *i = at;
+      return jesen_push_append(p, chunk + start, at - start);
+    }
+    *i = at + 1;
+    p->token_kind = JESEN_TOKEN_NONE;
+    if (p->token_len == 0) {
+      return jesen_push_emit_string(p, chunk + start, at - start);
+    }
+    jesen_err_t err = jesen_push_append(p, chunk + start, at - start);
+    if (err == JESEN_ERR_NONE) {
+      err = jesen_push_emit_string(p, p->token, p->token_len);
+    }
+    p->token_len = 0;
+    return err;
+  }
+
+  bool (*is_token_byte)(char) = p->token_kind == JESEN_TOKEN_NUMBER
+                                    ? jesen_push_is_number_byte
+                                    : jesen_push_is_literal_byte;
+  while (at < len && is_token_byte(chunk[at])) {
+    at++;
+  }
+  *i = at;
+  if (at == len || p->token_len != 0) {
+    jesen_err_t err = jesen_push_append(p, chunk + start, at - start);
+    if (err != JESEN_ERR_NONE || at == len) {
+      return err;
+    }
+    return jesen_push_emit_scalar(p, p->token, p->token_len);
+  }
+  return jesen_push_emit_scalar(p, chunk + start, at - start);
+}
+
+// Start a value at byte `c`. Strings, numbers and literals open a token.
+static jesen_err_t jesen_push_begin_value(jesen_parser_t *p, char c) {
+  switch (c) {
+  case '{':
+  case '[':
+    if (p->depth == JESEN_NESTING_LIMIT) {
+      return JESEN_ERR_PARSE;
+    }
+    p->stack[p->depth++] = c;
+    if (c == '{') {
+      p->state = JESEN_PUSH_OBJECT_FIRST;
+      return jesen_backend_builder.begin_object(p->ctx);
+    }
+    p->state = JESEN_PUSH_ARRAY_FIRST;
+    return jesen_backend_builder.begin_array(p->ctx);
+  case '\"':
+    p->token_kind = JESEN_TOKEN_STRING;
+    p->token_is_key = false;
+    return JESEN_ERR_NONE;
+  case 't':
+  case 'f':
+  case 'n':
+    p->token_kind = JESEN_TOKEN_LITERAL;
+    return JESEN_ERR_NONE;
+  default:
+    if (c == '-' || (c >= '0' && c <= '9')) {
+      p->token_kind = JESEN_TOKEN_NUMBER;
+      return JESEN_ERR_NONE;
+    }
+    return JESEN_ERR_PARSE;
+  }
+}
+
+static jesen_err_t jesen_push_close(jesen_parser_t *p, char c) {
+  char open = p->stack[--p->depth];
+  if (c != (open == '{' ? '}' : ']')) {
+    return JESEN_ERR_PARSE;
+  }
+  jesen_err_t err = open == '{' ? jesen_backend_builder.end_object(p->ctx)
+                                : jesen_backend_builder.end_array(p->ctx);
+  jesen_push_value_done(p);
+  return err;
+}
+
+static jesen_err_t jesen_push_chunk(jesen_parser_t *p, const char *chunk,
+                                    size_t len) {
+  static const char bom[] = "\xEF\xBB\xBF";
+  size_t i = 0;
+
+  // Skip a UTF-8 byte order mark, even when it is split across chunks.
+  while (p->bom < 3 && i < len) {
+    if (chunk[i] == bom[p->bom]) {
+      p->bom++;
+      i++;
+    } else if (p->bom > 0) {
+      return JESEN_ERR_PARSE;
+    } else {
+      p->bom = 3;
+    }
+  }
+
+  while (i < len) {
+    if (p->token_kind != JESEN_TOKEN_NONE) {
+      jesen_err_t err = jesen_push_token(p, chunk, len, &i);
+      if (err != JESEN_ERR_NONE) {
+        return err;
+      }
+      continue;
+    }
+
+    char c = chunk[i++];
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+      continue;
+    }
+
+    jesen_err_t err = JESEN_ERR_PARSE;
+    switch (p->state) {
+    case JESEN_PUSH_ARRAY_FIRST:
+      if (c == ']') {
+        err = jesen_push_close(p, c);
+        break;
+      }
+      // fallthrough
+    case JESEN_PUSH_VALUE:
+      err = jesen_push_begin_value(p, c);
+      if (p->token_kind == JESEN_TOKEN_NUMBER ||
+          p->token_kind == JESEN_TOKEN_LITERAL) {
+        // The opening byte of a bare scalar is part of its token.
+        i--;
+      }
+      break;
+    case JESEN_PUSH_OBJECT_FIRST:
+      if (c == '}') {
+        err = jesen_push_close(p, c);
+        break;
+      }
+      // fallthrough
+    case JESEN_PUSH_KEY:
+      if (c == '\"') {
+        p->token_kind = JESEN_TOKEN_STRING;
+        p->token_is_key = true;
+        err = JESEN_ERR_NONE;
+      }
+      break;
+    case JESEN_PUSH_COLON:
+      if (c == ':') {
+        p->state = JESEN_PUSH_VALUE;
+        err = JESEN_ERR_NONE;
+      }
+      break;
+    case JESEN_PUSH_AFTER_VALUE:
+      if (c == ',') {
+        p->state = p->stack[p->depth - 1] == '{' ? JESEN_PUSH_KEY
+                                                 : JESEN_PUSH_VALUE;
+        err = JESEN_ERR_NONE;
+      } else if (c == ']' || c == '}') {
+        err = jesen_push_close(p, c);
+      }
+      break;
+    case JESEN_PUSH_DONE:
+      break;
+    }
+    if (err != JESEN_ERR_NONE) {
+      return err;
+    }
+  }
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_parser_create(jesen_parser_t **out) {
+  if (!out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  jesen_parser_t *created = (jesen_parser_t *)calloc(1, sizeof *created);
+  if (!created) {
+    return JESEN_ERR_ALLOC;
+  }
+  jesen_push_reset(created);
+
+  *out = created;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_parser_feed(jesen_parser_t *parser, const char *chunk,
+                              size_t len) {
+  if (!parser || (!chunk && len > 0)) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  if (parser->err != JESEN_ERR_NONE) {
+    return parser->err;
+  }
+
+  if (!parser->ctx) {
+    jesen_err_t err = jesen_backend_builder_create(false, NULL, &parser->ctx);
+    if (err != JESEN_ERR_NONE) {
+      return err;
+    }
+  }
+
+  parser->err = jesen_push_chunk(parser, chunk, len);
+  return parser->err;
+}
+
+jesen_err_t jesen_parser_finish(jesen_parser_t *parser, jesen_node_t **out) {
+  if (!parser || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  jesen_err_t err = parser->err;
+  if (err == JESEN_ERR_NONE && !parser->ctx) {
+    // Nothing was fed.
+    err = JESEN_ERR_PARSE;
+  }
+  // A number or literal at the very end is only terminated by end of input.
+  if (err == JESEN_ERR_NONE && (parser->token_kind == JESEN_TOKEN_NUMBER ||
+                                parser->token_kind == JESEN_TOKEN_LITERAL)) {
+    err = jesen_push_emit_scalar(parser, parser->token, parser->token_len);
+  }
+  if (err == JESEN_ERR_NONE && parser->state != JESEN_PUSH_DONE) {
+    err = JESEN_ERR_PARSE;
+  }
+
+  if (parser->ctx) {
+    err = jesen_backend_builder_finish(parser->ctx, err, out);
+  }
+  jesen_push_reset(parser);
+  return err;
+}
+
+jesen_err_t jesen_parser_destroy(jesen_parser_t *parser) {
+  if (!parser) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+
+  if (parser->ctx) {
+    jesen_node_t *unused = NULL;
+    jesen_backend_builder_finish(parser->ctx, JESEN_ERR_PARSE, &unused);
+  }
+  free(parser->token);
+  free(parser->scratch);
+  free(parser);
+  return JESEN_ERR_NONE;
+}
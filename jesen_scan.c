@@ -0,0 +1,690 @@
+#include "jesen_internal.h"
+#include <string.h>
+
+// Stage 1 of the parser: classify 64-byte blocks into bitmasks and turn them
+// into a stream of structural offsets. Only the classification step is
+// vectorized; the escape/string/scalar bookkeeping runs on 64-bit masks and
+// is shared by every kernel.
+
+#if !defined(JESEN_DISABLE_SIMD)
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) ||            \
+    defined(_M_IX86)
+#define JESEN_SCAN_X86 1
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define JESEN_SCAN_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+typedef void (*jesen_classify_fn)(const unsigned char *block,
+                                  jesen_block_masks_t *out);
+
+enum {
+  JESEN_CLASS_QUOTE = 1 << 0,
+  JESEN_CLASS_BACKSLASH = 1 << 1,
+  JESEN_CLASS_OP = 1 << 2,
+  JESEN_CLASS_WS = 1 << 3,
+  JESEN_CLASS_CTRL = 1 << 4,
+};
+
+static unsigned char jesen_char_class(unsigned char c) {
+  switch (c) {
+  case '\"':
+    return JESEN_CLASS_QUOTE;
+  case '\\':
+    return JESEN_CLASS_BACKSLASH;
+  case '{':
+  case '}':
+  case '[':
+  case ']':
+  case ':':
+  case ',':
+    return JESEN_CLASS_OP;
+  case ' ':
+    return JESEN_CLASS_WS;
+  case '\t':
+  case '\n':
+  case '\r':
+    return JESEN_CLASS_WS | JESEN_CLASS_CTRL;
+  default:
+    return c < 0x20 ? JESEN_CLASS_CTRL : 0;
+  }
+}
+
+static void jesen_classify_scalar(const unsigned char *block,
+                                  jesen_block_masks_t *out) {
+  memset(out, 0, sizeof *out);
+  for (int i = 0; i < 64; ++i) {
+    unsigned char cls = jesen_char_class(block[i]);
+    uint64_t bit = (uint64_t)1 << i;
+    if (cls & JESEN_CLASS_QUOTE) {
+      out->quote |= bit;
+    }
+    if (cls & JESEN_CLASS_BACKSLASH) {
+      out->backslash |= bit;
+    }
+    if (cls & JESEN_CLASS_OP) {
+      out->op |= bit;
+    }
+    if (cls & JESEN_CLASS_WS) {
+      out->ws |= bit;
+    }
+    if (cls & JESEN_CLASS_CTRL) {
+      out->ctrl |= bit;
+    }
+  }
+}
+
+#if defined(JESEN_SCAN_X86)
+
+static void jesen_classify_sse2(const unsigned char *block,
+                                jesen_block_masks_t *out) {
+  const __m128i quote = _mm_set1_epi8('\"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i open = _mm_set1_epi8('{');
+  const __m128i close = _mm_set1_epi8('}');
+  const __m128i colon = _mm_set1_epi8(':');
+  const __m128i comma = _mm_set1_epi8(',');
+  const __m128i case_bit = _mm_set1_epi8(0x20);
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i lf = _mm_set1_epi8('\n');
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i ctrl_max = _mm_set1_epi8(0x1F);
+
+  memset(out, 0, sizeof *out);
+  for (int i = 0; i < 4; ++i) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(block + 16 * i));
+    // '[' and ']' differ from '{' and '}' only by the 0x20 bit.
+    __m128i folded = _mm_or_si128(v, case_bit);
+    __m128i op = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(folded, open),
+                     _mm_cmpeq_epi8(folded, close)),
+        _mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma)));
+    __m128i ws = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+        _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)));
+    __m128i ctrl = _mm_cmpeq_epi8(_mm_min_epu8(v, ctrl_max), v);
+    int shift = 16 * i;
+
+    out->quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+                      _mm_cmpeq_epi8(v, quote))
+                  << shift;
+    out->backslash |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+                          _mm_cmpeq_epi8(v, backslash))
+                      << shift;
+    out->op |= (uint64_t)(uint16_t)_mm_movemask_epi8(op) << shift;
+    out->ws |= (uint64_t)(uint16_t)_mm_movemask_epi8(ws) << shift;
+    out->ctrl |= (uint64_t)(uint16_t)_mm_movemask_epi8(ctrl) << shift;
+  }
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#define JESEN_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define JESEN_TARGET_AVX2
+#endif
+
+JESEN_TARGET_AVX2
+static void jesen_classify_avx2(const unsigned char *block,
+                                jesen_block_masks_t *out) {
+  const __m256i quote = _mm256_set1_epi8('\"');
+  const __m256i backslash = _mm256_set1_epi8('\\');
+  const __m256i open = _mm256_set1_epi8('{');
+  const __m256i close = _mm256_set1_epi8('}');
+  const __m256i colon = _mm256_set1_epi8(':');
+  const __m256i comma = _mm256_set1_epi8(',');
+  const __m256i case_bit = _mm256_set1_epi8(0x20);
+  const __m256i space = _mm256_set1_epi8(' ');
+  const __m256i tab = _mm256_set1_epi8('\t');
+  const __m256i lf = _mm256_set1_epi8('\n');
+  const __m256i cr = _mm256_set1_epi8('\r');
+  const __m256i ctrl_max = _mm256_set1_epi8(0x1F);
+
+  memset(out, 0, sizeof *out);
+  for (int i = 0; i < 2; ++i) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(block + 32 * i));
+    __m256i folded = _mm256_or_si256(v, case_bit);
+    __m256i op = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(folded, open),
+                        _mm256_cmpeq_epi8(folded, close)),
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, colon),
+                        _mm256_cmpeq_epi8(v, comma)));
+    __m256i ws = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, space),
+                        _mm256_cmpeq_epi8(v, tab)),
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, cr)));
+    __m256i ctrl = _mm256_cmpeq_epi8(_mm256_min_epu8(v, ctrl_max), v);
+    int shift = 32 * i;
+
+    out->quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(
+                      _mm256_cmpeq_epi8(v, quote))
+                  << shift;
+    out->backslash |= (uint64_t)(uint32_t)_mm256_movemask_epi8(
+                          _mm256_cmpeq_epi8(v, backslash))
+                      << shift;
+    out->op |= (uint64_t)(uint32_t)_mm256_movemask_epi8(op) << shift;
+    out->ws |= (uint64_t)(uint32_t)_mm256_movemask_epi8(ws) << shift;
+    out->ctrl |= (uint64_t)(uint32_t)_mm256_movemask_epi8(ctrl) << shift;
+  }
+}
+
+static bool jesen_cpu_has_avx2(void) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+  __cpuid(info, 1);
+  // OSXSAVE and AVX, then check that the OS saves the YMM state.
+  if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 ||
+      (_xgetbv(0) & 6) != 6) {
+    return false;
+  }
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return false;
+#endif
+}
+
+static bool jesen_cpu_has_sse2(void) {
+#if defined(__x86_64__) || defined(_M_X64)
+  return true;
+#elif defined(__GNUC__) || defined(__clang__)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse2");
+#elif defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  return (info[3] & (1 << 26)) != 0;
+#else
+  return false;
+#endif
+}
+
+#endif // JESEN_SCAN_X86
+
+#if defined(JESEN_SCAN_NEON)
+
+static uint64_t jesen_neon_movemask(uint8x16_t m0, uint8x16_t m1,
+                                    uint8x16_t m2, uint8x16_t m3) {
+  const uint8x16_t bits = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+                           0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
+  uint8x16_t sum0 = vpaddq_u8(vandq_u8(m0, bits), vandq_u8(m1, bits));
+  uint8x16_t sum1 = vpaddq_u8(vandq_u8(m2, bits), vandq_u8(m3, bits));
+  sum0 = vpaddq_u8(sum0, sum1);
+  sum0 = vpaddq_u8(sum0, sum0);
+  return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+}
+
+static void jesen_classify_neon(const unsigned char *block,
+                                jesen_block_masks_t *out) {
+  uint8x16_t quote[4], backslash[4], op[4], ws[4], ctrl[4];
+  for (int i = 0; i < 4; ++i) {
+    uint8x16_t v = vld1q_u8(block + 16 * i);
+    uint8x16_t folded = vorrq_u8(v, vdupq_n_u8(0x20));
+    quote[i] = vceqq_u8(v, vdupq_n_u8('\"'));
+    backslash[i] = vceqq_u8(v, vdupq_n_u8('\\'));
+    op[i] = vorrq_u8(vorrq_u8(vceqq_u8(folded, vdupq_n_u8('{')),
+                              vceqq_u8(folded, vdupq_n_u8('}'))),
+                     vorrq_u8(vceqq_u8(v, vdupq_n_u8(':')),
+                              vceqq_u8(v, vdupq_n_u8(','))));
+    ws[i] = vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')),
+                              vceqq_u8(v, vdupq_n_u8('\t'))),
+                     vorrq_u8(vceqq_u8(v, vdupq_n_u8('\n')),
+                              vceqq_u8(v, vdupq_n_u8('\r'))));
+    ctrl[i] = vcleq_u8(v, vdupq_n_u8(0x1F));
+  }
+  out->quote = jesen_neon_movemask(quote[0], quote[1], quote[2], quote[3]);
+  out->backslash = jesen_neon_movemask(backslash[0], backslash[1],
+                                       backslash[2], backslash[3]);
+  out->op = jesen_neon_movemask(op[0], op[1], op[2], op[3]);
+  out->ws = jesen_neon_movemask(ws[0], ws[1], ws[2], ws[3]);
+  out->ctrl = jesen_neon_movemask(ctrl[0], ctrl[1], ctrl[2], ctrl[3]);
+}
+
+#endif // JESEN_SCAN_NEON
+
+static jesen_classify_fn jesen_classify_select(void) {
+#if defined(JESEN_SCAN_X86)
+  if (jesen_cpu_has_avx2()) {
+    return jesen_classify_avx2;
+  }
+  if (jesen_cpu_has_sse2()) {
+    return jesen_classify_sse2;
+  }
+#elif defined(JESEN_SCAN_NEON)
+  return jesen_classify_neon;
+#endif
+  return jesen_classify_scalar;
+}
+
+// Every thread resolves the same kernel, so a racing first call only ever
+// stores an identical pointer.
+static jesen_classify_fn jesen_classify_impl;
+
+static jesen_classify_fn jesen_classify_get(void) {
+#if defined(__GNUC__) || defined(__clang__)
+  jesen_classify_fn fn = __atomic_load_n(&jesen_classify_impl, __ATOMIC_RELAXED);
+  if (!fn) {
+    fn = jesen_classify_select();
+    __atomic_store_n(&jesen_classify_impl, fn, __ATOMIC_RELAXED);
+  }
+#else
+  jesen_classify_fn fn = jesen_classify_impl;
+  if (!fn) {
+    fn = jesen_classify_select();
+    jesen_classify_impl = fn;
+  }
+#endif
+  return fn;
+}
+
+// UTF-8 validation, run per block next to classification when a parse asks
+// for it. This is the lookup algorithm of Keiser and Lemire ("Validating
+// UTF-8 In Less Than One Instruction Per Byte", 2021): three 16-entry tables,
+// indexed by the nibbles of each byte and of the byte before it, flag every
+// error a two-byte window can show; a second check makes sure the third and
+// fourth bytes of long sequences are continuations. Kernels see a 67-byte
+// window: the last three bytes before the block, then the block itself.
+
+#define JESEN_UTF8_WINDOW (3 + 64)
+
+typedef bool (*jesen_utf8_fn)(const unsigned char *window);
+
+enum {
+  // 11______ 0_______ and 11______ 11______
+  JESEN_UTF8_TOO_SHORT = 1 << 0,
+  // 0_______ 10______
+  JESEN_UTF8_TOO_LONG = 1 << 1,
+  // 11100000 100_____
+  JESEN_UTF8_OVERLONG_3 = 1 << 2,
+  // 11110100 1001____, 11110100 101_____, 11110101+ 10______
+  JESEN_UTF8_TOO_LARGE = 1 << 3,
+  // 11101101 101_____
+  JESEN_UTF8_SURROGATE = 1 << 4,
+  // 1100000_ 10______
+  JESEN_UTF8_OVERLONG_2 = 1 << 5,
+  // 11110101+ 1000____ (TOO_LARGE_1000) and 11110000 1000____ (OVERLONG_4)
+  JESEN_UTF8_TOO_LARGE_1000 = 1 << 6,
+  JESEN_UTF8_OVERLONG_4 = 1 << 6,
+  // 10______ 10______; fine when a three- or four-byte lead calls for it.
+  JESEN_UTF8_TWO_CONTS = 1 << 7,
+  JESEN_UTF8_CARRY =
+      JESEN_UTF8_TOO_SHORT | JESEN_UTF8_TOO_LONG | JESEN_UTF8_TWO_CONTS,
+};
+
+// Indexed by the high nibble of the previous byte.
+static const unsigned char jesen_utf8_byte1_high[16] = {
+    // 0_______: ASCII
+    JESEN_UTF8_TOO_LONG, JESEN_UTF8_TOO_LONG, JESEN_UTF8_TOO_LONG,
+    JESEN_UTF8_TOO_LONG, JESEN_UTF8_TOO_LONG, JESEN_UTF8_TOO_LONG,
+    JESEN_UTF8_TOO_LONG, JESEN_UTF8_TOO_LONG,
+    // 10______: continuation
+    JESEN_UTF8_TWO_CONTS, JESEN_UTF8_TWO_CONTS, JESEN_UTF8_TWO_CONTS,
+    JESEN_UTF8_TWO_CONTS,
+    // 1100____, 1101____: two-byte lead
+    JESEN_UTF8_TOO_SHORT | JESEN_UTF8_OVERLONG_2, JESEN_UTF8_TOO_SHORT,
+    // 1110____: three-byte lead
+    JESEN_UTF8_TOO_SHORT | JESEN_UTF8_OVERLONG_3 | JESEN_UTF8_SURROGATE,
+    // 1111____: four-byte lead
+    JESEN_UTF8_TOO_SHORT | JESEN_UTF8_TOO_LARGE | JESEN_UTF8_TOO_LARGE_1000 |
+        JESEN_UTF8_OVERLONG_4,
+};
+
+// Indexed by the low nibble of the previous byte.
+static const unsigned char jesen_utf8_byte1_low[16] = {
+    // ____0000
+    JESEN_UTF8_CARRY | JESEN_UTF8_OVERLONG_3 | JESEN_UTF8_OVERLONG_2 |
+        JESEN_UTF8_OVERLONG_4,
+    // ____0001
+    JESEN_UTF8_CARRY | JESEN_UTF8_OVERLONG_2,
+    // ____001_
+    JESEN_UTF8_CARRY, JESEN_UTF8_CARRY,
+    // ____0100
+    JESEN_UTF8_CARRY | JESEN_UTF8_TOO_LARGE,
+    // ____0101 to ____1100
+    JESEN_UTF8_CARRY | JESEN_UTF8_TOO_LARGE | JESEN_UTF8_TOO_LARGE_1000,
+    JESEN_UTF8_CARRY | JESEN_UTF8_TOO_LARGE | JESEN_UTF8_TOO_LARGE_1000,
+    JESEN_UTF8_CARRY | JESEN_UTF8_TOO_LARGE | JESEN_UTF8_TOO_LARGE_1000,
+    JESEN_UTF8_CARRY | JESEN_UTF8_TOO_LARGE | JESEN_UTF8_TOO_LARGE_1000,
+    JESEN_UTF8_CARRY | JESEN_UTF8_TOO_LARGE | JESEN_UTF8_TOO_LARGE_1000,
+    JESEN_UTF8_CARRY | JESEN_UTF8_TOO_LARGE | JESEN_UTF8_TOO_LARGE_1000,
+    JESEN_UTF8_CARRY | JESEN_UTF8_TOO_LARGE | JESEN_UTF8_TOO_LARGE_1000,
+    JESEN_UTF8_CARRY | JESEN_UTF8_TOO_LARGE | JESEN_UTF8_TOO_LARGE_1000,
+    // ____1101
+    JESEN_UTF8_CARRY | JESEN_UTF8_TOO_LARGE | JESEN_UTF8_TOO_LARGE_1000 |
+        JESEN_UTF8_SURROGATE,
+    // ____111_
+    JESEN_UTF8_CARRY | JESEN_UTF8_TOO_LARGE | JESEN_UTF8_TOO_LARGE_1000,
+    JESEN_UTF8_CARRY | JESEN_UTF8_TOO_LARGE | JESEN_UTF8_TOO_LARGE_1000,
+};
+
+// Indexed by the high nibble of the current byte.
+static const unsigned char jesen_utf8_byte2_high[16] = {
+    // 0_______: ASCII
+    JESEN_UTF8_TOO_SHORT, JESEN_UTF8_TOO_SHORT, JESEN_UTF8_TOO_SHORT,
+    JESEN_UTF8_TOO_SHORT, JESEN_UTF8_TOO_SHORT, JESEN_UTF8_TOO_SHORT,
+    JESEN_UTF8_TOO_SHORT, JESEN_UTF8_TOO_SHORT,
+    // 1000____
+    JESEN_UTF8_TOO_LONG | JESEN_UTF8_OVERLONG_2 | JESEN_UTF8_TWO_CONTS |
+        JESEN_UTF8_OVERLONG_3 | JESEN_UTF8_TOO_LARGE_1000 |
+        JESEN_UTF8_OVERLONG_4,
+    // 1001____
+    JESEN_UTF8_TOO_LONG | JESEN_UTF8_OVERLONG_2 | JESEN_UTF8_TWO_CONTS |
+        JESEN_UTF8_OVERLONG_3 | JESEN_UTF8_TOO_LARGE,
+    // 101_____
+    JESEN_UTF8_TOO_LONG | JESEN_UTF8_OVERLONG_2 | JESEN_UTF8_TWO_CONTS |
+        JESEN_UTF8_SURROGATE | JESEN_UTF8_TOO_LARGE,
+    JESEN_UTF8_TOO_LONG | JESEN_UTF8_OVERLONG_2 | JESEN_UTF8_TWO_CONTS |
+        JESEN_UTF8_SURROGATE | JESEN_UTF8_TOO_LARGE,
+    // 11______: a lead byte where a continuation was needed
+    JESEN_UTF8_TOO_SHORT, JESEN_UTF8_TOO_SHORT, JESEN_UTF8_TOO_SHORT,
+    JESEN_UTF8_TOO_SHORT,
+};
+
+static bool jesen_utf8_scalar(const unsigned char *window) {
+  unsigned char error = 0;
+  for (int i = 3; i < JESEN_UTF8_WINDOW; ++i) {
+    unsigned char cur = window[i];
+    unsigned char prev1 = window[i - 1];
+    unsigned char special = jesen_utf8_byte1_high[prev1 >> 4] &
+                            jesen_utf8_byte1_low[prev1 & 0x0F] &
+                            jesen_utf8_byte2_high[cur >> 4];
+    unsigned char must_continue =
+        window[i - 2] >= 0xE0 || window[i - 3] >= 0xF0 ? 0x80 : 0;
+    error |= special ^ must_continue;
+  }
+  return error == 0;
+}
+
+#if defined(JESEN_SCAN_X86)
+
+JESEN_TARGET_AVX2
+static bool jesen_utf8_avx2(const unsigned char *window) {
+  const __m256i byte1_high = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i *)jesen_utf8_byte1_high));
+  const __m256i byte1_low = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i *)jesen_utf8_byte1_low));
+  const __m256i byte2_high = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i *)jesen_utf8_byte2_high));
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+  const __m256i third_min = _mm256_set1_epi8((char)(0xE0 - 0x80));
+  const __m256i fourth_min = _mm256_set1_epi8((char)(0xF0 - 0x80));
+  const __m256i high_bit = _mm256_set1_epi8((char)0x80);
+
+  __m256i error = _mm256_setzero_si256();
+  for (int i = 0; i < 2; ++i) {
+    const unsigned char *at = window + 3 + 32 * i;
+    __m256i cur = _mm256_loadu_si256((const __m256i *)at);
+    __m256i prev1 = _mm256_loadu_si256((const __m256i *)(at - 1));
+    __m256i prev2 = _mm256_loadu_si256((const __m256i *)(at - 2));
+    __m256i prev3 = _mm256_loadu_si256((const __m256i *)(at - 3));
+    __m256i special = _mm256_and_si256(
+        _mm256_and_si256(
+            _mm256_shuffle_epi8(
+                byte1_high,
+                _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+            _mm256_shuffle_epi8(byte1_low, _mm256_and_si256(prev1, nibble))),
+        _mm256_shuffle_epi8(
+            byte2_high, _mm256_and_si256(_mm256_srli_epi16(cur, 4), nibble)));
+    // Only bytes >= 0xE0 (resp. 0xF0) keep their top bit after subtracting.
+    __m256i must_continue = _mm256_and_si256(
+        _mm256_or_si256(_mm256_subs_epu8(prev2, third_min),
+                        _mm256_subs_epu8(prev3, fourth_min)),
+        high_bit);
+    error = _mm256_or_si256(error, _mm256_xor_si256(special, must_continue));
+  }
+  return _mm256_testz_si256(error, error) != 0;
+}
+
+#elif defined(JESEN_SCAN_NEON)
+
+static bool jesen_utf8_neon(const unsigned char *window) {
+  const uint8x16_t byte1_high = vld1q_u8(jesen_utf8_byte1_high);
+  const uint8x16_t byte1_low = vld1q_u8(jesen_utf8_byte1_low);
+  const uint8x16_t byte2_high = vld1q_u8(jesen_utf8_byte2_high);
+
+  uint8x16_t error = vdupq_n_u8(0);
+  for (int i = 0; i < 4; ++i) {
+    const unsigned char *at = window + 3 + 16 * i;
+    uint8x16_t cur = vld1q_u8(at);
+    uint8x16_t prev1 = vld1q_u8(at - 1);
+    uint8x16_t prev2 = vld1q_u8(at - 2);
+    uint8x16_t prev3 = vld1q_u8(at - 3);
+    uint8x16_t special =
+        vandq_u8(vandq_u8(vqtbl1q_u8(byte1_high, vshrq_n_u8(prev1, 4)),
+                          vqtbl1q_u8(byte1_low, vandq_u8(prev1,
+                                                         vdupq_n_u8(0x0F)))),
+                 vqtbl1q_u8(byte2_high, vshrq_n_u8(cur, 4)));
+    uint8x16_t must_continue =
+        vandq_u8(vorrq_u8(vcgeq_u8(prev2, vdupq_n_u8(0xE0)),
+                          vcgeq_u8(prev3, vdupq_n_u8(0xF0))),
+                 vdupq_n_u8(0x80));
+    error = vorrq_u8(error, veorq_u8(special, must_continue));
+  }
+  return vmaxvq_u8(error) == 0;
+}
+
+#endif
+
+static jesen_utf8_fn jesen_utf8_select(void) {
+#if defined(JESEN_SCAN_X86)
+  if (jesen_cpu_has_avx2()) {
+    return jesen_utf8_avx2;
+  }
+#elif defined(JESEN_SCAN_NEON)
+  return jesen_utf8_neon;
+#endif
+  return jesen_utf8_scalar;
+}
+
+static jesen_utf8_fn jesen_utf8_impl;
+
+static jesen_utf8_fn jesen_utf8_get(void) {
+#if defined(__GNUC__) || defined(__clang__)
+  jesen_utf8_fn fn = __atomic_load_n(&jesen_utf8_impl, __ATOMIC_RELAXED);
+  if (!fn) {
+    fn = jesen_utf8_select();
+    __atomic_store_n(&jesen_utf8_impl, fn, __ATOMIC_RELAXED);
+  }
+#else
+  jesen_utf8_fn fn = jesen_utf8_impl;
+  if (!fn) {
+    fn = jesen_utf8_select();
+    jesen_utf8_impl = fn;
+  }
+#endif
+  return fn;
+}
+
+// True when the last of these three bytes opens a sequence they do not finish.
+static bool jesen_utf8_incomplete(const unsigned char *last3) {
+  return last3[0] >= 0xF0 || last3[1] >= 0xE0 || last3[2] >= 0xC0;
+}
+
+// Validate one block; `prev` holds the three bytes before it.
+static bool jesen_utf8_block(jesen_utf8_fn validate, const unsigned char *prev,
+                             const unsigned char *block) {
+  uint64_t high = 0;
+  for (int i = 0; i < 64; i += 8) {
+    uint64_t word;
+    memcpy(&word, block + i, sizeof word);
+    high |= word;
+  }
+  // ASCII fast path: nothing to check unless a sequence runs into the block.
+  if ((high & 0x8080808080808080ULL) == 0) {
+    return !jesen_utf8_incomplete(prev);
+  }
+  unsigned char window[JESEN_UTF8_WINDOW];
+  memcpy(window, prev, 3);
+  memcpy(window + 3, block, 64);
+  return validate(window);
+}
+
+static int jesen_ctz64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(x);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+  unsigned long index;
+  _BitScanForward64(&index, x);
+  return (int)index;
+#else
+  int n = 0;
+  while ((x & 1) == 0) {
+    x >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+// Running XOR from the low bit up: bit i is set when an odd number of quotes
+// occur at or below i.
+static uint64_t jesen_prefix_xor(uint64_t x) {
+  x ^= x << 1;
+  x ^= x << 2;
+  x ^= x << 4;
+  x ^= x << 8;
+  x ^= x << 16;
+  x ^= x << 32;
+  return x;
+}
+
+// Bits of characters preceded by an odd run of backslashes, carrying a
+// trailing odd run into the next block.
+static uint64_t jesen_find_escaped(uint64_t backslash, uint64_t *prev_escaped) {
+  const uint64_t even_bits = 0x5555555555555555ULL;
+
+  backslash &= ~*prev_escaped;
+  uint64_t follows_escape = backslash << 1 | *prev_escaped;
+  uint64_t odd_sequence_starts = backslash & ~even_bits & ~follows_escape;
+  uint64_t sequences_starting_on_even_bits = odd_sequence_starts + backslash;
+  *prev_escaped = sequences_starting_on_even_bits < odd_sequence_starts;
+  uint64_t invert_mask = sequences_starting_on_even_bits << 1;
+  return (even_bits ^ invert_mask) & follows_escape;
+}
+
+static void jesen_scanner_refill(jesen_scanner_t *s) {
+  jesen_classify_fn classify = jesen_classify_get();
+  jesen_utf8_fn validate = s->check_utf8 ? jesen_utf8_get() : NULL;
+  s->count = 0;
+  s->next = 0;
+
+  for (int b = 0; b < JESEN_SCAN_BATCH_BLOCKS && s->offset < s->len; ++b) {
+    const unsigned char *block = s->buf + s->offset;
+    unsigned char tail[64];
+    size_t remaining = s->len - s->offset;
+    if (remaining < 64) {
+      // Pad the final partial block with whitespace so trailing scalars end.
+      memset(tail, ' ', sizeof tail);
+      memcpy(tail, block, remaining);
+      block = tail;
+    }
+
+    jesen_block_masks_t m;
+    classify(block, &m);
+
+    if (validate && !s->bad_utf8) {
+      // Kept from the block itself: in-situ parsing rewrites strings that
+      // have been scanned already.
+      s->bad_utf8 = !jesen_utf8_block(validate, s->utf8_tail, block);
+      memcpy(s->utf8_tail, block + 61, 3);
+    }
+
+    uint64_t escaped = jesen_find_escaped(m.backslash, &s->prev_escaped);
+    uint64_t quote = m.quote & ~escaped;
+    uint64_t in_string = jesen_prefix_xor(quote) ^ s->prev_in_string;
+    s->prev_in_string = (uint64_t)((int64_t)in_string >> 63);
+
+    // Content and closing quote of each string literal.
+    uint64_t string_tail = in_string ^ quote;
+    if (m.ctrl & string_tail & ~quote) {
+      s->bad_string = true;
+    }
+
+    uint64_t scalar = ~(m.op | m.ws);
+    uint64_t nonquote_scalar = scalar & ~quote;
+    uint64_t follows_scalar = nonquote_scalar << 1 | s->prev_scalar;
+    s->prev_scalar = nonquote_scalar >> 63;
+
+    uint64_t structurals =
+        ((m.op | (scalar & ~follows_scalar)) & ~string_tail) | quote;
+
+    while (structurals) {
+      s->indices[s->count++] = s->offset + (size_t)jesen_ctz64(structurals);
+      structurals &= structurals - 1;
+    }
+    s->offset += 64;
+  }
+
+  // A padded final block ends in ASCII, which already catches a truncated
+  // sequence; an input that fills its last block exactly is checked here.
+  if (validate && s->offset >= s->len && s->len % 64 == 0 &&
+      jesen_utf8_incomplete(s->utf8_tail)) {
+    s->bad_utf8 = true;
+  }
+}
+
+void jesen_scanner_init(jesen_scanner_t *scanner, const char *buf,
+                        size_t len) {
+  memset(scanner, 0, offsetof(jesen_scanner_t, indices));
+  scanner->buf = (const unsigned char *)buf;
+  scanner->len = len;
+}
+
+void jesen_scanner_resume(jesen_scanner_t *scanner, const char *buf,
+                          size_t len, bool in_string, bool escaped) {
+  jesen_scanner_init(scanner, buf, len);
+  scanner->prev_in_string = in_string ? ~0ULL : 0;
+  scanner->prev_escaped = escaped ? 1 : 0;
+}
+
+bool jesen_scanner_next(jesen_scanner_t *scanner, size_t *out_offset) {
+  while (scanner->next == scanner->count) {
+    if (scanner->offset >= scanner->len) {
+      return false;
+    }
+    jesen_scanner_refill(scanner);
+  }
+  *out_offset = scanner->indices[scanner->next++];
+  return true;
+}
+
+bool jesen_scanner_skip(jesen_scanner_t *scanner, size_t *out_offset) {
+  size_t depth = 1;
+  for (;;) {
+    while (scanner->next == scanner->count) {
+      if (scanner->offset >= scanner->len) {
+        return false;
+      }
+      jesen_scanner_refill(scanner);
+    }
+    // Walk the whole batch in one loop instead of one call per structural.
+    for (size_t i = scanner->next; i < scanner->count; ++i) {
+      unsigned char c = scanner->buf[scanner->indices[i]];
+      if (c == '{' || c == '[') {
+        depth++;
+      } else if ((c == '}' || c == ']') && --depth == 0) {
+        scanner->next = i + 1;
+        *out_offset = scanner->indices[i];
+        return true;
+      }
+    }
+    scanner->next = scanner->count;
+  }
+}
@@ -0,0 +1,483 @@
+#include "jesen_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Tape documents. The parser's builder callbacks append one 64-bit word per
+// value to a single array, tagged in the top byte:
+//
+//   '{' / '['  payload = index just past the matching close word
+//   '}' / ']'  payload = index of the matching open word
+//   'k' / '"'  key / string; payload = arena offset of a size_t length,
+//              the decoded bytes and a NUL
+//   'l' / 'd'  int64 / double; the value is stored in the next word
+//   't' 'f' 'n'
+//
+// Object members are a 'k' word followed by the value, whose first word has
+// JESEN_TAPE_KEYED set; the word before a value cannot tell, since it may be
+// the raw second word of a number. Skipping any value is a single step, and
+// walking a document reads the tape front to back.
+
+#define JESEN_TAPE_TAG_SHIFT 56
+#define JESEN_TAPE_KEYED (UINT64_C(1) << (JESEN_TAPE_TAG_SHIFT - 1))
+#define JESEN_TAPE_PAYLOAD_MASK (JESEN_TAPE_KEYED - 1)
+
+struct jesen_tape {
+  uint64_t *words;
+  size_t count;
+  size_t cap;
+  char *arena;
+  size_t arena_len;
+  size_t arena_cap;
+};
+
+// Builder state: the tape plus the open containers awaiting their close word.
+typedef struct {
+  jesen_tape_t *tape;
+  // a key was just added, so the next value is an object member.
+  bool keyed;
+  size_t depth;
+  size_t stack[JESEN_NESTING_LIMIT];
+} jesen_tape_builder_t;
+
+static uint64_t jesen_tape_word(char tag, uint64_t payload) {
+  return (uint64_t)(unsigned char)tag << JESEN_TAPE_TAG_SHIFT | payload;
+}
+
+static char jesen_tape_tag(const jesen_tape_t *tape, size_t index) {
+  return (char)(tape->words[index] >> JESEN_TAPE_TAG_SHIFT);
+}
+
+static size_t jesen_tape_payload(const jesen_tape_t *tape, size_t index) {
+  return (size_t)(tape->words[index] & JESEN_TAPE_PAYLOAD_MASK);
+}
+
+static jesen_err_t jesen_tape_push(jesen_tape_t *tape, uint64_t word) {
+  if (tape->count == tape->cap) {
+    size_t cap = tape->cap ? tape->cap * 2 : 256;
+    uint64_t *grown = (uint64_t *)realloc(tape->words, cap * sizeof *grown);
+    if (!grown) {
+      return JESEN_ERR_ALLOC;
+    }
+    tape->words = grown;
+    tape->cap = cap;
+  }
+  tape->words[tape->count++] = word;
+  return JESEN_ERR_NONE;
+}
+
+static jesen_err_t jesen_tape_add_string(jesen_tape_t *tape, char tag,
+                                         const char *str, size_t len) {
+  size_t need = sizeof len + len + 1;
+  if (tape->arena_cap - tape->arena_len < need) {
+    size_t cap = tape->arena_cap ? tape->arena_cap : 1024;
+    while (cap - tape->arena_len < need) {
+      cap *= 2;
+    }
+    char *grown = (char *)realloc(tape->arena, cap);
+    if (!grown) {
+      return JESEN_ERR_ALLOC;
+    }
+    tape->arena = grown;
+    tape->arena_cap = cap;
+  }
+  size_t offset = tape->arena_len;
+  memcpy(tape->arena + offset, &len, sizeof len);
+  memcpy(tape->arena + offset + sizeof len, str, len);
+  tape->arena[offset + sizeof len + len] = '\0';
+  tape->arena_len += need;
+  return jesen_tape_push(tape, jesen_tape_word(tag, offset));
+}
+
+// Finish the value whose first word is at `index`, flagging it as a member
+// when a key came before it.
+static jesen_err_t jesen_tape_value(jesen_tape_builder_t *b, size_t index,
+                                    jesen_err_t err) {
+  if (err == JESEN_ERR_NONE && b->keyed) {
+    b->tape->words[index] |= JESEN_TAPE_KEYED;
+  }
+  b->keyed = false;
+  return err;
+}
+
+static jesen_err_t jesen_tape_open(void *ctx, char tag) {
+  jesen_tape_builder_t *b = (jesen_tape_builder_t *)ctx;
+  size_t index = b->tape->count;
+  // The parser enforces the nesting limit before calling back.
+  b->stack[b->depth++] = index;
+  return jesen_tape_value(b, index,
+                          jesen_tape_push(b->tape, jesen_tape_word(tag, 0)));
+}
+
+static jesen_err_t jesen_tape_close(void *ctx, char tag) {
+  jesen_tape_builder_t *b = (jesen_tape_builder_t *)ctx;
+  jesen_tape_t *tape = b->tape;
+  size_t open = b->stack[--b->depth];
+  jesen_err_t err = jesen_tape_push(tape, jesen_tape_word(tag, open));
+  if (err != JESEN_ERR_NONE) {
+    return err;
+  }
+  tape->words[open] |= tape->count;
+  return JESEN_ERR_NONE;
+}
+
+static jesen_err_t jesen_tape_on_begin_object(void *ctx) {
+  return jesen_tape_open(ctx, '{');
+}
+
+static jesen_err_t jesen_tape_on_end_object(void *ctx) {
+  return jesen_tape_close(ctx, '}');
+}
+
+static jesen_err_t jesen_tape_on_begin_array(void *ctx) {
+  return jesen_tape_open(ctx, '[');
+}
+
+static jesen_err_t jesen_tape_on_end_array(void *ctx) {
+  return jesen_tape_close(ctx, ']');
+}
+
+static jesen_err_t jesen_tape_on_key(void *ctx, const char *key, size_t len) {
+  jesen_tape_builder_t *b = (jesen_tape_builder_t *)ctx;
+  jesen_err_t err = jesen_tape_add_string(b->tape, 'k', key, len);
+  b->keyed = err == JESEN_ERR_NONE;
+  return err;
+}
+
+static jesen_err_t jesen_tape_on_string(void *ctx, const char *str,
+                                       size_t len) {
+  jesen_tape_builder_t *b = (jesen_tape_builder_t *)ctx;
+  size_t index = b->tape->count;
+  return jesen_tape_value(b, index,
+                          jesen_tape_add_string(b->tape, '\"', str, len));
+}
+
+static jesen_err_t jesen_tape_add_number(jesen_tape_t *tape, const char *raw,
+                                         size_t len) {
+  int64_t integer = 0;
+  if (jesen_number_to_int64(raw, len, &integer) == JESEN_ERR_NONE) {
+    jesen_err_t err = jesen_tape_push(tape, jesen_tape_word('l', 0));
+    return err != JESEN_ERR_NONE ? err
+                                 : jesen_tape_push(tape, (uint64_t)integer);
+  }
+  double value = 0.0;
+  jesen_err_t err = jesen_number_to_double(raw, len, &value);
+  if (err == JESEN_ERR_NONE) {
+    err = jesen_tape_push(tape, jesen_tape_word('d', 0));
+  }
+  if (err == JESEN_ERR_NONE) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof bits);
+    err = jesen_tape_push(tape, bits);
+  }
+  return err;
+}
+
+static jesen_err_t jesen_tape_on_number(void *ctx, const char *raw,
+                                       size_t len) {
+  jesen_tape_builder_t *b = (jesen_tape_builder_t *)ctx;
+  size_t index = b->tape->count;
+  return jesen_tape_value(b, index, jesen_tape_add_number(b->tape, raw, len));
+}
+
+static jesen_err_t jesen_tape_on_boolean(void *ctx, bool value) {
+  jesen_tape_builder_t *b = (jesen_tape_builder_t *)ctx;
+  size_t index = b->tape->count;
+  uint64_t word = jesen_tape_word(value ? 't' : 'f', 0);
+  return jesen_tape_value(b, index, jesen_tape_push(b->tape, word));
+}
+
+static jesen_err_t jesen_tape_on_null(void *ctx) {
+  jesen_tape_builder_t *b = (jesen_tape_builder_t *)ctx;
+  size_t index = b->tape->count;
+  return jesen_tape_value(b, index,
+                          jesen_tape_push(b->tape, jesen_tape_word('n', 0)));
+}
+
+static const jesen_builder_t jesen_tape_builder = {
+    jesen_tape_on_begin_object, jesen_tape_on_end_object,
+    jesen_tape_on_begin_array,  jesen_tape_on_end_array,
+    jesen_tape_on_key,          jesen_tape_on_string,
+    jesen_tape_on_number,       jesen_tape_on_boolean,
+    jesen_tape_on_null,
+};
+
+// Index just past the value at `index`.
+static size_t jesen_tape_skip(const jesen_tape_t *tape, size_t index) {
+  switch (jesen_tape_tag(tape, index)) {
+  case '{':
+  case '[':
+    return jesen_tape_payload(tape, index);
+  case 'l':
+  case 'd':
+    return index + 2;
+  default:
+    return index + 1;
+  }
+}
+
+static bool jesen_tape_ref_valid(const jesen_tape_ref_t *ref) {
+  return ref && ref->tape && ref->index < ref->tape->count;
+}
+
+// Point `out` at the value starting at `index`, stepping over a key word.
+static jesen_err_t jesen_tape_at(const jesen_tape_t *tape, size_t index,
+                                 jesen_tape_ref_t *out) {
+  char tag = jesen_tape_tag(tape, index);
+  if (tag == '}' || tag == ']') {
+    return JESEN_ERR_NOT_FOUND;
+  }
+  out->tape = tape;
+  out->index = tag == 'k' ? index + 1 : index;
+  return JESEN_ERR_NONE;
+}
+
+static const char *jesen_tape_text(const jesen_tape_t *tape, size_t index,
+                                   size_t *out_len) {
+  const char *entry = tape->arena + jesen_tape_payload(tape, index);
+  memcpy(out_len, entry, sizeof *out_len);
+  return entry + sizeof *out_len;
+}
+
+jesen_err_t jesen_tape_parse(const char *buf, size_t buf_len,
+                             jesen_tape_t **out) {
+  if (!buf || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  jesen_tape_t *tape = (jesen_tape_t *)calloc(1, sizeof *tape);
+  if (!tape) {
+    return JESEN_ERR_ALLOC;
+  }
+  jesen_tape_builder_t b;
+  b.tape = tape;
+  b.keyed = false;
+  b.depth = 0;
+  jesen_err_t err =
+      jesen_parse_with_builder(buf, buf_len, &jesen_tape_builder, &b);
+  if (err != JESEN_ERR_NONE) {
+    jesen_tape_destroy(tape);
+    return err;
+  }
+  *out = tape;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_tape_destroy(jesen_tape_t *tape) {
+  if (!tape) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  free(tape->words);
+  free(tape->arena);
+  free(tape);
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_tape_root(const jesen_tape_t *tape, jesen_tape_ref_t *out) {
+  if (!tape || !out || tape->count == 0) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  out->tape = tape;
+  out->index = 0;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_tape_kind(const jesen_tape_ref_t *ref, jesen_kind_t *out) {
+  if (!jesen_tape_ref_valid(ref) || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  switch (jesen_tape_tag(ref->tape, ref->index)) {
+  case '{':
+    *out = JESEN_KIND_OBJECT;
+    break;
+  case '[':
+    *out = JESEN_KIND_ARRAY;
+    break;
+  case '\"':
+    *out = JESEN_KIND_STRING;
+    break;
+  case 'l':
+  case 'd':
+    *out = JESEN_KIND_NUMBER;
+    break;
+  case 't':
+  case 'f':
+    *out = JESEN_KIND_BOOL;
+    break;
+  case 'n':
+    *out = JESEN_KIND_NULL;
+    break;
+  default:
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_tape_child(const jesen_tape_ref_t *ref,
+                             jesen_tape_ref_t *out) {
+  if (!jesen_tape_ref_valid(ref) || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  char tag = jesen_tape_tag(ref->tape, ref->index);
+  if (tag != '{' && tag != '[') {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+  return jesen_tape_at(ref->tape, ref->index + 1, out);
+}
+
+jesen_err_t jesen_tape_next(const jesen_tape_ref_t *ref,
+                            jesen_tape_ref_t *out) {
+  if (!jesen_tape_ref_valid(ref) || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  size_t next = jesen_tape_skip(ref->tape, ref->index);
+  // The root has no siblings.
+  if (next >= ref->tape->count) {
+    return JESEN_ERR_NOT_FOUND;
+  }
+  return jesen_tape_at(ref->tape, next, out);
+}
+
+jesen_err_t jesen_tape_key(const jesen_tape_ref_t *ref, const char **out,
+                           size_t *out_len) {
+  if (!jesen_tape_ref_valid(ref) || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  if (!(ref->tape->words[ref->index] & JESEN_TAPE_KEYED)) {
+    return JESEN_ERR_NOT_FOUND;
+  }
+  size_t len = 0;
+  *out = jesen_tape_text(ref->tape, ref->index - 1, &len);
+  if (out_len) {
+    *out_len = len;
+  }
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_tape_size(const jesen_tape_ref_t *ref, size_t *out) {
+  if (!jesen_tape_ref_valid(ref) || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  const jesen_tape_t *tape = ref->tape;
+  char tag = jesen_tape_tag(tape, ref->index);
+  if (tag != '{' && tag != '[') {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+  size_t count = 0;
+  size_t end = jesen_tape_payload(tape, ref->index) - 1;
+  for (size_t i = ref->index + 1; i < end; i = jesen_tape_skip(tape, i)) {
+    if (jesen_tape_tag(tape, i) == 'k') {
+      i++;
+    }
+    count++;
+  }
+  *out = count;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_tape_find_field(const jesen_tape_ref_t *object,
+                                  const char *key, jesen_tape_ref_t *out) {
+  if (!jesen_tape_ref_valid(object) || !key || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  const jesen_tape_t *tape = object->tape;
+  if (jesen_tape_tag(tape, object->index) != '{') {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+  size_t key_len = strlen(key);
+  size_t end = jesen_tape_payload(tape, object->index) - 1;
+  size_t found = 0;
+  // Every member is visited, so a repeated key resolves to its last member
+  // as in a parsed tree; each step over a value is a single move.
+  for (size_t i = object->index + 1; i < end;
+       i = jesen_tape_skip(tape, i + 1)) {
+    size_t len = 0;
+    const char *name = jesen_tape_text(tape, i, &len);
+    if (len == key_len && memcmp(name, key, len) == 0) {
+      found = i + 1;
+    }
+  }
+  if (!found) {
+    return JESEN_ERR_NOT_FOUND;
+  }
+  out->tape = tape;
+  out->index = found;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_tape_at_index(const jesen_tape_ref_t *array, size_t index,
+                                jesen_tape_ref_t *out) {
+  if (!jesen_tape_ref_valid(array) || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  const jesen_tape_t *tape = array->tape;
+  if (jesen_tape_tag(tape, array->index) != '[') {
+    return JESEN_ERR_WRONG_TYPE;
+  }
+  size_t end = jesen_tape_payload(tape, array->index) - 1;
+  size_t i = array->index + 1;
+  for (; i < end && index > 0; --index) {
+    i = jesen_tape_skip(tape, i);
+  }
+  if (i >= end) {
+    return JESEN_ERR_OUT_OF_RANGE;
+  }
+  out->tape = tape;
+  out->index = i;
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_tape_get_int64(const jesen_tape_ref_t *ref, int64_t *out) {
+  if (!jesen_tape_ref_valid(ref) || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  if (jesen_tape_tag(ref->tape, ref->index) != 'l') {
+    return JESEN_ERR_INVALID_VALUE_TYPE;
+  }
+  *out = (int64_t)ref->tape->words[ref->index + 1];
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_tape_get_double(const jesen_tape_ref_t *ref, double *out) {
+  if (!jesen_tape_ref_valid(ref) || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  uint64_t bits = 0;
+  switch (jesen_tape_tag(ref->tape, ref->index)) {
+  case 'l':
+    *out = (double)(int64_t)ref->tape->words[ref->index + 1];
+    return JESEN_ERR_NONE;
+  case 'd':
+    bits = ref->tape->words[ref->index + 1];
+    memcpy(out, &bits, sizeof *out);
+    return JESEN_ERR_NONE;
+  default:
+    return JESEN_ERR_INVALID_VALUE_TYPE;
+  }
+}
+
+jesen_err_t jesen_tape_get_bool(const jesen_tape_ref_t *ref, bool *out) {
+  if (!jesen_tape_ref_valid(ref) || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  char tag = jesen_tape_tag(ref->tape, ref->index);
+  if (tag != 't' && tag != 'f') {
+    return JESEN_ERR_INVALID_VALUE_TYPE;
+  }
+  *out = tag == 't';
+  return JESEN_ERR_NONE;
+}
+
+jesen_err_t jesen_tape_get_string(const jesen_tape_ref_t *ref,
+                                  const char **out, size_t *out_len) {
+  if (!jesen_tape_ref_valid(ref) || !out) {
+    return JESEN_ERR_INVALID_ARGS;
+  }
+  if (jesen_tape_tag(ref->tape, ref->index) != '\"') {
+    return JESEN_ERR_INVALID_VALUE_TYPE;
+  }
+  size_t len = 0;
+  *out = jesen_tape_text(ref->tape, ref->index, &len);
+  if (out_len) {
+    *out_len = len;
+  }
+  return JESEN_ERR_NONE;
+}
@@ -0,0 +1,108 @@
+#include "jesen_internal.h"
+#include <stdlib.h>
+
+#if defined(JESEN_HAVE_PTHREADS)
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// Minimal fork/join pool for the parallel parse entry points. Tasks are
+// claimed from a shared counter, so uneven task sizes still balance; the
+// calling thread works alongside the spawned ones. Shared state is only
+// touched atomically when threads are available.
+
+typedef struct {
+  jesen_task_fn fn;
+  void *ctx;
+  size_t tasks;
+  size_t next;
+  // first failure; once set, no further tasks are claimed.
+  jesen_err_t err;
+} jesen_pool_t;
+
+static size_t jesen_pool_claim(jesen_pool_t *pool) {
+#if defined(JESEN_HAVE_PTHREADS)
+  return __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED);
+#else
+  return pool->next++;
+#endif
+}
+
+static jesen_err_t jesen_pool_status(jesen_pool_t *pool) {
+#if defined(JESEN_HAVE_PTHREADS)
+  return __atomic_load_n(&pool->err, __ATOMIC_RELAXED);
+#else
+  return pool->err;
+#endif
+}
+
+// Record the first failure; later ones are dropped.
+static void jesen_pool_fail(jesen_pool_t *pool, jesen_err_t err) {
+#if defined(JESEN_HAVE_PTHREADS)
+  jesen_err_t none = JESEN_ERR_NONE;
+  __atomic_compare_exchange_n(&pool->err, &none, err, false, __ATOMIC_RELAXED,
+                              __ATOMIC_RELAXED);
+#else
+  if (pool->err == JESEN_ERR_NONE) {
+    pool->err = err;
+  }
+#endif
+}
+
+static void *jesen_pool_worker(void *arg) {
+  jesen_pool_t *pool = (jesen_pool_t *)arg;
+  while (jesen_pool_status(pool) == JESEN_ERR_NONE) {
+    size_t task = jesen_pool_claim(pool);
+    if (task >= pool->tasks) {
+      break;
+    }
+    jesen_err_t err = pool->fn(pool->ctx, task);
+    if (err != JESEN_ERR_NONE) {
+      jesen_pool_fail(pool, err);
+    }
+  }
+  return NULL;
+}
+
+size_t jesen_thread_count(size_t requested) {
+#if defined(JESEN_HAVE_PTHREADS)
+  if (requested == 0) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    requested = online > 0 ? (size_t)online : 1;
+  }
+  return requested;
+#else
+  (void)requested;
+  return 1;
+#endif
+}
+
+jesen_err_t jesen_run_tasks(size_t threads, size_t tasks, jesen_task_fn fn,
+                            void *ctx) {
+  jesen_pool_t pool = {fn, ctx, tasks, 0, JESEN_ERR_NONE};
+  if (threads > tasks) {
+    threads = tasks;
+  }
+#if defined(JESEN_HAVE_PTHREADS)
+  pthread_t *spawned = NULL;
+  size_t started = 0;
+  if (threads > 1) {
+    spawned = (pthread_t *)malloc((threads - 1) * sizeof *spawned);
+  }
+  // If threads cannot be created the remaining ones simply do more work.
+  while (spawned && started < threads - 1 &&
+         pthread_create(&spawned[started], NULL, jesen_pool_worker, &pool) ==
+             0) {
+    started++;
+  }
+  jesen_pool_worker(&pool);
+  for (size_t i = 0; i < started; ++i) {
+    pthread_join(spawned[i], NULL);
+  }
+  free(spawned);
+#else
+  (void)threads;
+  jesen_pool_worker(&pool);
+#endif
+  return pool.err;
+}
@@ -0,0 +1,149 @@
+#include "jesen_internal.h"
+#include <string.h>
+
+#if !defined(JESEN_DISABLE_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) ||                                  \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JESEN_WRITER_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define JESEN_WRITER_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// Output primitives shared by both backends' serializers, so they emit
+// byte-identical text. Every write checks room for the bytes plus a
+// terminator up front and leaves the writer untouched when it does not fit.
+// String bodies are checked 16 bytes at a time for bytes that need escaping,
+// so the long clean runs of typical text are copied with one memcpy each.
+
+char *jesen_writer_reserve(jesen_writer_t *w, size_t n) {
+  if (w->cap - w->len < n + 1) {
+    return NULL;
+  }
+  return w->buf + w->len;
+}
+
+bool jesen_writer_put(jesen_writer_t *w, const char *data, size_t n) {
+  char *dst = jesen_writer_reserve(w, n);
+  if (!dst) {
+    return false;
+  }
+  memcpy(dst, data, n);
+  w->len += n;
+  return true;
+}
+
+bool jesen_writer_number(jesen_writer_t *w, double d) {
+  char number_buffer[JESEN_NUMBER_FORMAT_MAX];
+  return jesen_writer_put(w, number_buffer,
+                          jesen_format_double(d, number_buffer));
+}
+
+static bool jesen_writer_needs_escape(unsigned char c) {
+  return c < 32 || c == '\"' || c == '\\';
+}
+
+// Length of the prefix of `str` that can be copied without escaping.
+static size_t jesen_writer_clean_run(const char *str, size_t len) {
+  size_t i = 0;
+#if defined(JESEN_WRITER_SSE2)
+  const __m128i quote = _mm_set1_epi8('\"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i ctrl_max = _mm_set1_epi8(0x1F);
+  for (; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(str + i));
+    __m128i special = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+        _mm_cmpeq_epi8(_mm_min_epu8(v, ctrl_max), v));
+    unsigned mask = (unsigned)_mm_movemask_epi8(special);
+    if (mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+      unsigned long index;
+      _BitScanForward(&index, mask);
+      return i + index;
+#else
+      return i + (size_t)__builtin_ctz(mask);
+#endif
+    }
+  }
+#elif defined(JESEN_WRITER_NEON)
+  for (; i + 16 <= len; i += 16) {
+    uint8x16_t v = vld1q_u8((const uint8_t *)(str + i));
+    uint8x16_t special =
+        vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8('\"')),
+                          vceqq_u8(v, vdupq_n_u8('\\'))),
+                 vcleq_u8(v, vdupq_n_u8(0x1F)));
+    if (vmaxvq_u8(special)) {
+      // The scalar loop below finds the byte within this block.
+      break;
+    }
+  }
+#endif
+  while (i < len && !jesen_writer_needs_escape((unsigned char)str[i])) {
+    i++;
+  }
+  return i;
+}
+
+// Escape one byte the way cJSON does: short forms where JSON has them,
+// \u00XX for the remaining control characters.
+static bool jesen_writer_escape(jesen_writer_t *w, unsigned char c) {
+  static const char hex[] = "0123456789abcdef";
+  char seq[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+  switch (c) {
+  case '\\':
+  case '\"':
+    seq[1] = (char)c;
+    return jesen_writer_put(w, seq, 2);
+  case '\b':
+    seq[1] = 'b';
+    return jesen_writer_put(w, seq, 2);
+  case '\f':
+    seq[1] = 'f';
+    return jesen_writer_put(w, seq, 2);
+  case '\n':
+    seq[1] = 'n';
+    return jesen_writer_put(w, seq, 2);
+  case '\r':
+    seq[1] = 'r';
+    return jesen_writer_put(w, seq, 2);
+  case '\t':
+    seq[1] = 't';
+    return jesen_writer_put(w, seq, 2);
+  default:
+    return jesen_writer_put(w, seq, 6);
+  }
+}
+
+bool jesen_writer_string(jesen_writer_t *w, const char *str, size_t len) {
+  // Write through a copy so a string that does not fit leaves `w` as it was.
+  jesen_writer_t out = *w;
+  if (!jesen_writer_put(&out, "\"", 1)) {
+    return false;
+  }
+  size_t i = 0;
+  for (;;) {
+    size_t run = jesen_writer_clean_run(str + i, len - i);
+    if (!jesen_writer_put(&out, str + i, run)) {
+      return false;
+    }
+    i += run;
+    if (i == len) {
+      break;
+    }
+    if (!jesen_writer_escape(&out, (unsigned char)str[i++])) {
+      return false;
+    }
+  }
+  if (!jesen_writer_put(&out, "\"", 1)) {
+    return false;
+  }
+  w->len = out.len;
+  return true;
+}
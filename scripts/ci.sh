@@ -14,3 +14,5 @@ run_build() {
 
 run_build "$repo_root/build-static" -DJESEN_BUILD_TESTS=ON -DJESEN_BUILD_SHARED=OFF
 run_build "$repo_root/build-shared" -DJESEN_BUILD_TESTS=ON -DJESEN_BUILD_SHARED=ON
+run_build "$repo_root/build-native-static" -DJESEN_BUILD_TESTS=ON -DJESEN_BUILD_SHARED=OFF -DJESEN_BACKEND=native
+run_build "$repo_root/build-native-shared" -DJESEN_BUILD_TESTS=ON -DJESEN_BUILD_SHARED=ON -DJESEN_BACKEND=native
@@ -2,6 +2,7 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #define EXPECT_OK(expr) assert((expr) == JESEN_ERR_NONE)
@@ -123,6 +124,1479 @@ static void test_parse_wrapper(void) {
   EXPECT_OK(jesen_destroy(root));
 }
 
+static void test_parse_lazy(void) {
+  const char *json =
+      "{\"user\":{\"id\":7,\"tags\":[\"a\",\"b\"]},\"skip\":[1,2,3]}";
+  jesen_node_t *root = NULL;
+  EXPECT_OK(jesen_parse(json, strlen(json), &root));
+
+  size_t size = 0;
+  EXPECT_OK(jesen_object_size(root, &size));
+  assert(size == 2);
+
+  jesen_node_t *user = NULL;
+  EXPECT_OK(jesen_node_find(root, "user", &user));
+  jesen_node_t *again = NULL;
+  EXPECT_OK(jesen_node_find(root, "user", &again));
+  assert(user == again);
+
+  char buf[64];
+  size_t out_len = 0;
+  EXPECT_OK(jesen_object_get_array_string(user, "tags", 1, buf, sizeof buf,
+                                          &out_len));
+  assert(out_len == 1 && strcmp(buf, "b") == 0);
+
+  EXPECT_OK(jesen_object_add_int32(user, "rank", 3));
+  EXPECT_OK(jesen_object_remove(root, "skip"));
+  EXPECT_OK(jesen_object_size(user, &size));
+  assert(size == 3);
+
+  EXPECT_OK(jesen_serialize(root, buf, sizeof buf));
+  assert(strcmp(buf, "{\"user\":{\"id\":7,\"tags\":[\"a\",\"b\"],\"rank\":3}}") ==
+         0);
+
+  EXPECT_OK(jesen_destroy(root));
+}
+
+static void test_parse_roundtrip(void) {
+  const char *json = "{\"s\":\"a\\n\\u00e9\\\"\",\"n\":[1,-2.5,1e+20],"
+                     "\"o\":{\"t\":true,\"f\":false,\"z\":null}}";
+  jesen_node_t *root = NULL;
+  EXPECT_OK(jesen_parse(json, strlen(json), &root));
+
+  char buf[128];
+  size_t out_len = 0;
+  EXPECT_OK(jesen_object_get_string(root, "s", buf, sizeof buf, &out_len));
+  assert(out_len == 5 && memcmp(buf, "a\n\xc3\xa9\"", 5) == 0);
+
+  EXPECT_OK(jesen_serialize(root, buf, sizeof buf));
+  assert(strcmp(buf, "{\"s\":\"a\\n\xc3\xa9\\\"\",\"n\":[1,-2.5,1e+20],"
+                     "\"o\":{\"t\":true,\"f\":false,\"z\":null}}") == 0);
+  assert(jesen_serialize(root, buf, 8) == JESEN_ERR_BUFFER_TOO_SMALL);
+  EXPECT_OK(jesen_destroy(root));
+
+  const char *bad[] = {"{\"a\" 1}", "[1,2", "\"open", "nul"};
+  for (size_t i = 0; i < sizeof bad / sizeof bad[0]; ++i) {
+    root = NULL;
+    assert(jesen_parse(bad[i], strlen(bad[i]), &root) == JESEN_ERR_PARSE);
+  }
+}
+
+static void test_parse_block_boundaries(void) {
+  // Strings whose escapes and closing quotes straddle 64-byte scan blocks.
+  char json[1024];
+  size_t n = 0;
+  json[n++] = '[';
+  for (size_t i = 0; i < 6; ++i) {
+    if (i) {
+      memcpy(json + n, " , ", 3);
+      n += 3;
+    }
+    json[n++] = '"';
+    memset(json + n, '.', 40 + i * 7);
+    n += 40 + i * 7;
+    memcpy(json + n, "\\\\\\\"{[,:]}\"", 11);
+    n += 11;
+  }
+  const char *tail = ", {\"k\" :\t-0.5e3 }, true ]\n";
+  memcpy(json + n, tail, strlen(tail));
+  n += strlen(tail);
+
+  jesen_node_t *root = NULL;
+  EXPECT_OK(jesen_parse(json, n, &root));
+  size_t count = 0;
+  EXPECT_OK(jesen_array_size(root, &count));
+  assert(count == 8);
+
+  char buf[128];
+  size_t out_len = 0;
+  EXPECT_OK(jesen_array_get_string(root, 5, buf, sizeof buf, &out_len));
+  assert(out_len == 75 + 8 && memcmp(buf + 75, "\\\"{[,:]}", 8) == 0);
+  double d = 0;
+  EXPECT_OK(jesen_array_get_object_double(root, 6, "k", &d));
+  assert(d == -500.0);
+  EXPECT_OK(jesen_destroy(root));
+
+  const char *bad = "[\"tab\there\"]";
+  root = NULL;
+  assert(jesen_parse(bad, strlen(bad), &root) == JESEN_ERR_PARSE);
+}
+
+static void test_parse_insitu(void) {
+  char json[] = "{\"name\":\"a\\tb\",\"tags\":[\"x\",\"y\\u00e9\"],\"n\":3}";
+  jesen_node_t *root = NULL;
+  EXPECT_OK(jesen_parse_insitu(json, sizeof json - 1, &root));
+
+  jesen_node_t *name = NULL;
+  EXPECT_OK(jesen_node_find(root, "name", &name));
+  const char *str = NULL;
+  size_t len = 0;
+  EXPECT_OK(jesen_value_get_string_ref(name, &str, &len));
+  assert(len == 3 && strcmp(str, "a\tb") == 0);
+  assert(str >= json && str < json + sizeof json);
+
+  char buf[128];
+  EXPECT_OK(jesen_object_get_array_string(root, "tags", 1, buf, sizeof buf,
+                                          &len));
+  assert(len == 3 && strcmp(buf, "y\xc3\xa9") == 0);
+
+  // Borrowed keys and strings mix with owned ones under mutation.
+  EXPECT_OK(jesen_object_add_string(root, "owned", "copy", 4));
+  EXPECT_OK(jesen_node_detach(name));
+  jesen_node_t *other = NULL;
+  EXPECT_OK(jesen_object_create(&other));
+  EXPECT_OK(jesen_node_assign_to(other, "renamed", name));
+  EXPECT_OK(jesen_object_remove(root, "tags"));
+  EXPECT_OK(jesen_serialize(root, buf, sizeof buf));
+  assert(strcmp(buf, "{\"n\":3,\"owned\":\"copy\"}") == 0);
+  EXPECT_OK(jesen_serialize(other, buf, sizeof buf));
+  assert(strcmp(buf, "{\"renamed\":\"a\\tb\"}") == 0);
+  EXPECT_OK(jesen_destroy(other));
+  EXPECT_OK(jesen_destroy(root));
+
+  char bad[] = "[\"unterminated]";
+  root = NULL;
+  assert(jesen_parse_insitu(bad, sizeof bad - 1, &root) == JESEN_ERR_PARSE);
+}
+
+static void test_push_parser(void) {
+  const char *json = "\xEF\xBB\xBF{\"k\\u00e9y\":[12.5e-1,\"a\\\"b\",true,null],"
+                     "\"n\":-0}";
+  jesen_parser_t *parser = NULL;
+  EXPECT_OK(jesen_parser_create(&parser));
+
+  // One byte at a time splits every token, escape and the byte order mark.
+  for (size_t i = 0; i < strlen(json); ++i) {
+    EXPECT_OK(jesen_parser_feed(parser, json + i, 1));
+  }
+  jesen_node_t *root = NULL;
+  EXPECT_OK(jesen_parser_finish(parser, &root));
+  char pushed[128];
+  EXPECT_OK(jesen_serialize(root, pushed, sizeof pushed));
+  EXPECT_OK(jesen_destroy(root));
+
+  jesen_node_t *whole = NULL;
+  EXPECT_OK(jesen_parse(json, strlen(json), &whole));
+  char parsed[128];
+  EXPECT_OK(jesen_serialize(whole, parsed, sizeof parsed));
+  EXPECT_OK(jesen_destroy(whole));
+  assert(strcmp(pushed, parsed) == 0);
+
+  // The parser is reusable after finish; a bare number ends at end of input.
+  EXPECT_OK(jesen_parser_feed(parser, "4", 1));
+  EXPECT_OK(jesen_parser_feed(parser, "2", 1));
+  root = NULL;
+  EXPECT_OK(jesen_parser_finish(parser, &root));
+  int32_t value = 0;
+  EXPECT_OK(jesen_value_get_int32(root, &value));
+  assert(value == 42);
+  EXPECT_OK(jesen_destroy(root));
+
+  // Incomplete and malformed input.
+  EXPECT_OK(jesen_parser_feed(parser, "[1,", 3));
+  root = NULL;
+  assert(jesen_parser_finish(parser, &root) == JESEN_ERR_PARSE);
+  assert(jesen_parser_feed(parser, "[01]", 4) == JESEN_ERR_PARSE);
+  assert(jesen_parser_feed(parser, "]", 1) == JESEN_ERR_PARSE);
+  assert(jesen_parser_finish(parser, &root) == JESEN_ERR_PARSE);
+
+  // Destroying mid-document releases the partial tree.
+  EXPECT_OK(jesen_parser_feed(parser, "{\"a\":[\"x", 8));
+  EXPECT_OK(jesen_parser_destroy(parser));
+}
+
+typedef struct {
+  int containers;
+  int scalars;
+  double sum;
+  const char *stop_key;
+} event_counts_t;
+
+static jesen_err_t count_container(void *ctx) {
+  ((event_counts_t *)ctx)->containers++;
+  return JESEN_ERR_NONE;
+}
+
+static jesen_err_t count_key(void *ctx, const char *key, size_t len) {
+  event_counts_t *counts = (event_counts_t *)ctx;
+  if (counts->stop_key && strlen(counts->stop_key) == len &&
+      memcmp(counts->stop_key, key, len) == 0) {
+    return JESEN_ERR_STOPPED;
+  }
+  return JESEN_ERR_NONE;
+}
+
+static jesen_err_t count_number(void *ctx, const char *raw, size_t len) {
+  event_counts_t *counts = (event_counts_t *)ctx;
+  char tmp[32];
+  assert(len < sizeof tmp);
+  memcpy(tmp, raw, len);
+  tmp[len] = '\0';
+  counts->scalars++;
+  counts->sum += atof(tmp);
+  return JESEN_ERR_NONE;
+}
+
+static jesen_err_t count_boolean(void *ctx, bool value) {
+  (void)value;
+  ((event_counts_t *)ctx)->scalars++;
+  return JESEN_ERR_NONE;
+}
+
+static void test_parse_events(void) {
+  const char *json = "{\"a\":[1,2.5,true],\"b\":{\"c\":-1},\"d\":[]}";
+  jesen_handler_t handler;
+  memset(&handler, 0, sizeof handler);
+  handler.begin_object = count_container;
+  handler.begin_array = count_container;
+  handler.key = count_key;
+  handler.number = count_number;
+  handler.boolean = count_boolean;
+
+  event_counts_t counts = {0, 0, 0.0, NULL};
+  EXPECT_OK(jesen_parse_events(json, strlen(json), &handler, &counts));
+  assert(counts.containers == 4 && counts.scalars == 4 && counts.sum == 2.5);
+
+  // A handler stops the walk before the rest of the document is read.
+  event_counts_t stopped = {0, 0, 0.0, "b"};
+  assert(jesen_parse_events(json, strlen(json), &handler, &stopped) ==
+         JESEN_ERR_STOPPED);
+  assert(stopped.containers == 2 && stopped.scalars == 3);
+
+  const char *bad = "[1,2,}";
+  assert(jesen_parse_events(bad, strlen(bad), &handler, &counts) ==
+         JESEN_ERR_PARSE);
+}
+
+static jesen_err_t collect_record(void *ctx, size_t index, jesen_node_t *root) {
+  jesen_node_t **slots = (jesen_node_t **)ctx;
+  assert(index < 200 && !slots[index]);
+  slots[index] = root;
+  return JESEN_ERR_NONE;
+}
+
+static void test_parse_ndjson(void) {
+  // Enough records for several chunks, with blank and CRLF lines mixed in.
+  static char text[200 * 1024];
+  size_t len = 0;
+  for (int i = 0; i < 200; ++i) {
+    len += (size_t)sprintf(text + len, "{\"i\":%d,\"pad\":\"%0*d\"}%s", i,
+                           900, 0, i % 3 == 0 ? "\r\n\n" : "\n");
+  }
+
+  jesen_node_t **roots = NULL;
+  size_t count = 0;
+  EXPECT_OK(jesen_parse_ndjson(text, len, 4, &roots, &count));
+  assert(count == 200);
+  for (size_t i = 0; i < count; ++i) {
+    int32_t value = -1;
+    EXPECT_OK(jesen_object_get_int32(roots[i], "i", &value));
+    assert(value == (int32_t)i);
+  }
+  EXPECT_OK(jesen_roots_destroy(roots, count));
+
+  jesen_node_t *slots[200] = {NULL};
+  EXPECT_OK(jesen_parse_ndjson_each(text, len, 3, collect_record, slots));
+  for (size_t i = 0; i < 200; ++i) {
+    int32_t value = -1;
+    EXPECT_OK(jesen_object_get_int32(slots[i], "i", &value));
+    assert(value == (int32_t)i);
+    EXPECT_OK(jesen_destroy(slots[i]));
+  }
+
+  const char *bad = "{\"a\":1}\n{\"a\":\n";
+  roots = NULL;
+  assert(jesen_parse_ndjson(bad, strlen(bad), 0, &roots, &count) ==
+         JESEN_ERR_PARSE);
+  assert(roots == NULL);
+}
+
+static void test_parse_parallel(void) {
+  // A large array whose strings hide brackets, commas and escaped quotes,
+  // with some long enough to straddle the split points.
+  size_t cap = 3 * 1024 * 1024;
+  char *text = (char *)malloc(cap);
+  assert(text);
+  size_t len = 0;
+  text[len++] = '[';
+  for (int i = 0; len < cap - 32 * 1024; ++i) {
+    if (i) {
+      text[len++] = ',';
+    }
+    if (i % 97 == 0) {
+      len += (size_t)sprintf(text + len, "\"%d", i);
+      for (int j = 0; j < 2000; ++j) {
+        len += (size_t)sprintf(text + len, "],\\\"[\\\\");
+      }
+      text[len++] = '"';
+    } else {
+      len += (size_t)sprintf(text + len,
+                             "{\"k\":[%d,\"a,]}\\\"[\"],\"n\":[[1,2],[]]}", i);
+    }
+  }
+  text[len++] = ']';
+  text[len++] = '\n';
+
+  jesen_node_t *seq = NULL;
+  jesen_node_t *par = NULL;
+  EXPECT_OK(jesen_parse(text, len, &seq));
+  EXPECT_OK(jesen_parse_parallel(text, len, 4, &par));
+  size_t seq_size = 0;
+  size_t par_size = 0;
+  EXPECT_OK(jesen_array_size(seq, &seq_size));
+  EXPECT_OK(jesen_array_size(par, &par_size));
+  assert(seq_size == par_size && seq_size > 1000);
+
+  char *seq_out = (char *)malloc(2 * cap);
+  char *par_out = (char *)malloc(2 * cap);
+  assert(seq_out && par_out);
+  EXPECT_OK(jesen_serialize(seq, seq_out, 2 * cap));
+  EXPECT_OK(jesen_serialize(par, par_out, 2 * cap));
+  assert(strcmp(seq_out, par_out) == 0);
+  free(seq_out);
+  free(par_out);
+  EXPECT_OK(jesen_destroy(seq));
+  EXPECT_OK(jesen_destroy(par));
+
+  // A broken element deep inside fails the same way as a sequential parse.
+  text[len / 2] = '\x01';
+  seq = NULL;
+  par = NULL;
+  assert(jesen_parse(text, len, &seq) == JESEN_ERR_PARSE);
+  assert(jesen_parse_parallel(text, len, 4, &par) == JESEN_ERR_PARSE);
+  assert(par == NULL);
+
+  // Non-array roots fall back to the sequential parser.
+  EXPECT_OK(jesen_parse_parallel("{\"a\":[1]}", 9, 4, &par));
+  EXPECT_OK(jesen_destroy(par));
+  free(text);
+}
+
+static void test_cursor(void) {
+  const char *json =
+      " {\"skip\":{\"x\":[1,\"]}\",{}]},\"id\":-9223372036854775808,"
+      "\"name\":\"caf\\u00e9 \\\"q\\\"\",\"ok\":true,\"none\":null,"
+      "\"list\":[10,2.5,\"s\",[3],{\"k\":\"v\"}],\"big\":1e3} ";
+  jesen_cursor_t doc;
+  EXPECT_OK(jesen_cursor_init(json, strlen(json), &doc));
+
+  jesen_cursor_t value;
+  int64_t i = 0;
+  EXPECT_OK(jesen_cursor_find_field(&doc, "id", &value));
+  EXPECT_OK(jesen_cursor_get_int64(&value, &i));
+  assert(i == INT64_MIN);
+
+  const char *view = NULL;
+  size_t len = 0;
+  char buf[32];
+  EXPECT_OK(jesen_cursor_find_field(&doc, "name", &value));
+  EXPECT_OK(jesen_cursor_get_string_view(&value, &view, &len));
+  assert(len == 15 && memcmp(view, "caf\\u00e9 \\\"q\\\"", len) == 0);
+  EXPECT_OK(jesen_cursor_get_string(&value, buf, sizeof buf, &len));
+  assert(len == 9 && strcmp(buf, "caf\xc3\xa9 \"q\"") == 0);
+  assert(jesen_cursor_get_string(&value, buf, 9, &len) ==
+         JESEN_ERR_INVALID_ARGS);
+
+  // Lookups need not follow document order.
+  jesen_cursor_t skip;
+  EXPECT_OK(jesen_cursor_find_field(&doc, "skip", &skip));
+  EXPECT_OK(jesen_cursor_get_raw(&skip, &view, &len));
+  assert(len == 17 && memcmp(view, "{\"x\":[1,\"]}\",{}]}", len) == 0);
+  assert(jesen_cursor_find_field(&doc, "missing", &value) ==
+         JESEN_ERR_NOT_FOUND);
+  assert(jesen_cursor_find_field(&skip, "y", &value) == JESEN_ERR_NOT_FOUND);
+
+  bool flag = false;
+  EXPECT_OK(jesen_cursor_find_field(&doc, "ok", &value));
+  EXPECT_OK(jesen_cursor_get_bool(&value, &flag));
+  assert(flag);
+  EXPECT_OK(jesen_cursor_find_field(&doc, "none", &value));
+  EXPECT_OK(jesen_cursor_is_null(&value, &flag));
+  assert(flag);
+
+  jesen_cursor_t list;
+  jesen_cursor_t item;
+  double d = 0;
+  EXPECT_OK(jesen_cursor_find_field(&doc, "list", &list));
+  EXPECT_OK(jesen_cursor_at_index(&list, 1, &item));
+  EXPECT_OK(jesen_cursor_get_double(&item, &d));
+  assert(d == 2.5);
+  assert(jesen_cursor_get_int64(&item, &i) == JESEN_ERR_INVALID_VALUE_TYPE);
+  EXPECT_OK(jesen_cursor_next(&item));
+  assert(jesen_cursor_get_int64(&item, &i) == JESEN_ERR_INVALID_VALUE_TYPE);
+  EXPECT_OK(jesen_cursor_next(&item));
+  EXPECT_OK(jesen_cursor_next(&item));
+  EXPECT_OK(jesen_cursor_find_field(&item, "k", &value));
+  EXPECT_OK(jesen_cursor_get_string(&value, buf, sizeof buf, &len));
+  assert(strcmp(buf, "v") == 0);
+  assert(jesen_cursor_next(&item) == JESEN_ERR_NOT_FOUND);
+  assert(jesen_cursor_next(&value) == JESEN_ERR_WRONG_TYPE);
+  assert(jesen_cursor_at_index(&list, 5, &item) == JESEN_ERR_OUT_OF_RANGE);
+  assert(jesen_cursor_at_index(&doc, 0, &item) == JESEN_ERR_WRONG_TYPE);
+
+  // With a repeated key the first member wins, whatever was looked up
+  // before.
+  const char *dup = "{\"a\":1,\"b\":2,\"a\":3}";
+  EXPECT_OK(jesen_cursor_init(dup, strlen(dup), &doc));
+  for (int pass = 0; pass < 2; ++pass) {
+    EXPECT_OK(jesen_cursor_find_field(&doc, "a", &value));
+    EXPECT_OK(jesen_cursor_get_int64(&value, &i));
+    assert(i == 1);
+    EXPECT_OK(jesen_cursor_find_field(&doc, "b", &value));
+  }
+
+  // Errors surface only once a cursor reaches the damage.
+  const char *bad = "{\"a\":1,\"b\":[1,2,\"c\":3";
+  EXPECT_OK(jesen_cursor_init(bad, strlen(bad), &doc));
+  EXPECT_OK(jesen_cursor_find_field(&doc, "a", &value));
+  assert(jesen_cursor_find_field(&doc, "c", &value) == JESEN_ERR_PARSE);
+  assert(jesen_cursor_init("  ", 2, &doc) == JESEN_ERR_PARSE);
+}
+
+static void test_tape(void) {
+  const char *json = "{\"a\":[1,{\"deep\":[[],{}]},\"x\\u00e9\",-2.5,true,null],"
+                     "\"b\":{},\"big\":9223372036854775808,\"c\":false}";
+  jesen_tape_t *tape = NULL;
+  EXPECT_OK(jesen_tape_parse(json, strlen(json), &tape));
+
+  jesen_tape_ref_t root;
+  jesen_tape_ref_t a;
+  jesen_tape_ref_t item;
+  jesen_kind_t kind;
+  size_t count = 0;
+  EXPECT_OK(jesen_tape_root(tape, &root));
+  EXPECT_OK(jesen_tape_kind(&root, &kind));
+  assert(kind == JESEN_KIND_OBJECT);
+  EXPECT_OK(jesen_tape_size(&root, &count));
+  assert(count == 4);
+
+  EXPECT_OK(jesen_tape_find_field(&root, "a", &a));
+  EXPECT_OK(jesen_tape_size(&a, &count));
+  assert(count == 6);
+  int64_t i = 0;
+  EXPECT_OK(jesen_tape_child(&a, &item));
+  EXPECT_OK(jesen_tape_get_int64(&item, &i));
+  assert(i == 1);
+
+  // The nested object is stepped over in one move.
+  EXPECT_OK(jesen_tape_next(&item, &item));
+  EXPECT_OK(jesen_tape_kind(&item, &kind));
+  assert(kind == JESEN_KIND_OBJECT);
+  EXPECT_OK(jesen_tape_next(&item, &item));
+  const char *str = NULL;
+  size_t len = 0;
+  EXPECT_OK(jesen_tape_get_string(&item, &str, &len));
+  assert(len == 3 && strcmp(str, "x\xc3\xa9") == 0);
+  assert(jesen_tape_key(&item, &str, &len) == JESEN_ERR_NOT_FOUND);
+
+  double d = 0;
+  bool flag = false;
+  EXPECT_OK(jesen_tape_at_index(&a, 3, &item));
+  EXPECT_OK(jesen_tape_get_double(&item, &d));
+  assert(d == -2.5);
+  assert(jesen_tape_get_int64(&item, &i) == JESEN_ERR_INVALID_VALUE_TYPE);
+  EXPECT_OK(jesen_tape_next(&item, &item));
+  EXPECT_OK(jesen_tape_get_bool(&item, &flag));
+  assert(flag);
+  EXPECT_OK(jesen_tape_next(&item, &item));
+  EXPECT_OK(jesen_tape_kind(&item, &kind));
+  assert(kind == JESEN_KIND_NULL);
+  assert(jesen_tape_next(&item, &item) == JESEN_ERR_NOT_FOUND);
+  assert(jesen_tape_at_index(&a, 6, &item) == JESEN_ERR_OUT_OF_RANGE);
+
+  // Members come back with their keys, in document order.
+  const char *keys[] = {"a", "b", "big", "c"};
+  EXPECT_OK(jesen_tape_child(&root, &item));
+  for (size_t k = 0; k < 4; ++k) {
+    EXPECT_OK(jesen_tape_key(&item, &str, &len));
+    assert(strcmp(str, keys[k]) == 0);
+    jesen_err_t err = jesen_tape_next(&item, &item);
+    assert(k < 3 ? err == JESEN_ERR_NONE : err == JESEN_ERR_NOT_FOUND);
+  }
+
+  EXPECT_OK(jesen_tape_find_field(&root, "b", &item));
+  assert(jesen_tape_child(&item, &item) == JESEN_ERR_NOT_FOUND);
+  EXPECT_OK(jesen_tape_find_field(&root, "big", &item));
+  EXPECT_OK(jesen_tape_get_double(&item, &d));
+  assert(d == 9223372036854775808.0);
+  assert(jesen_tape_find_field(&root, "zz", &item) == JESEN_ERR_NOT_FOUND);
+  assert(jesen_tape_find_field(&a, "a", &item) == JESEN_ERR_WRONG_TYPE);
+  EXPECT_OK(jesen_tape_destroy(tape));
+
+  // A number's raw second word can look like a 'k' word; it must not make the
+  // element after it read as an object member.
+  json = "[7710162562058289152,1,4e207,2,{\"n\":4e207,\"s\":\"v\"}]";
+  EXPECT_OK(jesen_tape_parse(json, strlen(json), &tape));
+  EXPECT_OK(jesen_tape_root(tape, &root));
+  for (size_t k = 1; k < 5; k += 2) {
+    EXPECT_OK(jesen_tape_at_index(&root, k, &item));
+    assert(jesen_tape_key(&item, &str, &len) == JESEN_ERR_NOT_FOUND);
+  }
+  EXPECT_OK(jesen_tape_at_index(&root, 4, &a));
+  EXPECT_OK(jesen_tape_find_field(&a, "s", &item));
+  EXPECT_OK(jesen_tape_key(&item, &str, &len));
+  assert(len == 1 && strcmp(str, "s") == 0);
+  EXPECT_OK(jesen_tape_get_string(&item, &str, &len));
+  assert(strcmp(str, "v") == 0);
+  EXPECT_OK(jesen_tape_destroy(tape));
+
+  // A repeated key resolves to its last member, as in a parsed tree.
+  json = "{\"a\":1,\"b\":2,\"a\":3}";
+  EXPECT_OK(jesen_tape_parse(json, strlen(json), &tape));
+  EXPECT_OK(jesen_tape_root(tape, &root));
+  EXPECT_OK(jesen_tape_find_field(&root, "a", &item));
+  EXPECT_OK(jesen_tape_get_int64(&item, &i));
+  assert(i == 3);
+  EXPECT_OK(jesen_tape_find_field(&root, "b", &item));
+  EXPECT_OK(jesen_tape_get_int64(&item, &i));
+  assert(i == 2);
+  EXPECT_OK(jesen_tape_destroy(tape));
+
+  tape = NULL;
+  assert(jesen_tape_parse("[1,", 3, &tape) == JESEN_ERR_PARSE);
+  assert(tape == NULL);
+}
+
+static void test_parse_numbers(void) {
+  // Each must convert to exactly the nearest double.
+  struct {
+    const char *text;
+    double value;
+  } cases[] = {
+      {"0.1", 0.1},
+      {"-0", -0.0},
+      {"123456789012345678", 123456789012345678.0},
+      {"9007199254740993", 9007199254740992.0},
+      {"9007199254740995", 9007199254740996.0},
+      {"2.2250738585072011e-308", 2.2250738585072011e-308},
+      {"4.9406564584124654e-324", 4.9406564584124654e-324},
+      {"1.7976931348623157e308", 1.7976931348623157e308},
+      {"1e-400", 0.0},
+      {"0.000000000000000000000000000001234", 1.234e-30},
+      {"3.14159265358979323846264338327950288", 3.141592653589793},
+      // Halfway between 1 and the next double, then just above it.
+      {"1.00000000000000011102230246251565404236316680908203125", 1.0},
+      {"1.00000000000000011102230246251565404236316680908203126",
+       1.0000000000000002},
+  };
+  for (size_t i = 0; i < sizeof cases / sizeof cases[0]; ++i) {
+    jesen_node_t *root = NULL;
+    double value = 1.0;
+    EXPECT_OK(jesen_parse(cases[i].text, strlen(cases[i].text), &root));
+    EXPECT_OK(jesen_value_get_double(root, &value));
+    assert(memcmp(&value, &cases[i].value, sizeof value) == 0);
+    EXPECT_OK(jesen_destroy(root));
+  }
+}
+
+static void test_serialize_numbers(void) {
+  // Shortest text that reads back to the same double, %g-style notation.
+  struct {
+    double value;
+    const char *text;
+  } cases[] = {
+      {0.1, "0.1"},
+      {-2.5, "-2.5"},
+      {-0.0, "0"},
+      {1e20, "1e+20"},
+      {1e15, "1e+15"},
+      {100000000000000.0, "100000000000000"},
+      {123456789012345678.0, "1.2345678901234568e+17"},
+      {0.0001, "0.0001"},
+      {0.00001, "1e-05"},
+      {1.0 / 3.0, "0.3333333333333333"},
+      {5e-324, "5e-324"},
+      {1.7976931348623157e308, "1.7976931348623157e+308"},
+      {-9007199254740993.0, "-9007199254740992"},
+  };
+  for (size_t i = 0; i < sizeof cases / sizeof cases[0]; ++i) {
+    jesen_node_t *array = NULL;
+    EXPECT_OK(jesen_array_create(&array));
+    EXPECT_OK(jesen_array_add_double(array, cases[i].value));
+    char buf[64];
+    EXPECT_OK(jesen_serialize(array, buf, sizeof buf));
+    assert(buf[0] == '[' && strncmp(buf + 1, cases[i].text,
+                                    strlen(cases[i].text)) == 0);
+    assert(strcmp(buf + 1 + strlen(cases[i].text), "]") == 0);
+
+    // The printed text parses back to the same value.
+    jesen_node_t *root = NULL;
+    double value = 1.0;
+    EXPECT_OK(jesen_parse(buf, strlen(buf), &root));
+    EXPECT_OK(jesen_array_get_double(root, 0, &value));
+    assert(value == cases[i].value);
+    EXPECT_OK(jesen_destroy(root));
+    EXPECT_OK(jesen_destroy(array));
+  }
+}
+
+static void test_serialize_strings(void) {
+  // Escapes land on both sides of the 16-byte blocks the writer scans.
+  struct {
+    char c;
+    const char *escaped;
+  } escapes[] = {
+      {'"', "\\\""}, {'\\', "\\\\"},   {'\x01', "\\u0001"},
+      {'\n', "\\n"}, {'\t', "\\t"},    {'\x1f', "\\u001f"},
+  };
+  const size_t offsets[] = {0, 15, 16, 17, 31, 32};
+  for (size_t e = 0; e < sizeof escapes / sizeof escapes[0]; ++e) {
+    for (size_t o = 0; o < sizeof offsets / sizeof offsets[0]; ++o) {
+      char str[41];
+      memset(str, 'a', 40);
+      str[40] = '\0';
+      str[offsets[o]] = escapes[e].c;
+      char expected[64];
+      snprintf(expected, sizeof expected, "[\"%.*s%s%s\"]", (int)offsets[o],
+               str, escapes[e].escaped, str + offsets[o] + 1);
+
+      jesen_node_t *array = NULL;
+      EXPECT_OK(jesen_array_create(&array));
+      EXPECT_OK(jesen_array_add_string(array, str, 40));
+      char buf[64];
+      EXPECT_OK(jesen_serialize(array, buf, sizeof buf));
+      assert(strcmp(buf, expected) == 0);
+      EXPECT_OK(jesen_destroy(array));
+    }
+  }
+
+  // Several escapes in one string; DEL and UTF-8 bytes pass through as is.
+  jesen_node_t *array = NULL;
+  EXPECT_OK(jesen_array_create(&array));
+  const char *mixed = "\"bcdefghijklmno\\\x01qrstuvwxyzABCDE"
+                      "\x1f\x7f\xc3\xa9HIJ\r";
+  EXPECT_OK(jesen_array_add_string(array, mixed, strlen(mixed)));
+  char buf[128];
+  EXPECT_OK(jesen_serialize(array, buf, sizeof buf));
+  assert(strcmp(buf, "[\"\\\"bcdefghijklmno\\\\\\u0001qrstuvwxyzABCDE"
+                     "\\u001f\x7f\xc3\xa9HIJ\\r\"]") == 0);
+  EXPECT_OK(jesen_destroy(array));
+}
+
+static void test_parse_file(void) {
+  const char *path = "test_jesen_parse_file.json";
+  const char *json = "{\"name\":\"caf\\u00e9\",\"list\":[1,2,3]}";
+  FILE *file = fopen(path, "wb");
+  assert(file);
+  fputs(json, file);
+  fclose(file);
+
+  uint32_t flags[] = {0, JESEN_FILE_KEEP_MAPPING};
+  for (size_t i = 0; i < sizeof flags / sizeof flags[0]; ++i) {
+    jesen_node_t *root = NULL;
+    EXPECT_OK(jesen_parse_file(path, flags[i], &root));
+    char buf[64];
+    size_t len = 0;
+    EXPECT_OK(jesen_object_get_string(root, "name", buf, sizeof buf, &len));
+    assert(len == 5 && strcmp(buf, "caf\xc3\xa9") == 0);
+    int32_t value = 0;
+    EXPECT_OK(jesen_object_get_array_int32(root, "list", 2, &value));
+    assert(value == 3);
+    EXPECT_OK(jesen_destroy(root));
+  }
+
+  // Parsing in place from the mapping leaves the file untouched.
+  char contents[128] = {0};
+  file = fopen(path, "rb");
+  assert(file);
+  size_t got = fread(contents, 1, sizeof contents - 1, file);
+  fclose(file);
+  assert(got == strlen(json) && strcmp(contents, json) == 0);
+
+  // Only a missing file is NOT_FOUND; other open failures are not.
+  jesen_node_t *below = NULL;
+  assert(jesen_parse_file("test_jesen_parse_file.json/x", 0, &below) ==
+         JESEN_ERR_UNKNOWN);
+
+  // Parse flags reach the parser; unknown flags are refused.
+  EXPECT_OK(jesen_parse_file(path, JESEN_PARSE_EAGER_WRAPPERS, &below));
+  EXPECT_OK(jesen_destroy(below));
+  assert(jesen_parse_file(path, 0x80u, &below) == JESEN_ERR_INVALID_ARGS);
+  remove(path);
+
+  jesen_node_t *root = NULL;
+  assert(jesen_parse_file(path, 0, &root) == JESEN_ERR_NOT_FOUND);
+}
+
+static void test_parse_strict_utf8(void) {
+  const char *valid[] = {
+      "[\"caf\xc3\xa9\"]",
+      "{\"\xe2\x82\xac\":\"\xf0\x9f\x98\x80\xf4\x8f\xbf\xbf\"}",
+      "\"\xef\xbf\xbd\xed\x9f\xbf\xee\x80\x80\"",
+  };
+  for (size_t i = 0; i < sizeof valid / sizeof valid[0]; ++i) {
+    jesen_node_t *root = NULL;
+    EXPECT_OK(jesen_parse_with_flags(valid[i], strlen(valid[i]),
+                                     JESEN_PARSE_STRICT_UTF8, &root));
+    EXPECT_OK(jesen_destroy(root));
+  }
+
+  const char *invalid[] = {
+      "[\"\xc0\xaf\"]",             // overlong '/'
+      "[\"\xe0\x80\xaf\"]",         // overlong, three bytes
+      "[\"\xed\xa0\x80\"]",         // surrogate half
+      "[\"\xf4\x90\x80\x80\"]",     // above U+10FFFF
+      "[\"\xf8\x88\x80\x80\x80\"]", // five-byte form
+      "[\"a\x80\"]",                // stray continuation
+      "[\"\xe2\x82\"]",             // truncated sequence
+  };
+  for (size_t i = 0; i < sizeof invalid / sizeof invalid[0]; ++i) {
+    jesen_node_t *root = NULL;
+    assert(jesen_parse_with_flags(invalid[i], strlen(invalid[i]),
+                                  JESEN_PARSE_STRICT_UTF8,
+                                  &root) == JESEN_ERR_UTF8);
+    assert(root == NULL);
+    // Without the flag the bytes are passed through as before.
+    EXPECT_OK(jesen_parse(invalid[i], strlen(invalid[i]), &root));
+    EXPECT_OK(jesen_destroy(root));
+  }
+
+  // A sequence split across two 64-byte blocks, then broken in the middle.
+  char buf[130];
+  memset(buf, 'a', sizeof buf);
+  buf[0] = '\"';
+  memcpy(buf + 62, "\xf0\x9f\x98\x80", 4);
+  buf[127] = '\"';
+  jesen_node_t *root = NULL;
+  EXPECT_OK(
+      jesen_parse_with_flags(buf, 128, JESEN_PARSE_STRICT_UTF8, &root));
+  EXPECT_OK(jesen_destroy(root));
+  buf[64] = 'a';
+  assert(jesen_parse_with_flags(buf, 128, JESEN_PARSE_STRICT_UTF8, &root) ==
+         JESEN_ERR_UTF8);
+  assert(jesen_parse_with_flags(buf, 128, 0x80u, &root) ==
+         JESEN_ERR_INVALID_ARGS);
+}
+
+static void test_parse_depth(void) {
+  // Alternate arrays and objects: [{"k":[{"k":...}]}]
+  const size_t levels = 6000;
+  size_t cap = levels * 6 + 16;
+  char *json = (char *)malloc(cap);
+  char *out = (char *)malloc(cap);
+  assert(json && out);
+  size_t len = 0;
+  for (size_t i = 0; i < levels; ++i) {
+    if (i % 2 == 0) {
+      json[len++] = '[';
+    } else {
+      memcpy(json + len, "{\"k\":", 5);
+      len += 5;
+    }
+  }
+  json[len++] = '1';
+  for (size_t i = levels; i-- > 0;) {
+    json[len++] = i % 2 == 0 ? ']' : '}';
+  }
+  json[len] = '\0';
+
+  jesen_node_t *root = NULL;
+  assert(jesen_parse(json, len, &root) == JESEN_ERR_PARSE);
+
+  jesen_parse_opts_t opts;
+  memset(&opts, 0, sizeof opts);
+  opts.max_depth = levels - 1;
+  assert(jesen_parse_ex(json, len, &opts, &root) == JESEN_ERR_PARSE);
+  opts.max_depth = levels;
+  EXPECT_OK(jesen_parse_ex(json, len, &opts, &root));
+  EXPECT_OK(jesen_serialize(root, out, cap));
+  assert(strcmp(out, json) == 0);
+  EXPECT_OK(jesen_destroy(root));
+
+  // A wide array is freed without recursing on siblings.
+  len = 0;
+  json[len++] = '[';
+  for (size_t i = 0; i < levels; ++i) {
+    memcpy(json + len, "[0],", 4);
+    len += 4;
+  }
+  json[len - 1] = ']';
+  EXPECT_OK(jesen_parse(json, len, &root));
+  size_t size = 0;
+  EXPECT_OK(jesen_array_size(root, &size));
+  assert(size == levels);
+  jesen_node_t *last = NULL;
+  EXPECT_OK(jesen_array_get_value(root, (uint32_t)levels - 1, &last));
+  EXPECT_OK(jesen_destroy(root));
+
+  opts.flags = 0x80u;
+  assert(jesen_parse_ex("[]", 2, &opts, &root) == JESEN_ERR_INVALID_ARGS);
+  free(json);
+  free(out);
+}
+
+typedef struct {
+  size_t live;
+  size_t total;
+} counting_allocator_t;
+
+static void *counting_alloc(void *ctx, size_t size) {
+  counting_allocator_t *c = (counting_allocator_t *)ctx;
+  c->live++;
+  c->total++;
+  return malloc(size);
+}
+
+static void counting_release(void *ctx, void *ptr) {
+  ((counting_allocator_t *)ctx)->live--;
+  free(ptr);
+}
+
+static void test_parse_options(void) {
+  const char *json =
+      "{\"a\":1,\"b\":[true,null],\"a\":2,\"s\":\"x\\n\"}";
+  size_t len = strlen(json);
+  jesen_parse_opts_t opts;
+  memset(&opts, 0, sizeof opts);
+  jesen_node_t *root = NULL;
+  size_t size = 0;
+  int32_t value = 0;
+
+  opts.max_input = len - 1;
+  assert(jesen_parse_ex(json, len, &opts, &root) == JESEN_ERR_LIMIT);
+  opts.max_input = len;
+  EXPECT_OK(jesen_parse_ex(json, len, &opts, &root));
+  EXPECT_OK(jesen_destroy(root));
+
+  // Seven values: the object, 1, the array, true, null, 2 and "x\n".
+  opts.max_nodes = 6;
+  assert(jesen_parse_ex(json, len, &opts, &root) == JESEN_ERR_LIMIT);
+  opts.max_nodes = 7;
+  EXPECT_OK(jesen_parse_ex(json, len, &opts, &root));
+  EXPECT_OK(jesen_object_size(root, &size));
+  assert(size == 4);
+  EXPECT_OK(jesen_destroy(root));
+
+  opts.duplicates = JESEN_DUPLICATE_FIRST;
+  EXPECT_OK(jesen_parse_ex(json, len, &opts, &root));
+  EXPECT_OK(jesen_object_size(root, &size));
+  assert(size == 3);
+  EXPECT_OK(jesen_object_get_int32(root, "a", &value));
+  assert(value == 1);
+  EXPECT_OK(jesen_destroy(root));
+
+  opts.duplicates = JESEN_DUPLICATE_LAST;
+  EXPECT_OK(jesen_parse_ex(json, len, &opts, &root));
+  EXPECT_OK(jesen_object_size(root, &size));
+  assert(size == 3);
+  EXPECT_OK(jesen_object_get_int32(root, "a", &value));
+  assert(value == 2);
+  EXPECT_OK(jesen_destroy(root));
+
+  opts.duplicates = JESEN_DUPLICATE_ERROR;
+  assert(jesen_parse_ex(json, len, &opts, &root) == JESEN_ERR_DUPLICATE_KEY);
+  EXPECT_OK(jesen_parse_ex("{\"a\":{\"a\":1}}", 13, &opts, &root));
+  EXPECT_OK(jesen_destroy(root));
+
+  // Every block taken from the allocator comes back by jesen_destroy.
+  counting_allocator_t counts = {0, 0};
+  jesen_allocator_t allocator = {counting_alloc, counting_release, &counts};
+  opts.duplicates = JESEN_DUPLICATE_LAST;
+  opts.allocator = &allocator;
+  opts.flags = JESEN_PARSE_EAGER_WRAPPERS;
+  EXPECT_OK(jesen_parse_ex(json, len, &opts, &root));
+  assert(counts.total > 0);
+  jesen_node_t *array = NULL;
+  EXPECT_OK(jesen_node_find(root, "b", &array));
+  EXPECT_OK(jesen_array_size(array, &size));
+  assert(size == 2);
+  EXPECT_OK(jesen_destroy(root));
+  assert(counts.live == 0);
+
+  // Failed parses give everything back too.
+  opts.duplicates = JESEN_DUPLICATE_ERROR;
+  assert(jesen_parse_ex(json, len, &opts, &root) == JESEN_ERR_DUPLICATE_KEY);
+  assert(counts.live == 0);
+
+  opts.duplicates = (jesen_duplicate_policy_t)7;
+  assert(jesen_parse_ex(json, len, &opts, &root) == JESEN_ERR_INVALID_ARGS);
+  opts.duplicates = JESEN_DUPLICATE_KEEP_ALL;
+  allocator.release = NULL;
+  assert(jesen_parse_ex(json, len, &opts, &root) == JESEN_ERR_INVALID_ARGS);
+}
+
+static void test_doc_reuse(void) {
+  jesen_doc_t *doc = NULL;
+  EXPECT_OK(jesen_doc_create(&doc));
+  char json[128];
+  char out[128];
+  jesen_node_t *root = NULL;
+  for (int i = 0; i < 50; ++i) {
+    int len = snprintf(json, sizeof json,
+                       "{\"id\":%d,\"tags\":[\"a\",\"b\\n\"],"
+                       "\"ok\":true}",
+                       i);
+    EXPECT_OK(jesen_doc_parse(doc, json, (size_t)len, &root));
+    int32_t id = -1;
+    EXPECT_OK(jesen_object_get_int32(root, "id", &id));
+    assert(id == i);
+    char tag[8];
+    EXPECT_OK(jesen_object_get_array_string(root, "tags", 1, tag, sizeof tag,
+                                            NULL));
+    assert(strcmp(tag, "b\n") == 0);
+    EXPECT_OK(jesen_serialize(root, out, sizeof out));
+    assert(strcmp(out, json) == 0);
+  }
+
+  // A changed tree is destroyed first; pooled values are skipped.
+  EXPECT_OK(jesen_object_add_string(root, "extra", "heap", 4));
+  EXPECT_OK(jesen_destroy(root));
+  EXPECT_OK(jesen_doc_reset(doc));
+
+  assert(jesen_doc_parse(doc, "[1,", 3, &root) == JESEN_ERR_PARSE);
+  EXPECT_OK(jesen_doc_parse(doc, "[]", 2, &root));
+  assert(jesen_doc_parse(NULL, "[]", 2, &root) == JESEN_ERR_INVALID_ARGS);
+  EXPECT_OK(jesen_doc_destroy(doc));
+}
+
+static void test_parse_projection(void) {
+  const char *json =
+      "{\"user\":{\"id\":7,\"name\":\"x\",\"tags\":[{\"a\":[1,{}]}]},"
+      "\"items\":[{\"price\":1.5,\"sku\":\"a\\\"]\"},{\"sku\":\"b\"},"
+      "{\"price\":3}],\"meta\":{\"ts\":99,\"raw\":[[[\"}\"]]]},\"id\":1}";
+  const char *paths[] = {"user.id", "items[*].price", "meta.ts", "nope[*]"};
+  jesen_projection_t *projection = NULL;
+  EXPECT_OK(jesen_projection_create(paths, 4, &projection));
+
+  jesen_parse_opts_t opts;
+  memset(&opts, 0, sizeof opts);
+  opts.projection = projection;
+  jesen_node_t *root = NULL;
+  EXPECT_OK(jesen_parse_ex(json, strlen(json), &opts, &root));
+  char out[256];
+  EXPECT_OK(jesen_serialize(root, out, sizeof out));
+  assert(strcmp(out, "{\"user\":{\"id\":7},\"items\":[{\"price\":1.5},{},"
+                     "{\"price\":3}],\"meta\":{\"ts\":99}}") == 0);
+  jesen_node_t *item = NULL;
+  EXPECT_OK(jesen_object_get_array_value(root, "items", 2, &item));
+  double price = 0.0;
+  EXPECT_OK(jesen_object_get_double(item, "price", &price));
+  assert(price == 3.0);
+  int32_t id = 0;
+  assert(jesen_object_get_int32(root, "id", &id) == JESEN_ERR_NOT_FOUND);
+  EXPECT_OK(jesen_destroy(root));
+
+  // Malformed input around skipped values is still rejected.
+  assert(jesen_parse_ex("{\"x\":[1,2}", 11, &opts, &root) == JESEN_ERR_PARSE);
+  assert(jesen_parse_ex("{\"x\":[1]", 9, &opts, &root) == JESEN_ERR_PARSE);
+  assert(jesen_parse_ex("{\"x\":[]} 1", 11, &opts, &root) == JESEN_ERR_PARSE);
+  EXPECT_OK(jesen_projection_destroy(projection));
+
+  const char *whole[] = {""};
+  EXPECT_OK(jesen_projection_create(whole, 1, &projection));
+  opts.projection = projection;
+  EXPECT_OK(jesen_parse_ex(json, strlen(json), &opts, &root));
+  EXPECT_OK(jesen_serialize(root, out, sizeof out));
+  EXPECT_OK(jesen_destroy(root));
+  EXPECT_OK(jesen_projection_destroy(projection));
+
+  const char *bad[] = {"a..b", "a[0]", ".a", "a.[*]"};
+  for (size_t i = 0; i < 4; ++i) {
+    assert(jesen_projection_create(&bad[i], 1, &projection) ==
+           JESEN_ERR_INVALID_ARGS);
+  }
+}
+
+static void test_extract_pointer(void) {
+  const char *json =
+      "{\"skip\":[{\"a\":\"]}\"}],\"a\":{\"b\":[0,1,2,{\"c\":42,\"d\":2.5}]},"
+      "\"x/y\":\"s\\\"\",\"m~n\":[true],\"\":-1}";
+  size_t len = strlen(json);
+
+  int64_t i = 0;
+  EXPECT_OK(jesen_extract_pointer_int64(json, len, "/a/b/3/c", &i));
+  assert(i == 42);
+  EXPECT_OK(jesen_extract_pointer_int64(json, len, "/", &i));
+  assert(i == -1);
+  double d = 0.0;
+  EXPECT_OK(jesen_extract_pointer_double(json, len, "/a/b/3/d", &d));
+  assert(d == 2.5);
+  const char *view = NULL;
+  size_t view_len = 0;
+  EXPECT_OK(jesen_extract_pointer_string(json, len, "/x~1y", &view,
+                                         &view_len));
+  assert(view_len == 3 && memcmp(view, "s\\\"", 3) == 0);
+
+  jesen_node_t *node = NULL;
+  char out[64];
+  EXPECT_OK(jesen_extract_pointer(json, len, "/a/b/3", &node));
+  EXPECT_OK(jesen_serialize(node, out, sizeof out));
+  assert(strcmp(out, "{\"c\":42,\"d\":2.5}") == 0);
+  EXPECT_OK(jesen_destroy(node));
+  EXPECT_OK(jesen_extract_pointer(json, len, "/m~0n/0", &node));
+  EXPECT_OK(jesen_serialize(node, out, sizeof out));
+  assert(strcmp(out, "true") == 0);
+  EXPECT_OK(jesen_destroy(node));
+  EXPECT_OK(jesen_extract_pointer(json, len, "", &node));
+  EXPECT_OK(jesen_destroy(node));
+
+  assert(jesen_extract_pointer_int64(json, len, "/a/c", &i) ==
+         JESEN_ERR_NOT_FOUND);
+  assert(jesen_extract_pointer_int64(json, len, "/a/b/4", &i) ==
+         JESEN_ERR_OUT_OF_RANGE);
+  assert(jesen_extract_pointer_int64(json, len, "/a/b/-", &i) ==
+         JESEN_ERR_OUT_OF_RANGE);
+  assert(jesen_extract_pointer_int64(json, len, "/a/b/01", &i) ==
+         JESEN_ERR_NOT_FOUND);
+  assert(jesen_extract_pointer_int64(json, len, "/a/b/0/x", &i) ==
+         JESEN_ERR_WRONG_TYPE);
+  assert(jesen_extract_pointer_int64(json, len, "a", &i) ==
+         JESEN_ERR_INVALID_ARGS);
+  assert(jesen_extract_pointer_int64(json, len, "/m~2n", &i) ==
+         JESEN_ERR_INVALID_ARGS);
+  assert(jesen_extract_pointer_int64(json, len, "/x~1y", &i) ==
+         JESEN_ERR_INVALID_VALUE_TYPE);
+  assert(jesen_extract_pointer(json, len, "/a/b/3", NULL) ==
+         JESEN_ERR_INVALID_ARGS);
+  assert(jesen_extract_pointer("{\"a\":[1,}", 9, "/a", &node) ==
+         JESEN_ERR_PARSE);
+
+  // With repeated keys the value is the one jesen_node_find gives on the
+  // parsed document: the last member wins.
+  const char *dup = "{\"a\":1,\"b\":{\"c\":2,\"c\":[3]},\"a\":3}";
+  len = strlen(dup);
+  EXPECT_OK(jesen_extract_pointer_int64(dup, len, "/a", &i));
+  assert(i == 3);
+  jesen_node_t *root = NULL;
+  int32_t value = 0;
+  EXPECT_OK(jesen_parse(dup, len, &root));
+  EXPECT_OK(jesen_object_get_int32(root, "a", &value));
+  assert(value == 3);
+  EXPECT_OK(jesen_destroy(root));
+  EXPECT_OK(jesen_extract_pointer(dup, len, "/b/c", &node));
+  EXPECT_OK(jesen_serialize(node, out, sizeof out));
+  assert(strcmp(out, "[3]") == 0);
+  EXPECT_OK(jesen_destroy(node));
+}
+
+static void test_intern_keys(void) {
+  const char *json = "[{\"id\":1,\"name\":\"a\"},{\"id\":2,\"name\":\"b\"}]";
+  jesen_intern_t *pool = NULL;
+  EXPECT_OK(jesen_intern_create(&pool));
+  jesen_parse_opts_t opts;
+  memset(&opts, 0, sizeof opts);
+  opts.intern = pool;
+  jesen_node_t *first = NULL;
+  jesen_node_t *second = NULL;
+  EXPECT_OK(jesen_parse_ex(json, strlen(json), &opts, &first));
+  EXPECT_OK(jesen_parse_ex(json, strlen(json), &opts, &second));
+  const char *id = NULL;
+  const char *again = NULL;
+  EXPECT_OK(jesen_intern_key(pool, "id", &id));
+  EXPECT_OK(jesen_intern_key(pool, "id", &again));
+  assert(again == id);
+  // The trees keep the pool alive after the caller lets go of it, and
+  // lookups work with pooled and ordinary keys alike.
+  EXPECT_OK(jesen_intern_destroy(pool));
+  jesen_node_t *roots[2] = {first, second};
+  for (size_t i = 0; i < 4; ++i) {
+    jesen_node_t *object = NULL;
+    EXPECT_OK(jesen_array_get_value(roots[i / 2], (uint32_t)(i % 2), &object));
+    jesen_node_t *member = NULL;
+    EXPECT_OK(jesen_node_find(object, id, &member));
+    int32_t value = 0;
+    EXPECT_OK(jesen_value_get_int32(member, &value));
+    assert(value == (int32_t)(i % 2) + 1);
+    char name[4];
+    size_t len = 0;
+    EXPECT_OK(jesen_object_get_string(object, "name", name, sizeof name, &len));
+    assert(len == 1 && name[0] == (char)('a' + i % 2));
+  }
+
+  // Renaming and editing an interned tree leaves the pool alone.
+  jesen_node_t *object = NULL;
+  EXPECT_OK(jesen_array_get_value(first, 0, &object));
+  EXPECT_OK(jesen_object_remove(object, "name"));
+  EXPECT_OK(jesen_object_add_int32(object, "name", 3));
+  char out[64];
+  EXPECT_OK(jesen_serialize(first, out, sizeof out));
+  assert(strcmp(out, "[{\"id\":1,\"name\":3},{\"id\":2,\"name\":\"b\"}]") == 0);
+  EXPECT_OK(jesen_destroy(first));
+  EXPECT_OK(jesen_destroy(second));
+
+  // A private pool per tree, together with the duplicate-key policy.
+  opts.intern = NULL;
+  opts.flags = JESEN_PARSE_INTERN_KEYS;
+  opts.duplicates = JESEN_DUPLICATE_LAST;
+  const char *dup = "{\"k\":1,\"k\":2,\"j\":{\"k\":3}}";
+  EXPECT_OK(jesen_parse_ex(dup, strlen(dup), &opts, &first));
+  EXPECT_OK(jesen_serialize(first, out, sizeof out));
+  assert(strcmp(out, "{\"k\":2,\"j\":{\"k\":3}}") == 0);
+  EXPECT_OK(jesen_destroy(first));
+}
+
+static void test_object_index(void) {
+  // Large enough for the key index on both backends; "k7" appears twice
+  // and the later member wins.
+  char json[4096];
+  size_t n = 0;
+  json[n++] = '{';
+  for (int i = 0; i < 200; ++i) {
+    n += (size_t)sprintf(json + n, "%s\"k%d\":%d", i ? "," : "", i, i);
+  }
+  n += (size_t)sprintf(json + n, ",\"k7\":-7}");
+  jesen_node_t *root = NULL;
+  EXPECT_OK(jesen_parse(json, n, &root));
+
+  int32_t value = 0;
+  char key[16];
+  for (int i = 199; i >= 0; --i) {
+    sprintf(key, "k%d", i);
+    EXPECT_OK(jesen_object_get_int32(root, key, &value));
+    assert(value == (i == 7 ? -7 : i));
+  }
+  jesen_node_t *node = NULL;
+  assert(jesen_node_find(root, "k200", &node) == JESEN_ERR_NOT_FOUND);
+
+  // Removing the winner of a duplicate key uncovers the earlier member.
+  EXPECT_OK(jesen_object_remove(root, "k7"));
+  EXPECT_OK(jesen_object_get_int32(root, "k7", &value));
+  assert(value == 7);
+  for (int i = 0; i < 200; i += 2) {
+    sprintf(key, "k%d", i);
+    EXPECT_OK(jesen_object_remove(root, key));
+  }
+  for (int i = 0; i < 200; ++i) {
+    sprintf(key, "k%d", i);
+    jesen_err_t err = jesen_object_get_int32(root, key, &value);
+    assert(i % 2 ? err == JESEN_ERR_NONE && value == i
+                 : err == JESEN_ERR_NOT_FOUND);
+  }
+
+  // Detached members leave the index; added ones join it.
+  EXPECT_OK(jesen_node_find(root, "k101", &node));
+  EXPECT_OK(jesen_node_detach(node));
+  assert(jesen_node_find(root, "k101", &node) == JESEN_ERR_NOT_FOUND);
+  EXPECT_OK(jesen_object_add_int32(root, "k0", 1000));
+  EXPECT_OK(jesen_object_add_int32(root, "k3", 3000));
+  EXPECT_OK(jesen_object_get_int32(root, "k0", &value));
+  assert(value == 1000);
+  EXPECT_OK(jesen_object_get_int32(root, "k3", &value));
+  assert(value == 3000);
+  size_t size = 0;
+  EXPECT_OK(jesen_object_size(root, &size));
+  assert(size == 101);
+  EXPECT_OK(jesen_destroy(node));
+
+  // The member list stays in document order through all of that, and
+  // through removals after it has been iterated.
+  for (int pass = 0; pass < 2; ++pass) {
+    jesen_iter_t it;
+    const char *name = NULL;
+    int expected = 1;
+    EXPECT_OK(jesen_iter_begin(root, &it));
+    while (jesen_iter_next_int32(&it, &name, &value) == JESEN_ERR_NONE) {
+      if (expected == 101 || (pass && expected == 51)) {
+        expected += 2;
+      }
+      // The odd members, then the two added at the end.
+      sprintf(key, "k%d", expected < 200 ? expected : (expected - 201) * 3 / 2);
+      assert(strcmp(name, key) == 0);
+      expected += 2;
+    }
+    assert(expected == 205);
+    if (!pass) {
+      EXPECT_OK(jesen_object_remove(root, "k51"));
+    }
+  }
+  EXPECT_OK(jesen_destroy(root));
+
+  // Objects built member by member are indexed as they grow.
+  EXPECT_OK(jesen_object_create(&root));
+  for (int i = 0; i < 100; ++i) {
+    sprintf(key, "f%d", i);
+    EXPECT_OK(jesen_object_add_int32(root, key, i));
+    EXPECT_OK(jesen_object_get_int32(root, "f0", &value));
+  }
+  for (int i = 0; i < 100; ++i) {
+    sprintf(key, "f%d", i);
+    EXPECT_OK(jesen_object_get_int32(root, key, &value));
+    assert(value == i);
+  }
+  EXPECT_OK(jesen_destroy(root));
+}
+
+static void test_array_index(void) {
+  char json[8192];
+  size_t n = 0;
+  json[n++] = '[';
+  for (int i = 0; i < 1000; ++i) {
+    n += (size_t)sprintf(json + n, "%s%d", i ? "," : "", i);
+  }
+  json[n++] = ']';
+  jesen_node_t *root = NULL;
+  EXPECT_OK(jesen_parse(json, n, &root));
+
+  int32_t value = 0;
+  for (int i = 999; i >= 0; --i) {
+    EXPECT_OK(jesen_array_get_int32(root, (uint32_t)i, &value));
+    assert(value == i);
+  }
+  jesen_node_t *node = NULL;
+  assert(jesen_array_get_value(root, 1000, &node) == JESEN_ERR_OUT_OF_RANGE);
+
+  // Replace every tenth element, then drop the first and last hundred.
+  for (int i = 0; i < 1000; i += 10) {
+    jesen_node_t *replacement = NULL;
+    EXPECT_OK(jesen_array_create(&replacement));
+    EXPECT_OK(jesen_array_add_int32(replacement, -i));
+    EXPECT_OK(jesen_array_set_value(root, (uint32_t)i, replacement));
+  }
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_OK(jesen_array_remove(root, 0));
+    EXPECT_OK(jesen_array_remove(root, 998 - 2 * (uint32_t)i));
+  }
+  size_t size = 0;
+  EXPECT_OK(jesen_array_size(root, &size));
+  assert(size == 800);
+  for (int i = 0; i < 800; ++i) {
+    int expected = i + 100;
+    EXPECT_OK(jesen_array_get_value(root, (uint32_t)i, &node));
+    if (expected % 10 == 0) {
+      EXPECT_OK(jesen_array_get_int32(node, 0, &value));
+      assert(value == -expected);
+    } else {
+      EXPECT_OK(jesen_array_get_int32(root, (uint32_t)i, &value));
+      assert(value == expected);
+    }
+  }
+
+  // Detached elements leave the vector; appended ones join it.
+  EXPECT_OK(jesen_array_get_value(root, 401, &node));
+  EXPECT_OK(jesen_node_detach(node));
+  EXPECT_OK(jesen_array_add_int32(root, 5000));
+  EXPECT_OK(jesen_node_assign_to(root, "ignored", node));
+  EXPECT_OK(jesen_array_get_int32(root, 401, &value));
+  assert(value == 502);
+  EXPECT_OK(jesen_array_get_int32(root, 799, &value));
+  assert(value == 5000);
+  EXPECT_OK(jesen_array_get_int32(root, 800, &value));
+  assert(value == 501);
+  assert(jesen_array_get_value(root, 801, &node) == JESEN_ERR_OUT_OF_RANGE);
+  EXPECT_OK(jesen_destroy(root));
+
+  // Arrays built element by element stay indexable as they grow.
+  EXPECT_OK(jesen_array_create(&root));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_OK(jesen_array_add_int32(root, i));
+    EXPECT_OK(jesen_array_get_int32(root, (uint32_t)i, &value));
+    assert(value == i);
+  }
+  EXPECT_OK(jesen_destroy(root));
+
+  // Replacing the only, last and first element keeps the list whole, and
+  // later appends still land at the end.
+  const uint32_t slots[] = {0, 2, 0};
+  const char *after[] = {"[{}]", "[{},2,[]]", "[[],2,[]]"};
+  EXPECT_OK(jesen_array_create(&root));
+  EXPECT_OK(jesen_array_add_int32(root, 1));
+  for (int i = 0; i < 3; ++i) {
+    jesen_node_t *replacement = NULL;
+    if (i == 0) {
+      EXPECT_OK(jesen_object_create(&replacement));
+    } else {
+      EXPECT_OK(jesen_array_create(&replacement));
+    }
+    EXPECT_OK(jesen_array_set_value(root, slots[i], replacement));
+    char out[32];
+    EXPECT_OK(jesen_serialize(root, out, sizeof out));
+    assert(strcmp(out, after[i]) == 0);
+    if (i == 0) {
+      EXPECT_OK(jesen_array_add_int32(root, 2));
+      EXPECT_OK(jesen_array_add_int32(root, 3));
+    }
+  }
+  EXPECT_OK(jesen_array_add_int32(root, 4));
+  char out[32];
+  EXPECT_OK(jesen_serialize(root, out, sizeof out));
+  assert(strcmp(out, "[[],2,[],4]") == 0);
+  EXPECT_OK(jesen_destroy(root));
+}
+
+static void test_iter(void) {
+  const char *json = "{\"a\":1,\"b\":[10,20,\"x\",true],\"c\":{},\"b\":2.5}";
+  jesen_node_t *root = NULL;
+  EXPECT_OK(jesen_parse(json, strlen(json), &root));
+
+  // Members come back in document order, duplicates included.
+  const char *keys[] = {"a", "b", "c", "b"};
+  jesen_iter_t it;
+  EXPECT_OK(jesen_iter_begin(root, &it));
+  const char *key = NULL;
+  size_t key_len = 0;
+  jesen_node_t *child = NULL;
+  jesen_node_t *array = NULL;
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_OK(jesen_iter_next(&it, &key, &key_len, &child));
+    assert(strcmp(key, keys[i]) == 0 && key_len == 1);
+    if (i == 1) {
+      array = child;
+    }
+  }
+  assert(jesen_iter_next(&it, &key, &key_len, &child) == JESEN_ERR_NOT_FOUND);
+
+  // A typed step that does not match leaves the iterator in place.
+  int32_t value = 0;
+  EXPECT_OK(jesen_iter_begin(array, &it));
+  EXPECT_OK(jesen_iter_next_int32(&it, &key, &value));
+  assert(key == NULL && value == 10);
+  EXPECT_OK(jesen_iter_next_int32(&it, NULL, &value));
+  assert(value == 20);
+  assert(jesen_iter_next_int32(&it, NULL, &value) ==
+         JESEN_ERR_INVALID_VALUE_TYPE);
+  const char *str = NULL;
+  size_t str_len = 0;
+  EXPECT_OK(jesen_iter_next_string(&it, NULL, &str, &str_len));
+  assert(strcmp(str, "x") == 0 && str_len == 1);
+  bool flag = false;
+  EXPECT_OK(jesen_iter_next_bool(&it, NULL, &flag));
+  assert(flag);
+  double number = 0;
+  assert(jesen_iter_next_double(&it, NULL, &number) == JESEN_ERR_NOT_FOUND);
+
+  // The caller's key and value are left alone on a mismatch too.
+  EXPECT_OK(jesen_iter_begin(root, &it));
+  EXPECT_OK(jesen_iter_next_int32(&it, &key, &value));
+  assert(strcmp(key, "a") == 0 && value == 1);
+  assert(jesen_iter_next_int32(&it, &key, &value) ==
+         JESEN_ERR_INVALID_VALUE_TYPE);
+  assert(strcmp(key, "a") == 0 && value == 1);
+  assert(jesen_iter_next_string(&it, &key, &str, &str_len) ==
+         JESEN_ERR_INVALID_VALUE_TYPE);
+  assert(strcmp(key, "a") == 0 && strcmp(str, "x") == 0);
+
+  jesen_node_t *empty = NULL;
+  EXPECT_OK(jesen_node_find(root, "c", &empty));
+  EXPECT_OK(jesen_iter_begin(empty, &it));
+  assert(jesen_iter_next(&it, NULL, NULL, &child) == JESEN_ERR_NOT_FOUND);
+  jesen_node_t *scalar = NULL;
+  EXPECT_OK(jesen_node_find(root, "a", &scalar));
+  assert(jesen_iter_begin(scalar, &it) == JESEN_ERR_WRONG_TYPE);
+
+  // Detached members drop out; moved into an array, they have no key.
+  EXPECT_OK(jesen_node_detach(scalar));
+  EXPECT_OK(jesen_node_assign_to(array, "ignored", scalar));
+  EXPECT_OK(jesen_iter_begin(root, &it));
+  EXPECT_OK(jesen_iter_next(&it, &key, NULL, &child));
+  assert(strcmp(key, "b") == 0 && child == array);
+  EXPECT_OK(jesen_iter_begin(array, &it));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_OK(jesen_iter_next(&it, NULL, NULL, &child));
+  }
+  EXPECT_OK(jesen_iter_next_int32(&it, &key, &value));
+  assert(key == NULL && value == 1);
+  EXPECT_OK(jesen_destroy(root));
+
+  // Built trees iterate in the order children were added.
+  EXPECT_OK(jesen_object_create(&root));
+  char name[16];
+  for (int i = 0; i < 100; ++i) {
+    sprintf(name, "f%d", i);
+    EXPECT_OK(jesen_object_add_int32(root, name, i));
+  }
+  EXPECT_OK(jesen_object_remove(root, "f50"));
+  EXPECT_OK(jesen_iter_begin(root, &it));
+  for (int i = 0; i < 100; ++i) {
+    if (i == 50) {
+      continue;
+    }
+    sprintf(name, "f%d", i);
+    EXPECT_OK(jesen_iter_next_int32(&it, &key, &value));
+    assert(strcmp(key, name) == 0 && value == i);
+  }
+  assert(jesen_iter_next(&it, NULL, NULL, &child) == JESEN_ERR_NOT_FOUND);
+  EXPECT_OK(jesen_destroy(root));
+}
+
+static void test_doc_build(void) {
+  jesen_doc_t *doc = NULL;
+  jesen_doc_t *other = NULL;
+  EXPECT_OK(jesen_doc_create(&doc));
+  EXPECT_OK(jesen_doc_create(&other));
+
+  // Trees built in a document take every added value from its pool.
+  jesen_node_t *root = NULL;
+  EXPECT_OK(jesen_doc_object_create(doc, &root));
+  EXPECT_OK(jesen_object_add_int32(root, "id", 7));
+  EXPECT_OK(jesen_object_add_double(root, "ratio", 0.5));
+  EXPECT_OK(jesen_object_add_string(root, "name", "jesen", 5));
+  EXPECT_OK(jesen_object_add_bool(root, "ok", true));
+  EXPECT_OK(jesen_object_add_null(root, "none"));
+  jesen_node_t *tags = NULL;
+  EXPECT_OK(jesen_array_create_to(root, "tags", &tags));
+  EXPECT_OK(jesen_array_add_string(tags, "a", 1));
+  EXPECT_OK(jesen_array_add_int32(tags, 2));
+  EXPECT_OK(jesen_array_add_double(tags, 2.5));
+  EXPECT_OK(jesen_array_add_bool(tags, false));
+  jesen_node_t *inner = NULL;
+  EXPECT_OK(jesen_object_create_to(root, "inner", &inner));
+  EXPECT_OK(jesen_object_add_int32(inner, "x", 1));
+  EXPECT_OK(jesen_object_remove(root, "none"));
+  const char *expected =
+      "{\"id\":7,\"ratio\":0.5,\"name\":\"jesen\",\"ok\":true,"
+      "\"tags\":[\"a\",2,2.5,false],\"inner\":{\"x\":1}}";
+  char out[256];
+  EXPECT_OK(jesen_serialize(root, out, sizeof out));
+  assert(strcmp(out, expected) == 0);
+
+  // Nodes of one document cannot join another tree; copies can.
+  jesen_node_t *arr = NULL;
+  EXPECT_OK(jesen_doc_array_create(other, &arr));
+  EXPECT_OK(jesen_node_detach(inner));
+  assert(jesen_node_assign_to(arr, "ignored", inner) == JESEN_ERR_NOT_OWNED);
+  jesen_node_t *heap = NULL;
+  EXPECT_OK(jesen_array_create(&heap));
+  assert(jesen_node_assign_to(heap, "ignored", inner) == JESEN_ERR_NOT_OWNED);
+  jesen_node_t *copy = NULL;
+  EXPECT_OK(jesen_node_copy(inner, other, &copy));
+  EXPECT_OK(jesen_node_assign_to(arr, "ignored", copy));
+  EXPECT_OK(jesen_node_assign_to(root, "inner", inner));
+  EXPECT_OK(jesen_node_copy(root, NULL, &copy));
+  EXPECT_OK(jesen_node_assign_to(heap, "ignored", copy));
+  jesen_node_t *moved = NULL;
+  EXPECT_OK(jesen_array_get_value(arr, 0, &moved));
+  EXPECT_OK(jesen_node_detach(moved));
+  assert(jesen_array_set_value(heap, 0, moved) == JESEN_ERR_NOT_OWNED);
+
+  // Heap nodes cannot join a document's tree either; its reset would leak
+  // them.
+  jesen_node_t *loose = NULL;
+  EXPECT_OK(jesen_object_create(&loose));
+  assert(jesen_node_assign_to(root, "loose", loose) == JESEN_ERR_NOT_OWNED);
+  assert(jesen_node_assign_to(arr, "ignored", loose) == JESEN_ERR_NOT_OWNED);
+  EXPECT_OK(jesen_array_add_int32(arr, 1));
+  assert(jesen_array_set_value(arr, 0, loose) == JESEN_ERR_NOT_OWNED);
+  EXPECT_OK(jesen_destroy(loose));
+
+  // The heap copy outlives the document it came from.
+  EXPECT_OK(jesen_doc_reset(doc));
+  EXPECT_OK(jesen_serialize(copy, out, sizeof out));
+  assert(strcmp(out, expected) == 0);
+  EXPECT_OK(jesen_destroy(heap));
+
+  // Copies keep duplicate keys in order and do not recurse.
+  char json[512];
+  size_t n = 0;
+  for (int i = 0; i < 100; ++i) {
+    json[n++] = '[';
+  }
+  n += (size_t)sprintf(json + n, "{\"k\":1,\"k\":\"two\",\"n\":-1e300}");
+  for (int i = 0; i < 100; ++i) {
+    json[n++] = ']';
+  }
+  json[n] = '\0';
+  EXPECT_OK(jesen_doc_parse(doc, json, n, &root));
+  EXPECT_OK(jesen_node_copy(root, other, &copy));
+  char original[512];
+  char copied[512];
+  EXPECT_OK(jesen_serialize(root, original, sizeof original));
+  EXPECT_OK(jesen_serialize(copy, copied, sizeof copied));
+  assert(strcmp(copied, original) == 0 && strstr(copied, "\"two\""));
+
+  EXPECT_OK(jesen_doc_destroy(doc));
+  EXPECT_OK(jesen_doc_destroy(other));
+}
+
 static void test_nested_getters(void) {
   jesen_node_t *root = NULL;
   EXPECT_OK(jesen_object_create(&root));
@@ -156,6 +1630,31 @@ int main(void) {
   test_array_ops();
   test_assign_and_detach();
   test_parse_wrapper();
+  test_parse_lazy();
+  test_parse_roundtrip();
+  test_parse_block_boundaries();
+  test_parse_insitu();
+  test_push_parser();
+  test_parse_events();
+  test_parse_ndjson();
+  test_parse_parallel();
+  test_cursor();
+  test_tape();
+  test_parse_numbers();
+  test_serialize_numbers();
+  test_serialize_strings();
+  test_parse_file();
+  test_parse_strict_utf8();
+  test_parse_depth();
+  test_parse_options();
+  test_doc_reuse();
+  test_parse_projection();
+  test_extract_pointer();
+  test_intern_keys();
+  test_object_index();
+  test_array_index();
+  test_iter();
+  test_doc_build();
   test_nested_getters();
   printf("All tests passed\n");
   return 0;